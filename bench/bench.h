@@ -0,0 +1,35 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define BENCH_NAME_SIZE 96
+
+typedef void (*bench_fn_t)(void* ctx);
+
+typedef struct bench_result
+{
+    char name[BENCH_NAME_SIZE];
+    size_t samples;
+    size_t calls_per_sample;
+    double mean_ns;
+    double p50_ns;
+    double p99_ns;
+    double min_ns;
+    double flops;
+    double bytes;
+} bench_result_t;
+
+void bench_init(const char* filter, double min_time);
+bool bench_selected(const char* name);
+void bench_run(const char* name, bench_fn_t fn, void* ctx, double flops, double bytes);
+bool bench_write_json(const char* path);
+void bench_finish(void);
+
+void bench_memory(void);
+void bench_tensor(void);
+void bench_dense(void);
+void bench_train(void);
+
+#endif
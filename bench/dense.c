@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <cortex.h>
+#include "bench.h"
+
+#define NUM_BATCHES 3
+#define NUM_SHAPES 3
+
+typedef struct dense_ctx
+{
+    layer_t* layer;
+    tensor_t* input;
+    tensor_t* output;
+} dense_ctx_t;
+
+static void fill_ones(tensor_t* tensor)
+{
+    float* grad = tensor_grad(tensor);
+    for (size_t i = 0; i < tensor->size; ++i)
+    {
+        grad[i] = 1.0f;
+    }
+}
+
+static void forward(void* ctx)
+{
+    dense_ctx_t* args = (dense_ctx_t*)ctx;
+    layer_forward(args->layer, args->input);
+}
+
+static void backward(void* ctx)
+{
+    dense_backward(((dense_ctx_t*)ctx)->output);
+}
+
+static void bench_dense_case(size_t batch_size, size_t input_dim, size_t output_dim)
+{
+    char names[2][BENCH_NAME_SIZE];
+    snprintf(names[0], BENCH_NAME_SIZE, "dense_forward/b%zu_i%zu_o%zu", batch_size, input_dim, output_dim);
+    snprintf(names[1], BENCH_NAME_SIZE, "dense_backward/b%zu_i%zu_o%zu", batch_size, input_dim, output_dim);
+    if (!bench_selected(names[0]) && !bench_selected(names[1]))
+    {
+        return;
+    }
+
+    size_t input_shape[2] = {batch_size, input_dim};
+    dense_ctx_t args = {dense_create_with_activation(NULL, input_dim, output_dim, ACTIVATION_RELU), tensor_rand(input_shape, 2, 1.0f), NULL};
+    double macs = (double)batch_size * (double)input_dim * (double)output_dim;
+    double weights = (double)input_dim * (double)output_dim * sizeof(float);
+    double activations = (double)batch_size * (double)(input_dim + output_dim) * sizeof(float);
+
+    cortex_no_grad_begin();
+    bench_run(names[0], forward, &args, 2.0 * macs, weights + activations);
+    cortex_no_grad_end();
+
+    // The backward pass accumulates into the same gradients every call, which is what it does under accumulation anyway
+    args.output = layer_forward(args.layer, args.input);
+    fill_ones(args.output);
+    tensor_grad(args.input);
+    bench_run(names[1], backward, &args, 4.0 * macs, 2.0 * weights + 2.0 * activations);
+
+    layer_destroy(args.layer);
+    tensor_destroy(args.input);
+}
+
+void bench_dense(void)
+{
+    size_t batches[NUM_BATCHES] = {1, 32, 256};
+    size_t shapes[NUM_SHAPES][2] = {{256, 256}, {784, 128}, {1024, 1024}};
+    for (size_t b = 0; b < NUM_BATCHES; ++b)
+    {
+        for (size_t s = 0; s < NUM_SHAPES; ++s)
+        {
+            bench_dense_case(batches[b], shapes[s][0], shapes[s][1]);
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cortex.h>
+#include "bench.h"
+
+#define BENCH_SAMPLE_NS 20000.0
+#define BENCH_MAX_CALLS_PER_SAMPLE (1 << 20)
+#define BENCH_MIN_SAMPLES 10
+#define BENCH_MAX_SAMPLES 10000
+
+typedef struct bench_state
+{
+    const char* filter;
+    double min_time;
+    bench_result_t* results;
+    size_t num_results;
+    size_t capacity;
+} bench_state_t;
+
+static bench_state_t state = {NULL, 0.2, NULL, 0, 0};
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double time_calls(bench_fn_t fn, void* ctx, size_t calls)
+{
+    double start = now_ns();
+    for (size_t i = 0; i < calls; ++i)
+    {
+        fn(ctx);
+    }
+    return now_ns() - start;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+void bench_init(const char* filter, double min_time)
+{
+    state.filter = filter;
+    state.min_time = min_time;
+    printf("%-44s %10s %8s %12s %12s %10s %10s\n", "benchmark", "calls", "samples", "p50 us", "p99 us", "GFLOP/s", "GB/s");
+}
+
+bool bench_selected(const char* name)
+{
+    return state.filter == NULL || strstr(name, state.filter) != NULL;
+}
+
+// Calls too short to time one by one are grouped until a sample lasts long enough, percentiles are over per-call sample means
+void bench_run(const char* name, bench_fn_t fn, void* ctx, double flops, double bytes)
+{
+    if (!bench_selected(name))
+    {
+        return;
+    }
+
+    size_t calls = 1;
+    fn(ctx);
+    while (calls < BENCH_MAX_CALLS_PER_SAMPLE && time_calls(fn, ctx, calls) < BENCH_SAMPLE_NS)
+    {
+        calls *= 2;
+    }
+
+    double* samples = (double*)malloc(BENCH_MAX_SAMPLES * sizeof(double));
+    if (samples == NULL)
+    {
+        return;
+    }
+    size_t count = 0;
+    double elapsed = 0.0;
+    while (count < BENCH_MAX_SAMPLES && (count < BENCH_MIN_SAMPLES || elapsed < state.min_time * 1e9))
+    {
+        double time = time_calls(fn, ctx, calls);
+        samples[count++] = time / (double)calls;
+        elapsed += time;
+    }
+    qsort(samples, count, sizeof(double), compare_double);
+
+    bench_result_t result;
+    snprintf(result.name, BENCH_NAME_SIZE, "%s", name);
+    result.samples = count;
+    result.calls_per_sample = calls;
+    result.mean_ns = elapsed / (double)(count * calls);
+    result.p50_ns = samples[(count - 1) / 2];
+    result.p99_ns = samples[(count * 99 + 99) / 100 - 1];
+    result.min_ns = samples[0];
+    result.flops = flops;
+    result.bytes = bytes;
+    free(samples);
+
+    if (state.num_results == state.capacity)
+    {
+        size_t capacity = state.capacity ? state.capacity * 2 : 64;
+        bench_result_t* results = (bench_result_t*)realloc(state.results, capacity * sizeof(bench_result_t));
+        if (results == NULL)
+        {
+            return;
+        }
+        state.results = results;
+        state.capacity = capacity;
+    }
+    state.results[state.num_results++] = result;
+
+    double gflops = flops / result.mean_ns;
+    double gbytes = bytes / result.mean_ns;
+    printf("%-44s %10zu %8zu %12.3f %12.3f %10.2f %10.2f\n", name, calls, count, result.p50_ns * 1e-3, result.p99_ns * 1e-3, gflops, gbytes);
+    fflush(stdout);
+}
+
+// One object per benchmark with per-call times in nanoseconds, so two runs can be diffed by name
+bool bench_write_json(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    fprintf(file, "{\n  \"threads\": %zu,\n  \"min_time\": %.3f,\n  \"results\": [", cortex_get_num_threads(), state.min_time);
+    for (size_t i = 0; i < state.num_results; ++i)
+    {
+        const bench_result_t* r = &state.results[i];
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"samples\": %zu, \"calls_per_sample\": %zu, ", i ? "," : "", r->name, r->samples, r->calls_per_sample);
+        fprintf(file, "\"mean_ns\": %.3f, \"p50_ns\": %.3f, \"p99_ns\": %.3f, \"min_ns\": %.3f, ", r->mean_ns, r->p50_ns, r->p99_ns, r->min_ns);
+        fprintf(file, "\"flops\": %.0f, \"bytes\": %.0f, \"gflops\": %.4f, \"gbytes_per_second\": %.4f}", r->flops, r->bytes, r->flops / r->mean_ns, r->bytes / r->mean_ns);
+    }
+    fprintf(file, "\n  ]\n}\n");
+
+    return fclose(file) == 0;
+}
+
+void bench_finish(void)
+{
+    free(state.results);
+    state.results = NULL;
+    state.num_results = 0;
+    state.capacity = 0;
+}
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cortex.h>
+#include "bench.h"
+
+static void usage(const char* program)
+{
+    printf("Usage: %s [--json PATH] [--filter SUBSTRING] [--min-time SECONDS]\n", program);
+}
+
+int main(int argc, char** argv)
+{
+    const char* json = NULL;
+    const char* filter = NULL;
+    double min_time = 0.2;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+        {
+            json = argv[++i];
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            min_time = atof(argv[++i]);
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (pool_init(256 * MB) != POOL_CREATION_SUCCESS)
+    {
+        printf("Failed to initialize the pool\n");
+        return 1;
+    }
+
+    bench_init(filter, min_time);
+    bench_memory();
+    bench_tensor();
+    bench_dense();
+    bench_train();
+
+    int status = 0;
+    if (json && !bench_write_json(json))
+    {
+        printf("Failed to write %s\n", json);
+        status = 1;
+    }
+    else if (json)
+    {
+        printf("Results written to %s\n", json);
+    }
+
+    bench_finish();
+    pool_destroy();
+
+    return status;
+}
@@ -0,0 +1,52 @@
+#include <stdio.h>
+#include <cortex.h>
+#include "bench.h"
+
+#define BATCH_BLOCKS 64
+
+typedef struct batch_ctx
+{
+    void* blocks[BATCH_BLOCKS];
+    size_t sizes[BATCH_BLOCKS];
+    bool reverse;
+} batch_ctx_t;
+
+static void alloc_free_pair(void* ctx)
+{
+    pool_free(pool_alloc(*(size_t*)ctx));
+}
+
+// Mixed sizes freed either in reverse order, which coalesces as it goes, or in allocation order, which leaves holes behind
+static void alloc_free_batch(void* ctx)
+{
+    batch_ctx_t* batch = (batch_ctx_t*)ctx;
+    for (size_t i = 0; i < BATCH_BLOCKS; ++i)
+    {
+        batch->blocks[i] = pool_alloc(batch->sizes[i]);
+    }
+    for (size_t i = 0; i < BATCH_BLOCKS; ++i)
+    {
+        pool_free(batch->blocks[batch->reverse ? BATCH_BLOCKS - 1 - i : i]);
+    }
+}
+
+void bench_memory(void)
+{
+    size_t sizes[3] = {64, 4 * KB, 256 * KB};
+    for (size_t i = 0; i < 3; ++i)
+    {
+        char name[BENCH_NAME_SIZE];
+        snprintf(name, sizeof(name), "pool_alloc_free/%zu", sizes[i]);
+        bench_run(name, alloc_free_pair, &sizes[i], 0.0, 0.0);
+    }
+
+    batch_ctx_t batch;
+    for (size_t i = 0; i < BATCH_BLOCKS; ++i)
+    {
+        batch.sizes[i] = 16 + (i * 7919) % (16 * KB);
+    }
+    batch.reverse = true;
+    bench_run("pool_batch_64/lifo", alloc_free_batch, &batch, 0.0, 0.0);
+    batch.reverse = false;
+    bench_run("pool_batch_64/fifo", alloc_free_batch, &batch, 0.0, 0.0);
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <cortex.h>
+#include "bench.h"
+
+typedef struct binary_ctx
+{
+    tensor_t* a;
+    tensor_t* b;
+    tensor_t* out;
+} binary_ctx_t;
+
+static void add_alloc(void* ctx)
+{
+    binary_ctx_t* args = (binary_ctx_t*)ctx;
+    tensor_destroy(tensor_add(args->a, args->b));
+}
+
+static void add_out(void* ctx)
+{
+    binary_ctx_t* args = (binary_ctx_t*)ctx;
+    tensor_add_out(args->a, args->b, args->out);
+}
+
+static void reshape(void* ctx)
+{
+    binary_ctx_t* args = (binary_ctx_t*)ctx;
+    size_t shape[1] = {args->a->size};
+    tensor_destroy(tensor_reshape(args->a, shape, 1));
+}
+
+void bench_tensor(void)
+{
+    cortex_no_grad_begin();
+
+    // From cache-resident to well past the last-level cache
+    size_t sizes[4] = {1 << 10, 1 << 16, 1 << 20, 1 << 22};
+    for (size_t i = 0; i < 4; ++i)
+    {
+        char names[2][BENCH_NAME_SIZE];
+        snprintf(names[0], BENCH_NAME_SIZE, "tensor_add/%zu", sizes[i]);
+        snprintf(names[1], BENCH_NAME_SIZE, "tensor_add_out/%zu", sizes[i]);
+        if (!bench_selected(names[0]) && !bench_selected(names[1]))
+        {
+            continue;
+        }
+
+        size_t shape[1] = {sizes[i]};
+        binary_ctx_t args = {tensor_rand(shape, 1, 1.0f), tensor_rand(shape, 1, 1.0f), tensor_empty(shape, 1)};
+        double bytes = 3.0 * (double)sizes[i] * sizeof(float);
+        bench_run(names[0], add_alloc, &args, (double)sizes[i], bytes);
+        bench_run(names[1], add_out, &args, (double)sizes[i], bytes);
+        tensor_destroy(args.out);
+        tensor_destroy(args.b);
+        tensor_destroy(args.a);
+    }
+
+    // Reshaping a contiguous tensor only builds a view, so this times the metadata path
+    if (bench_selected("tensor_reshape/1024x1024"))
+    {
+        size_t shape[2] = {1024, 1024};
+        binary_ctx_t args = {tensor_zeros(shape, 2), NULL, NULL};
+        bench_run("tensor_reshape/1024x1024", reshape, &args, 0.0, 0.0);
+        tensor_destroy(args.a);
+    }
+
+    cortex_no_grad_end();
+}
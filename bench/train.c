@@ -0,0 +1,68 @@
+#include <cortex.h>
+#include "bench.h"
+
+typedef struct train_ctx
+{
+    sequential_t* model;
+    optimizer_t* optimizer;
+    tensor_t* input;
+} train_ctx_t;
+
+static void fill_ones(tensor_t* tensor)
+{
+    float* grad = tensor_grad(tensor);
+    for (size_t i = 0; i < tensor->size; ++i)
+    {
+        grad[i] = 1.0f;
+    }
+}
+
+static void train_step(void* ctx)
+{
+    train_ctx_t* args = (train_ctx_t*)ctx;
+    tensor_t* output = sequential_forward(args->model, args->input);
+    fill_ones(output);
+    sequential_backward(args->model);
+    optimizer_step(args->optimizer);
+    sequential_zero_grad(args->model);
+}
+
+// A compiled MLP step with Adam, the loop a training run spends its time in
+void bench_train(void)
+{
+    const char* name = "mlp_train_step/b64_784_512_256_10";
+    if (!bench_selected(name))
+    {
+        return;
+    }
+
+    size_t batch_size = 64;
+    size_t dims[4] = {784, 512, 256, 10};
+    train_ctx_t args;
+    args.model = sequential_create("mlp");
+    double macs = 0.0;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        activation_t activation = (i < 2) ? ACTIVATION_RELU : ACTIVATION_NONE;
+        sequential_add(args.model, dense_create_with_activation(NULL, dims[i], dims[i + 1], activation));
+        macs += (double)batch_size * (double)dims[i] * (double)dims[i + 1];
+    }
+    sequential_flatten_parameters(args.model);
+    sequential_compile(args.model, batch_size, true);
+
+    args.optimizer = optimizer_adam_create(1e-3f, 0.9f, 0.999f, 1e-8f, 0.0f);
+    for (size_t i = 0; i < args.model->num_layers; ++i)
+    {
+        optimizer_add_parameters(args.optimizer, args.model->layers[i]->params);
+    }
+
+    size_t input_shape[2] = {batch_size, dims[0]};
+    args.input = tensor_rand(input_shape, 2, 1.0f);
+    args.input->frozen = true;
+
+    bench_run(name, train_step, &args, 6.0 * macs, 0.0);
+
+    optimizer_destroy(args.optimizer);
+    sequential_destroy(args.model);
+    tensor_destroy(args.input);
+}
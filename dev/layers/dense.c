@@ -66,9 +66,10 @@ int main()
     }
 
     // Perform a backward pass to compute gradients
+    float* output_tensor_grad = tensor_grad(output_tensor);
     for (size_t i = 0; i < output_tensor->size; ++i)
     {
-        output_tensor->grad[i] = 1.0f;
+        output_tensor_grad[i] = 1.0f;
     }
     tensor_backward(output_tensor);
 
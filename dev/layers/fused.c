@@ -0,0 +1,266 @@
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <cortex.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static float activate(activation_t activation, float x)
+{
+    switch (activation)
+    {
+        case ACTIVATION_RELU:
+            return (x > 0.0f) ? x : 0.0f;
+        case ACTIVATION_GELU:
+            return 0.5f * x * (1.0f + tanhf(0.7978845608f * (x + 0.044715f * x * x * x)));
+        case ACTIVATION_SIGMOID:
+            return 1.0f / (1.0f + expf(-x));
+        case ACTIVATION_TANH:
+            return tanhf(x);
+        default:
+            return x;
+    }
+}
+
+static float activate_grad(activation_t activation, float x)
+{
+    float y = activate(activation, x);
+    switch (activation)
+    {
+        case ACTIVATION_RELU:
+            return (x > 0.0f) ? 1.0f : 0.0f;
+        case ACTIVATION_GELU:
+        {
+            float t = tanhf(0.7978845608f * (x + 0.044715f * x * x * x));
+            return 0.5f * (1.0f + t) + 0.5f * x * (1.0f - t * t) * 0.7978845608f * (1.0f + 3.0f * 0.044715f * x * x);
+        }
+        case ACTIVATION_SIGMOID:
+            return y * (1.0f - y);
+        case ACTIVATION_TANH:
+            return 1.0f - y * y;
+        default:
+            return 1.0f;
+    }
+}
+
+// Checks the fused forward and backward against a naive reference computed in double precision
+static int check(activation_t activation, const char* name)
+{
+    size_t batch_size = 37;
+    size_t input_dim = 53;
+    size_t output_dim = 29;
+
+    size_t input_shape[2] = {batch_size, input_dim};
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+    layer_t* layer = dense_create_with_activation(name, input_dim, output_dim, activation);
+    double* dz = (double*)pool_alloc(batch_size * output_dim * sizeof(double));
+    if (input == NULL || layer == NULL || dz == NULL)
+    {
+        printf("Failed to create layer\n");
+        return -1;
+    }
+    dense_parameters_t* params = (dense_parameters_t*)layer->params;
+    const float* x = input->data;
+    const float* w = params->weights->data;
+    const float* b = params->bias->data;
+
+    tensor_t* output = layer_forward(layer, input);
+    float forward_error = 0.0f;
+    for (size_t i = 0; i < batch_size; ++i)
+    {
+        for (size_t j = 0; j < output_dim; ++j)
+        {
+            double z = b[j];
+            for (size_t p = 0; p < input_dim; ++p)
+            {
+                z += (double)x[i * input_dim + p] * w[j * input_dim + p];
+            }
+            forward_error = fmaxf(forward_error, fabsf(activate(activation, (float)z) - output->data[i * output_dim + j]));
+            dz[i * output_dim + j] = activate_grad(activation, (float)z);
+        }
+    }
+
+    // Loss is the plain sum of the outputs, so the upstream gradient is all ones
+    float* output_grad = tensor_grad(output);
+    for (size_t i = 0; i < output->size; ++i)
+    {
+        output_grad[i] = 1.0f;
+    }
+    tensor_backward(output);
+
+    float grad_error = 0.0f;
+    for (size_t j = 0; j < output_dim; ++j)
+    {
+        double bias_grad = 0.0;
+        for (size_t i = 0; i < batch_size; ++i)
+        {
+            bias_grad += dz[i * output_dim + j];
+        }
+        grad_error = fmaxf(grad_error, fabsf((float)bias_grad - params->bias->grad[j]));
+        for (size_t p = 0; p < input_dim; ++p)
+        {
+            double weight_grad = 0.0;
+            for (size_t i = 0; i < batch_size; ++i)
+            {
+                weight_grad += dz[i * output_dim + j] * x[i * input_dim + p];
+            }
+            grad_error = fmaxf(grad_error, fabsf((float)weight_grad - params->weights->grad[j * input_dim + p]));
+        }
+    }
+
+    printf("%-8s forward max error: %.2e, parameter grad max error: %.2e\n", name, forward_error, grad_error);
+
+    pool_free(dz);
+    layer_destroy(layer);
+    tensor_destroy(input);
+    return 0;
+}
+
+// Loss of y = f(f(x)) summed over every element, evaluated without autograd into separate buffers
+static double twice_loss(layer_t* layer, const tensor_t* input, tensor_t* hidden, tensor_t* output)
+{
+    cortex_no_grad_begin();
+    dense_forward_out(layer, input, hidden);
+    dense_forward_out(layer, hidden, output);
+    cortex_no_grad_end();
+
+    double loss = 0.0;
+    for (size_t i = 0; i < output->size; ++i)
+    {
+        loss += output->data[i];
+    }
+    return loss;
+}
+
+// The same GELU layer applied twice before backward: each call has to be differentiated against its own pre-activation
+static int check_twice(void)
+{
+    size_t batch_size = 8;
+    size_t dim = 24;
+    double step = 1e-2;
+
+    size_t shape[2] = {batch_size, dim};
+    tensor_t* input = tensor_rand(shape, 2, 1.0f);
+    tensor_t* hidden = tensor_empty(shape, 2);
+    tensor_t* scratch = tensor_empty(shape, 2);
+    layer_t* layer = dense_create_with_activation("gelu2", dim, dim, ACTIVATION_GELU);
+    if (input == NULL || hidden == NULL || scratch == NULL || layer == NULL)
+    {
+        printf("Failed to create layer\n");
+        return -1;
+    }
+    dense_parameters_t* params = (dense_parameters_t*)layer->params;
+
+    tensor_t* first = layer_forward(layer, input);
+    tensor_t* second = layer_forward(layer, first);
+    float* output_grad = tensor_grad(second);
+    for (size_t i = 0; i < second->size; ++i)
+    {
+        output_grad[i] = 1.0f;
+    }
+    tensor_grad(input);
+    tensor_backward(second);
+
+    float input_error = 0.0f;
+    for (size_t i = 0; i < input->size; ++i)
+    {
+        float value = input->data[i];
+        input->data[i] = value + (float)step;
+        double upper = twice_loss(layer, input, hidden, scratch);
+        input->data[i] = value - (float)step;
+        double lower = twice_loss(layer, input, hidden, scratch);
+        input->data[i] = value;
+        input_error = fmaxf(input_error, fabsf((float)((upper - lower) / (2.0 * step)) - input->grad[i]));
+    }
+
+    float weight_error = 0.0f;
+    float* w = params->weights->data;
+    for (size_t i = 0; i < params->weights->size; i += 7)
+    {
+        float value = w[i];
+        w[i] = value + (float)step;
+        double upper = twice_loss(layer, input, hidden, scratch);
+        w[i] = value - (float)step;
+        double lower = twice_loss(layer, input, hidden, scratch);
+        w[i] = value;
+        weight_error = fmaxf(weight_error, fabsf((float)((upper - lower) / (2.0 * step)) - params->weights->grad[i]));
+    }
+
+    printf("gelu x2  input grad max error vs finite differences: %.2e, weight grad: %.2e\n", input_error, weight_error);
+
+    tensor_destroy(first);
+    layer_destroy(layer);
+    tensor_destroy(scratch);
+    tensor_destroy(hidden);
+    tensor_destroy(input);
+    return (input_error < 5e-2f && weight_error < 5e-2f) ? 0 : -1;
+}
+
+int main()
+{
+    pool_init(256 * MB);
+
+    const char* names[] = {"none", "relu", "gelu", "sigmoid", "tanh"};
+    for (int activation = ACTIVATION_NONE; activation <= ACTIVATION_TANH; ++activation)
+    {
+        if (check((activation_t)activation, names[activation]) != 0)
+        {
+            pool_destroy();
+            return -1;
+        }
+    }
+    if (check_twice() != 0)
+    {
+        printf("Gradient of a layer applied twice does not match\n");
+        pool_destroy();
+        return -1;
+    }
+
+    // Fused bias + ReLU against a plain dense layer followed by a separate ReLU pass
+    size_t batch_size = 256;
+    size_t input_dim = 1024;
+    size_t output_dim = 1024;
+    size_t steps = 50;
+
+    size_t input_shape[2] = {batch_size, input_dim};
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+    layer_t* fused = dense_create_with_activation("fused", input_dim, output_dim, ACTIVATION_RELU);
+    layer_t* plain = dense_create("plain", input_dim, output_dim);
+    if (input == NULL || fused == NULL || plain == NULL)
+    {
+        printf("Failed to create benchmark layers\n");
+        pool_destroy();
+        return -1;
+    }
+
+    cortex_no_grad_begin();
+    double start = now_seconds();
+    for (size_t step = 0; step < steps; ++step)
+    {
+        layer_forward(fused, input);
+    }
+    double fused_time = (now_seconds() - start) / (double)steps;
+
+    start = now_seconds();
+    for (size_t step = 0; step < steps; ++step)
+    {
+        tensor_destroy(tensor_relu(layer_forward(plain, input)));
+    }
+    double plain_time = (now_seconds() - start) / (double)steps;
+    cortex_no_grad_end();
+
+    printf("Forward %zux%zux%zu: fused %.3f ms, dense + relu %.3f ms\n", batch_size, input_dim, output_dim, fused_time * 1e3, plain_time * 1e3);
+
+    layer_destroy(plain);
+    layer_destroy(fused);
+    tensor_destroy(input);
+
+    pool_destroy();
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <time.h>
+#include <stdio.h>
+#include <cortex.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+    pool_init(64 * MB);
+
+    size_t batch_size = 32;
+    size_t input_dim = 512;
+    size_t hidden_dim = 1024;
+    size_t output_dim = 10;
+    size_t steps = 200;
+
+    size_t input_shape[2] = {batch_size, input_dim};
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+    layer_t* hidden = dense_create("hidden", input_dim, hidden_dim);
+    layer_t* head = dense_create("head", hidden_dim, output_dim);
+    if (input == NULL || hidden == NULL || head == NULL)
+    {
+        printf("Failed to create model\n");
+        pool_destroy();
+        return -1;
+    }
+
+    // Serving loop: no gradients and no graph, layer outputs are reused between calls
+    cortex_no_grad_begin();
+
+    tensor_t* logits = NULL;
+    size_t used_after_first = 0;
+    double start = now_seconds();
+    for (size_t step = 0; step < steps; ++step)
+    {
+        logits = layer_forward(head, layer_forward(hidden, input));
+        if (logits == NULL)
+        {
+            printf("Forward pass failed at step %zu\n", step);
+            cortex_no_grad_end();
+            pool_destroy();
+            return -1;
+        }
+        if (step == 0)
+        {
+            used_after_first = pool_get_used_memory();
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    cortex_no_grad_end();
+
+    printf("Steps: %zu, %.3f ms/step\n", steps, elapsed / (double)steps * 1e3);
+    printf("Pool used after first step: %zu bytes, after last step: %zu bytes\n", used_after_first, pool_get_used_memory());
+    printf("Output graph recorded: %s, weight grads allocated: %s\n", logits->backward ? "yes" : "no", ((dense_parameters_t*)hidden->params)->weights->grad ? "yes" : "no");
+
+    layer_destroy(head);
+    layer_destroy(hidden);
+    tensor_destroy(input);
+
+    pool_destroy();
+
+    return 0;
+}
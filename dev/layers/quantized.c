@@ -0,0 +1,125 @@
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+#include <cortex.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Every precision starts from a copy of the same FP32 weights, so differences come from conversion alone
+static layer_t* make_layer(const layer_t* source, tensor_dtype_t dtype)
+{
+    const dense_parameters_t* from = (const dense_parameters_t*)source->params;
+    layer_t* layer = dense_create_with_activation("proj", from->weights->shape[1], from->weights->shape[0], ACTIVATION_RELU);
+    dense_parameters_t* to = (dense_parameters_t*)layer->params;
+    memcpy(to->weights->data, from->weights->data, from->weights->size * sizeof(float));
+    memcpy(to->bias->data, from->bias->data, from->bias->size * sizeof(float));
+    layer->params->freeze_params(layer->params);
+    if (dtype != TENSOR_FLOAT32 && dense_quantize(layer, dtype) != LAYER_QUANTIZE_SUCCESS)
+    {
+        printf("Failed to quantize\n");
+    }
+    return layer;
+}
+
+static double time_forward(layer_t* layer, const tensor_t* input, size_t steps)
+{
+    layer_forward(layer, input);
+    double start = now_seconds();
+    for (size_t step = 0; step < steps; ++step)
+    {
+        layer_forward(layer, input);
+    }
+    return (now_seconds() - start) / (double)steps;
+}
+
+int main()
+{
+    pool_init(512 * MB);
+    cortex_no_grad_begin();
+
+    const char* names[] = {"fp32", "fp16", "bf16", "int8"};
+    tensor_dtype_t dtypes[] = {TENSOR_FLOAT32, TENSOR_FLOAT16, TENSOR_BFLOAT16, TENSOR_INT8};
+
+    // Odd sizes exercise every tail path, a small and a large batch take the fused and the widened route
+    layer_t* source = dense_create("proj", 203, 37);
+    size_t odd_batches[] = {5, 37};
+    for (size_t b = 0; b < 2; ++b)
+    {
+        size_t odd_shape[2] = {odd_batches[b], 203};
+        tensor_t* odd_input = tensor_rand(odd_shape, 2, 1.0f);
+        tensor_t* reference = NULL;
+        for (size_t d = 0; d < 4; ++d)
+        {
+            layer_t* layer = make_layer(source, dtypes[d]);
+            tensor_t* output = layer_forward(layer, odd_input);
+            if (reference == NULL)
+            {
+                reference = tensor_clone(output);
+            }
+            float error = 0.0f;
+            float scale = 0.0f;
+            for (size_t i = 0; i < output->size; ++i)
+            {
+                error = fmaxf(error, fabsf(output->data[i] - reference->data[i]));
+                scale = fmaxf(scale, fabsf(reference->data[i]));
+            }
+            printf("%s relative max error on a %zux203 -> 37 layer: %.2e\n", names[d], odd_batches[b], error / scale);
+            layer_destroy(layer);
+        }
+        tensor_destroy(reference);
+        tensor_destroy(odd_input);
+    }
+    layer_destroy(source);
+
+    size_t dim = 4096;
+    size_t batches[] = {1, 16};
+    for (size_t b = 0; b < 2; ++b)
+    {
+        size_t input_shape[2] = {batches[b], dim};
+        tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+        layer_t* source = dense_create("proj", dim, dim);
+        double baseline = 0.0;
+        for (size_t d = 0; d < 4; ++d)
+        {
+            layer_t* layer = make_layer(source, dtypes[d]);
+            dense_parameters_t* params = (dense_parameters_t*)layer->params;
+            double time = time_forward(layer, input, 20);
+            baseline = (d == 0) ? time : baseline;
+            double weight_mb = (double)(params->weights->size * tensor_dtype_size(params->weights->dtype)) / (MB);
+            printf("batch %2zu %s: %.3f ms (%.2fx), weights %.0f MB\n", batches[b], names[d], time * 1e3, baseline / time, weight_mb);
+            layer_destroy(layer);
+        }
+        layer_destroy(source);
+        tensor_destroy(input);
+    }
+
+    // Quantized tensors and their scales round-trip through a checkpoint like any other parameter
+    layer_t* sources[2] = {dense_create("proj", 64, 32), dense_create("proj", 64, 32)};
+    layer_t* saved = make_layer(sources[0], TENSOR_INT8);
+    layer_t* restored = make_layer(sources[1], TENSOR_INT8);
+    layer_destroy(sources[1]);
+    layer_destroy(sources[0]);
+    checkpoint_save("/tmp/cortex_quantized.bin", &saved, 1);
+    checkpoint_t* checkpoint = checkpoint_open("/tmp/cortex_quantized.bin");
+    checkpoint_status_code_t loaded = checkpoint_load(checkpoint, &restored, 1, true);
+    dense_parameters_t* a = (dense_parameters_t*)saved->params;
+    dense_parameters_t* r = (dense_parameters_t*)restored->params;
+    printf("INT8 checkpoint round trip: %s\n", loaded == CHECKPOINT_LOAD_SUCCESS && ((int8_t*)r->weights->data)[100] == ((int8_t*)a->weights->data)[100] && r->scales->data[7] == a->scales->data[7] ? "ok" : "failed");
+    layer_destroy(restored);
+    checkpoint_close(checkpoint);
+    layer_destroy(saved);
+    remove("/tmp/cortex_quantized.bin");
+
+    cortex_no_grad_end();
+    printf("Used memory after teardown: %zu bytes\n", pool_get_used_memory());
+
+    pool_destroy();
+
+    return 0;
+}
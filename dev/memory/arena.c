@@ -0,0 +1,66 @@
+#include <time.h>
+#include <stdio.h>
+#include <cortex.h>
+
+int main() 
+{
+    pool_init(16 * MB);
+    arena_init(1 * MB);
+
+    srand((unsigned int)time(NULL));
+
+    size_t batch_size = 32;
+    size_t input_dim = 128;
+    size_t hidden_dim = 256;
+    size_t output_dim = 10;
+
+    // Parameters are created outside the arena scope and stay in the pool
+    layer_t* hidden = dense_create("hidden", input_dim, hidden_dim);
+    layer_t* output = dense_create("output", hidden_dim, output_dim);
+    if (hidden == NULL || output == NULL)
+    {
+        printf("Failed to create layers\n");
+        pool_destroy();
+        return -1;
+    }
+
+    size_t input_shape[2] = {batch_size, input_dim};
+
+    for (size_t step = 0; step < 5; ++step)
+    {
+        // Activations and their gradients are bump-allocated and released together by arena_reset
+        arena_begin();
+
+        tensor_t* x = tensor_rand(input_shape, 2, 1.0f);
+        tensor_t* h = layer_forward(hidden, x);
+        tensor_t* y = layer_forward(output, h);
+        if (y == NULL)
+        {
+            printf("Failed to perform forward pass\n");
+            break;
+        }
+        float* y_grad = tensor_grad(y);
+        for (size_t i = 0; i < y->size; ++i)
+        {
+            y_grad[i] = 1.0f;
+        }
+        tensor_backward(y);
+
+        arena_end();
+
+        printf("step %zu: pool used %zu bytes, arena used %zu bytes, arena peak %zu bytes\n", step, pool_get_used_memory(), arena_get_used_memory(), arena_get_peak_memory());
+
+        arena_reset();
+    }
+
+    layer_destroy(hidden);
+    layer_destroy(output);
+    arena_destroy();
+
+    printf("Used memory: %zu bytes\n", pool_get_used_memory());
+    printf("Free memory: %zu bytes\n", pool_get_free_memory());
+
+    pool_destroy();
+
+    return 0;
+}
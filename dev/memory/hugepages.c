@@ -0,0 +1,86 @@
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+#include <cortex.h>
+
+#define BUFFER_SIZE (256 * (MB))
+#define LOOKUPS (16 * 1024 * 1024)
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec * 1e-6;
+}
+
+static size_t anon_huge_pages_kb(void)
+{
+    FILE* file = fopen("/proc/self/smaps_rollup", "r");
+    if (file == NULL)
+    {
+        return 0;
+    }
+
+    char line[256];
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, "AnonHugePages: %zu kB", &kb) == 1)
+        {
+            break;
+        }
+    }
+    fclose(file);
+    return kb;
+}
+
+// Random gathers over a buffer far larger than the TLB reach of 4 KB pages
+static void run(const char* label, const pool_options_t* options)
+{
+    if (pool_init_with_options(BUFFER_SIZE + 4 * (MB), options) != POOL_CREATION_SUCCESS)
+    {
+        printf("%-8s pool creation failed\n", label);
+        return;
+    }
+
+    size_t count = BUFFER_SIZE / sizeof(uint32_t);
+    uint32_t* buffer = (uint32_t*)pool_alloc(count * sizeof(uint32_t));
+    for (size_t i = 0; i < count; ++i)
+    {
+        buffer[i] = (uint32_t)(i * 2654435761u);
+    }
+
+    double start = now_ms();
+    uint32_t index = 0;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < LOOKUPS; ++i)
+    {
+        index = (index * 1664525u + 1013904223u) ^ buffer[index % count];
+        sum += index;
+    }
+    double elapsed = now_ms() - start;
+
+    printf("%-8s %8.1f ms for %d lookups, AnonHugePages %6zu kB (checksum %llu)\n", label, elapsed, LOOKUPS, anon_huge_pages_kb(), (unsigned long long)(sum & 0xffff));
+
+    pool_free(buffer);
+    pool_destroy();
+}
+
+int main()
+{
+    pool_options_t malloc_options = {POOL_BACKING_MALLOC, POOL_NUMA_NONE};
+    pool_options_t mmap_options = {POOL_BACKING_MMAP, POOL_NUMA_NONE};
+    pool_options_t hugetlb_options = {POOL_BACKING_HUGETLB, POOL_NUMA_LOCAL};
+    pool_options_t node_options = {POOL_BACKING_MMAP, 0};
+
+    run("malloc", &malloc_options);
+    run("mmap", &mmap_options);
+
+    // Without reserved hugetlbfs pages this falls back to transparent huge pages
+    run("hugetlb", &hugetlb_options);
+    run("node 0", &node_options);
+
+    printf("AnonHugePages after teardown: %zu kB\n", anon_huge_pages_kb());
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <cortex.h>
+
+#define NUM_LAYERS 4
+
+static void fill_ones(tensor_t* tensor)
+{
+    float* grad = tensor_grad(tensor);
+    for (size_t i = 0; i < tensor->size; ++i)
+    {
+        grad[i] = 1.0f;
+    }
+}
+
+static void zero_grads(layer_t** layers)
+{
+    for (size_t i = 0; i < NUM_LAYERS; ++i)
+    {
+        dense_parameters_t* params = (dense_parameters_t*)layers[i]->params;
+        memset(params->weights->grad, 0, params->weights->size * sizeof(float));
+        memset(params->bias->grad, 0, params->bias->size * sizeof(float));
+    }
+}
+
+int main()
+{
+    pool_init(64 * MB);
+
+    size_t batch_size = 64;
+    size_t dims[NUM_LAYERS + 1] = {128, 512, 256, 512, 10};
+    activation_t activations[NUM_LAYERS] = {ACTIVATION_GELU, ACTIVATION_RELU, ACTIVATION_TANH, ACTIVATION_NONE};
+
+    size_t input_shape[2] = {batch_size, dims[0]};
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+    input->frozen = true;
+
+    layer_t* layers[NUM_LAYERS];
+    for (size_t i = 0; i < NUM_LAYERS; ++i)
+    {
+        layers[i] = dense_create_with_activation(NULL, dims[i], dims[i + 1], activations[i]);
+    }
+
+    // Reference gradients through freshly allocated outputs and the autograd engine
+    tensor_t* x = input;
+    for (size_t i = 0; i < NUM_LAYERS; ++i)
+    {
+        x = layer_forward(layers[i], x);
+    }
+    fill_ones(x);
+    tensor_backward(x);
+
+    dense_parameters_t* first = (dense_parameters_t*)layers[0]->params;
+    tensor_t* reference = tensor_clone(first->weights);
+    memcpy(reference->data, first->weights->grad, reference->size * sizeof(float));
+    zero_grads(layers);
+
+    memory_plan_t* plan = memory_plan_create(layers, NUM_LAYERS, batch_size, true);
+    if (plan == NULL)
+    {
+        printf("Failed to plan model\n");
+        pool_destroy();
+        return -1;
+    }
+
+    size_t used_before = pool_get_used_memory();
+    tensor_t* output = memory_plan_forward(plan, input);
+    fill_ones(output);
+    memory_plan_backward(plan);
+    size_t used_after = pool_get_used_memory();
+
+    float difference = 0.0f;
+    for (size_t i = 0; i < reference->size; ++i)
+    {
+        difference = fmaxf(difference, fabsf(reference->data[i] - first->weights->grad[i]));
+    }
+
+    printf("Training plan: %zu bytes unplanned, %zu bytes live at peak, %zu bytes planned\n", memory_plan_get_unplanned_size(plan), memory_plan_get_peak(plan), memory_plan_get_size(plan));
+    printf("Pool growth over a planned step: %zd bytes\n", (ssize_t)(used_after - used_before));
+    printf("First layer weight grad max difference: %.2e\n", difference);
+    memory_plan_destroy(plan);
+
+    memory_plan_t* inference = memory_plan_create(layers, NUM_LAYERS, batch_size, false);
+    printf("Inference plan: %zu bytes unplanned, %zu bytes live at peak, %zu bytes planned\n", memory_plan_get_unplanned_size(inference), memory_plan_get_peak(inference), memory_plan_get_size(inference));
+    memory_plan_destroy(inference);
+
+    for (size_t i = 0; i < NUM_LAYERS; ++i)
+    {
+        layer_destroy(layers[i]);
+    }
+    tensor_destroy(reference);
+    tensor_destroy(input);
+
+    pool_destroy();
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <time.h>
+#include <stdio.h>
+#include <cortex.h>
+
+#define PAIRS 1000000
+#define ARENA_SIZE (64 * KB)
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static size_t count_arenas(void)
+{
+    size_t count = 0;
+    for (memory_pool_t* pool = global_memory_pool; pool; pool = pool->next)
+    {
+        count++;
+    }
+    return count;
+}
+
+int main()
+{
+    size_t chain_lengths[5] = {1, 16, 64, 256, 1024};
+    size_t sizes[3] = {sizeof(tensor_t), 4 * KB, 256 * KB};
+
+    printf("%8s %10s %14s\n", "arenas", "size", "ns/pair");
+
+    for (size_t c = 0; c < 5; ++c)
+    {
+        pool_init(ARENA_SIZE);
+
+        // Pin one block per arena so the chain cannot be reused and keeps growing
+        void* pinned[1024];
+        size_t num_pinned = 0;
+        while (count_arenas() < chain_lengths[c])
+        {
+            pinned[num_pinned] = pool_alloc(ARENA_SIZE - 64);
+            if (pinned[num_pinned] == NULL)
+            {
+                printf("Failed to grow the pool\n");
+                pool_destroy();
+                return -1;
+            }
+            num_pinned++;
+        }
+
+        for (size_t s = 0; s < 3; ++s)
+        {
+            void* warmup = pool_alloc(sizes[s]);
+            pool_free(warmup);
+
+            double start = now_seconds();
+            for (size_t i = 0; i < PAIRS; ++i)
+            {
+                void* ptr = pool_alloc(sizes[s]);
+                pool_free(ptr);
+            }
+            double elapsed = now_seconds() - start;
+
+            printf("%8zu %10zu %14.1f\n", count_arenas(), sizes[s], elapsed / PAIRS * 1e9);
+        }
+
+        for (size_t i = 0; i < num_pinned; ++i)
+        {
+            pool_free(pinned[i]);
+        }
+        pool_destroy();
+    }
+
+    // Pointers the pool never handed out, and blocks it already took back, are refused before their supposed arena is dereferenced;
+    // only the header-sized bytes in front of the pointer are read, so those have to be readable
+    pool_init(ARENA_SIZE);
+    float stack_buffer[64] = {0};
+    float* heap_buffer = (float*)calloc(256, sizeof(float));
+    void* block = pool_alloc(1024);
+    int refused = (pool_free(stack_buffer + 32) == POOL_FREE_FAILURE) + (pool_free(heap_buffer + 16) == POOL_FREE_FAILURE);
+    int freed = (pool_free(block) == POOL_FREE_SUCCESS);
+    refused += (pool_free(block) == POOL_FREE_FAILURE);
+    printf("Foreign and double frees refused: %d of 3, valid free accepted: %d\n", refused, freed);
+    free(heap_buffer);
+    pool_destroy();
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <cortex.h>
+
+#define REQUESTS 100
+
+int main()
+{
+    pool_init(4 * MB);
+
+    sequential_t* model = sequential_create("mlp");
+    sequential_add(model, dense_create_with_activation("hidden", 256, 512, ACTIVATION_RELU));
+    sequential_add(model, dense_create("logits", 512, 10));
+
+    pool_stats_t stats;
+    pool_get_stats(&stats);
+    size_t baseline = stats.used;
+    printf("After building the model: %zu bytes in %zu live blocks, %zu allocations\n", stats.used, stats.live_allocations, stats.allocations);
+
+    // A request handler that forgets one buffer in ten, the kind of creep that only shows after hours of uptime
+    void* leaked[REQUESTS];
+    size_t num_leaked = 0;
+    size_t input_shape[2] = {32, 256};
+    cortex_no_grad_begin();
+    for (size_t request = 0; request < REQUESTS; ++request)
+    {
+        const char* previous = pool_set_tag("request");
+        tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+        void* scratch = pool_alloc(3000);
+        pool_set_tag(previous);
+
+        sequential_forward(model, input);
+        tensor_destroy(input);
+        if (request % 10 == 0)
+        {
+            leaked[num_leaked++] = scratch;
+        }
+        else
+        {
+            pool_free(scratch);
+        }
+    }
+    cortex_no_grad_end();
+
+    pool_get_stats(&stats);
+    printf("After %d requests: %zu bytes above baseline, peak %zu, %zu allocations and %zu frees\n", REQUESTS, stats.used - baseline, stats.peak, stats.allocations, stats.frees);
+
+    pool_tag_stats_t tags[4];
+    size_t num_tags = pool_get_tag_stats(tags, 4);
+    for (size_t i = 0; i < num_tags; ++i)
+    {
+        printf("Live blocks tagged \"%s\": %zu holding %zu bytes\n", tags[i].tag, tags[i].live_allocations, tags[i].live_bytes);
+    }
+
+    for (size_t i = 0; i < num_leaked; ++i)
+    {
+        pool_free(leaked[i]);
+    }
+    sequential_destroy(model);
+    pool_reset_peak();
+
+    // The large-block allocator splits and coalesces, a good place to check the counters stay exact
+    void* blocks[64];
+    for (size_t i = 0; i < 64; ++i)
+    {
+        blocks[i] = pool_alloc(512 + 97 * i);
+    }
+    for (size_t i = 0; i < 64; i += 2)
+    {
+        pool_free(blocks[i]);
+    }
+    pool_print_stats();
+    for (size_t i = 1; i < 64; i += 2)
+    {
+        pool_free(blocks[i]);
+    }
+
+    pool_get_stats(&stats);
+    printf("After teardown: used %zu, live %zu, peak since reset %zu\n", stats.used, stats.live_allocations, stats.peak);
+
+    pool_destroy();
+
+    return 0;
+}
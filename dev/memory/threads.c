@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <cortex.h>
+
+#define NUM_THREADS 8
+#define ITERATIONS 20000
+#define WINDOW 64
+#define MAILBOX_SIZE 256
+#define NUM_FREERS 4
+#define CHURN_ROUNDS 200
+#define CHURN_THREADS 4
+#define CHURN_TENSORS 64
+
+typedef struct worker
+{
+    size_t id;
+    unsigned int seed;
+    size_t errors;
+} worker_t;
+
+// Tensors parked here are destroyed by whichever thread picks them up, which exercises remote frees
+static _Atomic(tensor_t*) mailbox[MAILBOX_SIZE];
+static atomic_bool churn_done;
+
+static size_t check_tensor(const tensor_t* tensor)
+{
+    float expected = tensor->data[0];
+    for (size_t i = 1; i < tensor->size; ++i)
+    {
+        if (tensor->data[i] != expected)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void* worker_run(void* arg)
+{
+    worker_t* worker = (worker_t*)arg;
+    tensor_t* window[WINDOW] = {NULL};
+
+    for (size_t it = 0; it < ITERATIONS; ++it)
+    {
+        size_t slot = (size_t)rand_r(&worker->seed) % WINDOW;
+        if (window[slot])
+        {
+            worker->errors += check_tensor(window[slot]);
+
+            // Hand roughly a quarter of the tensors to another thread instead of destroying them locally
+            size_t box = (size_t)rand_r(&worker->seed) % MAILBOX_SIZE;
+            tensor_t* previous = atomic_exchange(&mailbox[box], ((it & 3) == 0) ? window[slot] : NULL);
+            if ((it & 3) != 0 && tensor_destroy(window[slot]) == TENSOR_DESTROY_FAILURE)
+            {
+                worker->errors++;
+            }
+            if (previous)
+            {
+                worker->errors += check_tensor(previous);
+                if (tensor_destroy(previous) == TENSOR_DESTROY_FAILURE)
+                {
+                    worker->errors++;
+                }
+            }
+            window[slot] = NULL;
+        }
+
+        size_t shape[2] = {1 + (size_t)rand_r(&worker->seed) % 64, 1 + (size_t)rand_r(&worker->seed) % 256};
+        window[slot] = tensor_full(shape, 2, (float)(worker->id * ITERATIONS + it));
+        if (window[slot] == NULL)
+        {
+            worker->errors++;
+        }
+    }
+
+    for (size_t slot = 0; slot < WINDOW; ++slot)
+    {
+        if (window[slot])
+        {
+            worker->errors += check_tensor(window[slot]);
+            tensor_destroy(window[slot]);
+        }
+    }
+
+    return NULL;
+}
+
+static size_t destroy_parked(tensor_t* tensor)
+{
+    if (tensor == NULL)
+    {
+        return 0;
+    }
+    size_t errors = check_tensor(tensor);
+    return errors + (tensor_destroy(tensor) == TENSOR_DESTROY_FAILURE);
+}
+
+// Short-lived: parks its tensors and exits, so its heap is abandoned while other threads still free into it
+static void* churn_run(void* arg)
+{
+    worker_t* worker = (worker_t*)arg;
+    for (size_t i = 0; i < CHURN_TENSORS; ++i)
+    {
+        size_t shape[2] = {1 + (size_t)rand_r(&worker->seed) % 16, 1 + (size_t)rand_r(&worker->seed) % 256};
+        tensor_t* tensor = tensor_full(shape, 2, (float)(worker->id * CHURN_TENSORS + i));
+        if (tensor == NULL)
+        {
+            worker->errors++;
+            continue;
+        }
+        size_t box = (size_t)rand_r(&worker->seed) % MAILBOX_SIZE;
+        worker->errors += destroy_parked(atomic_exchange(&mailbox[box], tensor));
+    }
+    return NULL;
+}
+
+static void* freer_run(void* arg)
+{
+    worker_t* worker = (worker_t*)arg;
+    while (!atomic_load(&churn_done))
+    {
+        size_t box = (size_t)rand_r(&worker->seed) % MAILBOX_SIZE;
+        worker->errors += destroy_parked(atomic_exchange(&mailbox[box], NULL));
+    }
+    return NULL;
+}
+
+// Threads are joined and respawned while the freers keep releasing blocks into the heaps they left behind
+static size_t run_churn(void)
+{
+    pthread_t freers[NUM_FREERS];
+    worker_t freer_state[NUM_FREERS];
+    size_t num_freers = 0;
+    size_t errors = 0;
+
+    atomic_store(&churn_done, false);
+    for (; num_freers < NUM_FREERS; ++num_freers)
+    {
+        freer_state[num_freers] = (worker_t){num_freers, (unsigned int)(num_freers + 1) * 104729u, 0};
+        if (pthread_create(&freers[num_freers], NULL, freer_run, &freer_state[num_freers]) != 0)
+        {
+            break;
+        }
+    }
+
+    for (size_t round = 0; round < CHURN_ROUNDS; ++round)
+    {
+        pthread_t threads[CHURN_THREADS];
+        worker_t workers[CHURN_THREADS];
+        size_t spawned = 0;
+        for (; spawned < CHURN_THREADS; ++spawned)
+        {
+            workers[spawned] = (worker_t){round * CHURN_THREADS + spawned, (unsigned int)(round * CHURN_THREADS + spawned + 1) * 7919u, 0};
+            if (pthread_create(&threads[spawned], NULL, churn_run, &workers[spawned]) != 0)
+            {
+                errors++;
+                break;
+            }
+        }
+        for (size_t t = 0; t < spawned; ++t)
+        {
+            pthread_join(threads[t], NULL);
+            errors += workers[t].errors;
+        }
+    }
+
+    atomic_store(&churn_done, true);
+    for (size_t t = 0; t < num_freers; ++t)
+    {
+        pthread_join(freers[t], NULL);
+        errors += freer_state[t].errors;
+    }
+    return errors;
+}
+
+int main()
+{
+    pool_init(1 * MB);
+
+    pthread_t threads[NUM_THREADS];
+    worker_t workers[NUM_THREADS];
+
+    for (size_t t = 0; t < NUM_THREADS; ++t)
+    {
+        workers[t] = (worker_t){t, (unsigned int)(t + 1) * 7919u, 0};
+        if (pthread_create(&threads[t], NULL, worker_run, &workers[t]) != 0)
+        {
+            printf("Failed to create thread %zu\n", t);
+            pool_destroy();
+            return -1;
+        }
+    }
+
+    size_t errors = 0;
+    for (size_t t = 0; t < NUM_THREADS; ++t)
+    {
+        pthread_join(threads[t], NULL);
+        errors += workers[t].errors;
+    }
+
+    errors += run_churn();
+    for (size_t box = 0; box < MAILBOX_SIZE; ++box)
+    {
+        errors += destroy_parked(atomic_exchange(&mailbox[box], NULL));
+    }
+
+    printf("Threads: %d, iterations per thread: %d\n", NUM_THREADS, ITERATIONS);
+    printf("Churn: %d rounds of %d short-lived threads against %d freers\n", CHURN_ROUNDS, CHURN_THREADS, NUM_FREERS);
+    printf("Errors: %zu\n", errors);
+    printf("Used memory: %zu bytes\n", pool_get_used_memory());
+
+    pool_destroy();
+
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <cortex.h>
+
+#define CHECKPOINT_PATH "/tmp/cortex_checkpoint.bin"
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static layer_t* build_dense(const char* name, size_t input_dim, size_t output_dim, activation_t activation, bool placeholder)
+{
+    return placeholder ? dense_create_placeholder(name, input_dim, output_dim, activation) : dense_create_with_activation(name, input_dim, output_dim, activation);
+}
+
+static sequential_t* build_model(size_t width, bool placeholder)
+{
+    sequential_t* model = sequential_create("mlp");
+    sequential_add(model, build_dense("hidden1", 256, width, ACTIVATION_RELU, placeholder));
+    sequential_add(model, build_dense("hidden2", width, width, ACTIVATION_GELU, placeholder));
+    sequential_add(model, build_dense("logits", width, 10, ACTIVATION_NONE, placeholder));
+    return model;
+}
+
+// Cold start as a server sees it: build the model, map the file and load the weights
+static sequential_t* cold_start(size_t width, bool placeholder, bool zero_copy, checkpoint_t** checkpoint, double* elapsed)
+{
+    double start = now_seconds();
+    sequential_t* model = build_model(width, placeholder);
+    *checkpoint = checkpoint_open(CHECKPOINT_PATH);
+    checkpoint_status_code_t loaded = checkpoint_load(*checkpoint, model->layers, model->num_layers, zero_copy);
+    *elapsed = now_seconds() - start;
+    if (loaded != CHECKPOINT_LOAD_SUCCESS)
+    {
+        printf("Failed to load checkpoint\n");
+    }
+    return model;
+}
+
+int main()
+{
+    pool_init(1024 * MB);
+    cortex_no_grad_begin();
+
+    size_t width = 4096;
+    sequential_t* source = build_model(width, false);
+    size_t input_shape[2] = {8, 256};
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+
+    double start = now_seconds();
+    checkpoint_status_code_t saved = checkpoint_save(CHECKPOINT_PATH, source->layers, source->num_layers);
+    printf("Saved checkpoint: %s in %.1f ms\n", saved == CHECKPOINT_SAVE_SUCCESS ? "yes" : "no", (now_seconds() - start) * 1e3);
+
+    tensor_t* expected = tensor_clone(sequential_forward(source, input));
+
+    // Layers with the same names pick up the saved weights, placeholders skip allocating and initializing what the load replaces
+    const char* names[4] = {"Copied", "Mapped", "Placeholder copied", "Placeholder mapped"};
+    sequential_t* models[4];
+    checkpoint_t* checkpoints[4];
+    double times[4];
+    for (size_t m = 0; m < 4; ++m)
+    {
+        models[m] = cold_start(width, m >= 2, m % 2 == 1, &checkpoints[m], &times[m]);
+        // Copied models no longer need the mapping
+        if (m % 2 == 0)
+        {
+            checkpoint_close(checkpoints[m]);
+            checkpoints[m] = NULL;
+        }
+    }
+    checkpoint_t* checkpoint = checkpoints[1];
+    printf("Cold start with %zu tensors (%.0f MB), construction included:\n", (size_t)checkpoint->header->num_entries, (double)checkpoint->map_size / (MB));
+    printf("  initialized layers: copy %.2f ms, zero copy %.2f ms\n", times[0] * 1e3, times[1] * 1e3);
+    printf("  placeholder layers: copy %.2f ms, zero copy %.2f ms\n", times[2] * 1e3, times[3] * 1e3);
+
+    checkpoint = checkpoints[3];
+    dense_parameters_t* params = (dense_parameters_t*)models[3]->layers[1]->params;
+    const char* map_begin = (const char*)checkpoint->map;
+    const char* weights = (const char*)params->weights->data;
+    printf("Mapped placeholder weights point into the file: %s, frozen: %s\n",
+           weights >= map_begin && weights < map_begin + checkpoint->map_size ? "yes" : "no", params->weights->frozen ? "yes" : "no");
+
+    for (size_t m = 0; m < 4; ++m)
+    {
+        tensor_t* output = sequential_forward(models[m], input);
+        float error = 0.0f;
+        for (size_t i = 0; i < output->size; ++i)
+        {
+            error = fmaxf(error, fabsf(output->data[i] - expected->data[i]));
+        }
+        printf("%s model max output error: %.2e\n", names[m], error);
+    }
+
+    // Placeholders refuse to run before a checkpoint is loaded into them
+    layer_t* empty = dense_create_placeholder("hidden1", 256, width, ACTIVATION_RELU);
+    printf("Running an unloaded placeholder: %s\n", layer_forward(empty, input) ? "accepted" : "rejected");
+    layer_destroy(empty);
+
+    // Shapes that do not match the file are rejected without touching the layers
+    layer_t* wrong = dense_create("hidden1", 256, 128);
+    printf("Loading into a mismatched layer: %s\n", checkpoint_load(checkpoint, &wrong, 1, true) == CHECKPOINT_LOAD_SUCCESS ? "accepted" : "rejected");
+    layer_destroy(wrong);
+
+    for (size_t m = 0; m < 4; ++m)
+    {
+        sequential_destroy(models[m]);
+        if (checkpoints[m])
+        {
+            checkpoint_close(checkpoints[m]);
+        }
+    }
+    sequential_destroy(source);
+    tensor_destroy(expected);
+    tensor_destroy(input);
+    remove(CHECKPOINT_PATH);
+
+    cortex_no_grad_end();
+    printf("Used memory after teardown: %zu bytes\n", pool_get_used_memory());
+
+    pool_destroy();
+
+    return 0;
+}
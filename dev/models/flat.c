@@ -0,0 +1,76 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <cortex.h>
+
+static void fill_ones(tensor_t* tensor)
+{
+    float* grad = tensor_grad(tensor);
+    for (size_t i = 0; i < tensor->size; ++i)
+    {
+        grad[i] = 1.0f;
+    }
+}
+
+int main()
+{
+    pool_init(64 * MB);
+
+    size_t batch_size = 16;
+    sequential_t* model = sequential_create("mlp");
+    sequential_add(model, dense_create_with_activation("hidden", 100, 300, ACTIVATION_RELU));
+    sequential_add(model, dense_create("logits", 300, 7));
+
+    dense_parameters_t* hidden = (dense_parameters_t*)model->layers[0]->params;
+    dense_parameters_t* logits = (dense_parameters_t*)model->layers[1]->params;
+    tensor_t* weights = hidden->weights;
+    float before = weights->data[1234];
+
+    if (sequential_flatten_parameters(model) != SEQUENTIAL_FLATTEN_SUCCESS)
+    {
+        printf("Failed to flatten parameters\n");
+        pool_destroy();
+        return -1;
+    }
+    tensor_t* flat = model->parameters;
+
+    printf("Flat buffer: %zu floats, data aligned: %s, grad aligned: %s\n", flat->size, (uintptr_t)flat->data % 64 == 0 ? "yes" : "no", (uintptr_t)flat->grad % 64 == 0 ? "yes" : "no");
+    printf("Same tensor object, value preserved: %s\n", hidden->weights == weights && weights->data[1234] == before ? "yes" : "no");
+    printf("Last bias ends inside the buffer: %s\n", logits->bias->data + logits->bias->size <= flat->data + flat->size ? "yes" : "no");
+
+    size_t input_shape[2] = {batch_size, 100};
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+    input->frozen = true;
+    sequential_compile(model, batch_size, true);
+
+    tensor_t* output = sequential_forward(model, input);
+    fill_ones(output);
+    sequential_backward(model);
+    printf("Weight grad lives in the flat grad buffer: %s\n", hidden->weights->grad == flat->grad + hidden->weights->offset ? "yes" : "no");
+
+    // Gradient clipping and zeroing are single sweeps over one buffer
+    double norm = 0.0;
+    for (size_t i = 0; i < flat->size; ++i)
+    {
+        norm += (double)flat->grad[i] * flat->grad[i];
+    }
+    printf("Gradient norm over all parameters: %.4f\n", sqrt(norm));
+    sequential_zero_grad(model);
+
+    optimizer_t* optimizer = optimizer_adam_create(1e-3f, 0.9f, 0.999f, 1e-8f, 0.0f);
+    for (size_t i = 0; i < model->num_layers; ++i)
+    {
+        optimizer_add_parameters(optimizer, model->layers[i]->params);
+    }
+    optimizer_step(optimizer);
+
+    optimizer_destroy(optimizer);
+    sequential_destroy(model);
+    tensor_destroy(input);
+
+    printf("Used memory after teardown: %zu bytes\n", pool_get_used_memory());
+
+    pool_destroy();
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <cortex.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void fill_ones(tensor_t* tensor)
+{
+    float* grad = tensor_grad(tensor);
+    for (size_t i = 0; i < tensor->size; ++i)
+    {
+        grad[i] = 1.0f;
+    }
+}
+
+int main()
+{
+    pool_init(64 * MB);
+    arena_init(8 * MB);
+
+    size_t batch_size = 32;
+    size_t steps = 200;
+
+    sequential_t* model = sequential_create("mlp");
+    sequential_add(model, dense_create_with_activation("hidden1", 256, 512, ACTIVATION_RELU));
+    sequential_add(model, dense_create_with_activation("hidden2", 512, 512, ACTIVATION_GELU));
+    sequential_add(model, dense_create("logits", 512, 10));
+
+    // Mismatched shapes are rejected when the model is built, not when it runs
+    layer_t* mismatched = dense_create("mismatched", 64, 10);
+    printf("Adding a 64-input layer after a 10-output layer: %s\n", sequential_add(model, mismatched) == SEQUENTIAL_ADD_SUCCESS ? "accepted" : "rejected");
+    layer_destroy(mismatched);
+
+    size_t input_shape[2] = {batch_size, 256};
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+    input->frozen = true;
+
+    // Uncompiled steps allocate every activation, so they run inside an arena scope
+    double start = now_seconds();
+    for (size_t step = 0; step < steps; ++step)
+    {
+        arena_begin();
+        tensor_t* output = sequential_forward(model, input);
+        fill_ones(output);
+        sequential_backward(model);
+        arena_end();
+        arena_reset();
+    }
+    double eager_time = (now_seconds() - start) / (double)steps;
+
+    if (sequential_compile(model, batch_size, true) != SEQUENTIAL_COMPILE_SUCCESS)
+    {
+        printf("Failed to compile model\n");
+        pool_destroy();
+        return -1;
+    }
+
+    size_t used_before = pool_get_used_memory();
+    start = now_seconds();
+    for (size_t step = 0; step < steps; ++step)
+    {
+        tensor_t* output = sequential_forward(model, input);
+        fill_ones(output);
+        sequential_backward(model);
+    }
+    double compiled_time = (now_seconds() - start) / (double)steps;
+
+    printf("Step time: eager %.3f ms, compiled %.3f ms\n", eager_time * 1e3, compiled_time * 1e3);
+    printf("Pool growth over %zu compiled steps: %zu bytes, planned activations: %zu bytes\n", steps, pool_get_used_memory() - used_before, memory_plan_get_size(model->plan));
+
+    sequential_destroy(model);
+    tensor_destroy(input);
+
+    arena_destroy();
+    pool_destroy();
+
+    return 0;
+}
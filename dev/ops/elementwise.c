@@ -0,0 +1,86 @@
+#include <time.h>
+#include <stdio.h>
+#include <cortex.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+    pool_init(512 * MB);
+
+    size_t rows = 4096;
+    size_t cols = 4096;
+    size_t shape[2] = {rows, cols};
+    size_t row_shape[1] = {cols};
+    size_t scalar_shape[1] = {1};
+    size_t repeats = 10;
+
+    tensor_t* a = tensor_rand(shape, 2, 1.0f);
+    tensor_t* b = tensor_rand(shape, 2, 1.0f);
+    tensor_t* bias = tensor_rand(row_shape, 1, 1.0f);
+    tensor_t* scale = tensor_full(scalar_shape, 1, 0.5f);
+    tensor_t* a_t = tensor_transpose(a, 0, 1);
+    if (a == NULL || b == NULL || bias == NULL || scale == NULL || a_t == NULL)
+    {
+        printf("Failed to allocate tensors\n");
+        pool_destroy();
+        return -1;
+    }
+
+    // Timed in no-grad mode so only the kernels are measured
+    cortex_no_grad_begin();
+
+    const char* names[5] = {"a + b", "a + bias", "a * scalar", "exp(a)", "a^T + b"};
+    size_t streams[5] = {3, 2, 2, 2, 3};
+    printf("%-12s %12s %12s\n", "op", "ms", "GB/s");
+
+    for (size_t op = 0; op < 5; ++op)
+    {
+        double start = now_seconds();
+        for (size_t r = 0; r < repeats; ++r)
+        {
+            tensor_t* y = NULL;
+            switch (op)
+            {
+                case 0: y = tensor_add(a, b); break;
+                case 1: y = tensor_add(a, bias); break;
+                case 2: y = tensor_mul(a, scale); break;
+                case 3: y = tensor_exp(a); break;
+                case 4: y = tensor_add(a_t, b); break;
+            }
+            tensor_destroy(y);
+        }
+        double elapsed = (now_seconds() - start) / (double)repeats;
+        double bytes = (double)streams[op] * (double)(rows * cols) * sizeof(float);
+        printf("%-12s %12.3f %12.2f\n", names[op], elapsed * 1e3, bytes / elapsed * 1e-9);
+    }
+
+    cortex_no_grad_end();
+
+    // Broadcast backward: the bias gradient is a column reduction over the batch
+    tensor_t* y = tensor_add(a, bias);
+    tensor_grad(y);
+    double start = now_seconds();
+    for (size_t r = 0; r < repeats; ++r)
+    {
+        tensor_backward(y);
+    }
+    double elapsed = (now_seconds() - start) / (double)repeats;
+    printf("%-12s %12.3f %12.2f\n", "d(a + bias)", elapsed * 1e3, 3.0 * (double)(rows * cols) * sizeof(float) / elapsed * 1e-9);
+
+    tensor_destroy(y);
+    tensor_destroy(a_t);
+    tensor_destroy(a);
+    tensor_destroy(b);
+    tensor_destroy(bias);
+    tensor_destroy(scale);
+
+    pool_destroy();
+
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <time.h>
+#include <math.h>
+#include <stdio.h>
+#include <cortex.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Reference loop, identical to the original dense_forward implementation
+static void naive_dense(const float* input, const float* weights, const float* bias, float* output, size_t batch_size, size_t input_dim, size_t output_dim)
+{
+    for (size_t i = 0; i < batch_size; ++i)
+    {
+        for (size_t j = 0; j < output_dim; ++j)
+        {
+            float sum = bias[j];
+            const float* input_row = &input[i * input_dim];
+            const float* weight_row = &weights[j * input_dim];
+
+            for (size_t k = 0; k < input_dim; ++k)
+            {
+                sum += input_row[k] * weight_row[k];
+            }
+            output[i * output_dim + j] = sum;
+        }
+    }
+}
+
+static void sgemm_dense(const float* input, const float* weights, const float* bias, float* output, size_t batch_size, size_t input_dim, size_t output_dim)
+{
+    for (size_t i = 0; i < batch_size; ++i)
+    {
+        for (size_t j = 0; j < output_dim; ++j)
+        {
+            output[i * output_dim + j] = bias[j];
+        }
+    }
+    cortex_sgemm(false, true, batch_size, output_dim, input_dim, 1.0f, input, input_dim, weights, input_dim, 1.0f, output, output_dim);
+}
+
+// Best of several calls, so small batches are not dominated by a single cold run
+static double best_time(void (*fn)(const float*, const float*, const float*, float*, size_t, size_t, size_t), const tensor_t* input, const tensor_t* weights, const tensor_t* bias, tensor_t* output, size_t batch_size, size_t dim, size_t repeats)
+{
+    double best = 0.0;
+    for (size_t r = 0; r < repeats; ++r)
+    {
+        double start = now_seconds();
+        fn(input->data, weights->data, bias->data, output->data, batch_size, dim, dim);
+        double elapsed = now_seconds() - start;
+        best = (r == 0 || elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+static int bench_case(size_t batch_size, size_t dim)
+{
+    size_t input_shape[2] = {batch_size, dim};
+    size_t weights_shape[2] = {dim, dim};
+    size_t bias_shape[1] = {dim};
+
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+    tensor_t* weights = tensor_rand(weights_shape, 2, 1.0f / sqrtf((float)dim));
+    tensor_t* bias = tensor_rand(bias_shape, 1, 1.0f);
+    tensor_t* expected = tensor_zeros(input_shape, 2);
+    tensor_t* actual = tensor_zeros(input_shape, 2);
+    if (input == NULL || weights == NULL || bias == NULL || expected == NULL || actual == NULL)
+    {
+        printf("Failed to allocate tensors\n");
+        return -1;
+    }
+
+    // Small batches are bandwidth-bound on the weights, large ones compute-bound
+    double flops = 2.0 * (double)batch_size * (double)dim * (double)dim;
+    size_t naive_repeats = (batch_size <= 16) ? 5 : 1;
+    double naive_time = best_time(naive_dense, input, weights, bias, expected, batch_size, dim, naive_repeats);
+    double sgemm_time = best_time(sgemm_dense, input, weights, bias, actual, batch_size, dim, 10);
+
+    float max_diff = 0.0f;
+    for (size_t i = 0; i < actual->size; ++i)
+    {
+        float diff = fabsf(actual->data[i] - expected->data[i]);
+        if (diff > max_diff)
+        {
+            max_diff = diff;
+        }
+    }
+
+    printf("%8zu %8zu %8zu %14.2f %14.2f %9.1fx %12.2e\n", batch_size, dim, dim, flops / naive_time * 1e-9, flops / sgemm_time * 1e-9, naive_time / sgemm_time, max_diff);
+
+    tensor_destroy(input);
+    tensor_destroy(weights);
+    tensor_destroy(bias);
+    tensor_destroy(expected);
+    tensor_destroy(actual);
+    return 0;
+}
+
+int main()
+{
+    pool_init(256 * MB);
+
+    srand((unsigned int)time(NULL));
+
+    size_t batches[4] = {1, 4, 16, 256};
+    size_t dims[3] = {1024, 2048, 4096};
+
+    printf("%8s %8s %8s %14s %14s %10s %12s\n", "batch", "in", "out", "naive GFLOP/s", "sgemm GFLOP/s", "speedup", "max |diff|");
+
+    for (size_t b = 0; b < 4; ++b)
+    {
+        for (size_t d = 0; d < 3; ++d)
+        {
+            if (bench_case(batches[b], dims[d]) != 0)
+            {
+                pool_destroy();
+                return -1;
+            }
+        }
+    }
+
+    pool_destroy();
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <math.h>
+#include <stdio.h>
+#include <cortex.h>
+
+static float max_difference(const tensor_t* a, const tensor_t* b)
+{
+    float difference = 0.0f;
+    for (size_t i = 0; i < a->size; ++i)
+    {
+        difference = fmaxf(difference, fabsf(a->data[i] - b->data[i]));
+    }
+    return difference;
+}
+
+int main()
+{
+    pool_init(64 * MB);
+
+    size_t batch_size = 16;
+    size_t input_dim = 256;
+    size_t hidden_dim = 256;
+    size_t steps = 100;
+
+    size_t input_shape[2] = {batch_size, input_dim};
+    size_t hidden_shape[2] = {batch_size, hidden_dim};
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+    layer_t* first = dense_create("first", input_dim, hidden_dim);
+    layer_t* second = dense_create("second", hidden_dim, hidden_dim);
+
+    // Every buffer of the serving loop is allocated once up front
+    tensor_t* hidden = tensor_empty(hidden_shape, 2);
+    tensor_t* residual = tensor_empty(hidden_shape, 2);
+    tensor_t* output = tensor_empty(hidden_shape, 2);
+    if (input == NULL || first == NULL || second == NULL || hidden == NULL || residual == NULL || output == NULL)
+    {
+        printf("Failed to create model\n");
+        pool_destroy();
+        return -1;
+    }
+
+    cortex_no_grad_begin();
+
+    size_t used_before = pool_get_used_memory();
+    for (size_t step = 0; step < steps; ++step)
+    {
+        dense_forward_out(first, input, hidden);
+        tensor_relu_(hidden);
+        dense_forward_out(second, hidden, residual);
+        tensor_add_(residual, hidden);
+        tensor_tanh_out(residual, output);
+    }
+    size_t used_after = pool_get_used_memory();
+
+    // The same network through the allocating ops
+    tensor_t* reference = tensor_tanh(tensor_add(layer_forward(second, tensor_relu(layer_forward(first, input))), tensor_relu(layer_forward(first, input))));
+
+    cortex_no_grad_end();
+
+    printf("Pool used before loop: %zu bytes, after %zu steps: %zu bytes\n", used_before, steps, used_after);
+    printf("Max difference to allocating ops: %.2e\n", max_difference(output, reference));
+
+    // With autograd on, in-place updates are refused while out variants record like the allocating ops
+    printf("In-place add with autograd on: %s\n", tensor_add_(residual, hidden) ? "accepted" : "refused");
+
+    size_t bias_shape[1] = {hidden_dim};
+    tensor_t* bias = tensor_zeros(bias_shape, 1);
+    tensor_t* sum = tensor_add_out(hidden, bias, output);
+    float* sum_grad = tensor_grad(sum);
+    for (size_t i = 0; i < sum->size; ++i)
+    {
+        sum_grad[i] = 1.0f;
+    }
+    tensor_backward(sum);
+    printf("Bias grad through add_out: %.1f (expected %.1f)\n", bias->grad[0], (float)batch_size);
+
+    pool_destroy();
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+#include <cortex.h>
+
+#define MICRO_BATCHES 4
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void fill_ones(tensor_t* tensor)
+{
+    float* grad = tensor_grad(tensor);
+    for (size_t i = 0; i < tensor->size; ++i)
+    {
+        grad[i] = 1.0f;
+    }
+}
+
+static void run_backward(layer_t* layer, const tensor_t* input)
+{
+    arena_begin();
+    tensor_t* output = layer_forward(layer, input);
+    fill_ones(output);
+    tensor_backward(output);
+    arena_end();
+    arena_reset();
+}
+
+int main()
+{
+    pool_init(512 * MB);
+    arena_init(8 * MB);
+
+    size_t micro_batch = 8;
+    size_t shape[2] = {micro_batch * MICRO_BATCHES, 64};
+    tensor_t* batch = tensor_rand(shape, 2, 1.0f);
+    batch->frozen = true;
+
+    layer_t* layer = dense_create_with_activation("hidden", 64, 32, ACTIVATION_TANH);
+    dense_parameters_t* params = (dense_parameters_t*)layer->params;
+
+    // Reference: one pass over the whole batch, averaged over the micro-batch count
+    run_backward(layer, batch);
+    size_t size = params->weights->size;
+    float* reference = (float*)pool_alloc(size * sizeof(float));
+    for (size_t i = 0; i < size; ++i)
+    {
+        reference[i] = params->weights->grad[i] / MICRO_BATCHES;
+    }
+
+    grad_accumulator_t* accumulator = grad_accumulator_create(MICRO_BATCHES);
+    grad_accumulator_add_parameters(accumulator, layer->params);
+    grad_accumulator_zero_grad(accumulator);
+    printf("Gradients cleared: %s\n", params->weights->grad[0] == 0.0f && params->bias->grad[0] == 0.0f ? "yes" : "no");
+
+    size_t ready_after = 0;
+    for (size_t m = 0; m < MICRO_BATCHES; ++m)
+    {
+        size_t micro_shape[2] = {micro_batch, 64};
+        tensor_t* micro = tensor_zeros(micro_shape, 2);
+        micro->frozen = true;
+        memcpy(micro->data, batch->data + m * micro_batch * 64, micro_batch * 64 * sizeof(float));
+        run_backward(layer, micro);
+        tensor_destroy(micro);
+        if (grad_accumulator_step(accumulator))
+        {
+            ready_after = m + 1;
+        }
+    }
+
+    double error = 0.0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        error = fmax(error, fabs(reference[i] - params->weights->grad[i]));
+    }
+    printf("Optimizer step ready after %zu micro-batches, max error against full batch: %.2e\n", ready_after, error);
+    pool_free(reference);
+
+    // Clearing a large flattened model: one kernel sweep against a loop over every tensor
+    size_t num_layers = 16;
+    sequential_t* model = sequential_create("wide");
+    for (size_t i = 0; i < num_layers; ++i)
+    {
+        sequential_add(model, dense_create(NULL, 2048, 2048));
+    }
+    sequential_flatten_parameters(model);
+    size_t steps = 20;
+
+    double start = now_seconds();
+    for (size_t step = 0; step < steps; ++step)
+    {
+        for (size_t i = 0; i < num_layers; ++i)
+        {
+            parameters_t* group = model->layers[i]->params;
+            for (size_t j = 0; j < group->num_params; ++j)
+            {
+                tensor_t* param = group->params_array[j];
+                for (size_t k = 0; k < param->size; ++k)
+                {
+                    param->grad[k] = 0.0f;
+                }
+            }
+        }
+    }
+    double loop_time = (now_seconds() - start) / (double)steps;
+
+    start = now_seconds();
+    for (size_t step = 0; step < steps; ++step)
+    {
+        sequential_zero_grad(model);
+    }
+    double sweep_time = (now_seconds() - start) / (double)steps;
+
+    printf("Zeroing %.0f MB of gradients: per tensor loop %.3f ms, sequential_zero_grad %.3f ms\n", (double)(model->parameters->size * sizeof(float)) / (MB), loop_time * 1e3, sweep_time * 1e3);
+
+    sequential_destroy(model);
+    grad_accumulator_destroy(accumulator);
+    layer_destroy(layer);
+    tensor_destroy(batch);
+
+    arena_destroy();
+    printf("Used memory after teardown: %zu bytes\n", pool_get_used_memory());
+
+    pool_destroy();
+
+    return 0;
+}
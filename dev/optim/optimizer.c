@@ -0,0 +1,127 @@
+#include <math.h>
+#include <time.h>
+#include <stdio.h>
+#include <string.h>
+#include <cortex.h>
+
+#define NUM_LAYERS 8
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Naive double precision replay of a few steps on one tensor, compared against the fused kernels
+static double reference_error(optimizer_t* optimizer, size_t steps)
+{
+    size_t n = 1000;
+    size_t shape[1] = {n};
+    tensor_t* param = tensor_rand(shape, 1, 1.0f);
+    double p[1000], m[1000] = {0}, v[1000] = {0};
+    for (size_t i = 0; i < n; ++i)
+    {
+        p[i] = param->data[i];
+    }
+
+    parameters_t params = {1, &param, NULL, NULL};
+    optimizer_add_parameters(optimizer, &params);
+
+    for (size_t step = 1; step <= steps; ++step)
+    {
+        float* grad = tensor_grad(param);
+        for (size_t i = 0; i < n; ++i)
+        {
+            grad[i] = sinf((float)(i * step));
+        }
+        double lr = optimizer->learning_rate;
+        double wd = optimizer->weight_decay;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double g = grad[i];
+            if (optimizer->type == OPTIMIZER_SGD)
+            {
+                g += wd * p[i];
+                m[i] = optimizer->momentum * m[i] + g;
+                p[i] -= lr * (optimizer->nesterov ? g + optimizer->momentum * m[i] : m[i]);
+                continue;
+            }
+            if (optimizer->type == OPTIMIZER_ADAMW)
+            {
+                p[i] -= lr * wd * p[i];
+            }
+            else
+            {
+                g += wd * p[i];
+            }
+            m[i] = optimizer->beta1 * m[i] + (1.0 - optimizer->beta1) * g;
+            v[i] = optimizer->beta2 * v[i] + (1.0 - optimizer->beta2) * g * g;
+            double m_hat = m[i] / (1.0 - pow(optimizer->beta1, (double)step));
+            double v_hat = v[i] / (1.0 - pow(optimizer->beta2, (double)step));
+            p[i] -= lr * m_hat / (sqrt(v_hat) + optimizer->epsilon);
+        }
+        optimizer_step(optimizer);
+    }
+
+    double error = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        error = fmax(error, fabs(p[i] - param->data[i]));
+    }
+    tensor_destroy(param);
+    optimizer_destroy(optimizer);
+    return error;
+}
+
+int main()
+{
+    pool_init(256 * MB);
+
+    printf("SGD            max error: %.2e\n", reference_error(optimizer_sgd_create(0.1f, 0.0f, false, 0.01f), 5));
+    printf("SGD momentum   max error: %.2e\n", reference_error(optimizer_sgd_create(0.1f, 0.9f, false, 0.01f), 5));
+    printf("SGD nesterov   max error: %.2e\n", reference_error(optimizer_sgd_create(0.1f, 0.9f, true, 0.01f), 5));
+    printf("Adam           max error: %.2e\n", reference_error(optimizer_adam_create(1e-2f, 0.9f, 0.999f, 1e-8f, 0.01f), 5));
+    printf("AdamW          max error: %.2e\n", reference_error(optimizer_adamw_create(1e-2f, 0.9f, 0.999f, 1e-8f, 0.01f), 5));
+
+    // A model with many mid-sized tensors, where launching once per tensor costs the most
+    layer_t* layers[NUM_LAYERS];
+    optimizer_t* optimizer = optimizer_adamw_create(1e-3f, 0.9f, 0.999f, 1e-8f, 0.01f);
+    size_t total = 0;
+    for (size_t i = 0; i < NUM_LAYERS; ++i)
+    {
+        layers[i] = dense_create(NULL, 512, 512);
+        dense_parameters_t* params = (dense_parameters_t*)layers[i]->params;
+        memset(tensor_grad(params->weights), 0, params->weights->size * sizeof(float));
+        memset(tensor_grad(params->bias), 0, params->bias->size * sizeof(float));
+        optimizer_add_parameters(optimizer, layers[i]->params);
+        total += params->weights->size + params->bias->size;
+    }
+    layers[0]->params->freeze_params(layers[0]->params);
+
+    size_t steps = 100;
+    double times[2];
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        optimizer->multi_tensor = mode == 1;
+        double start = now_seconds();
+        for (size_t step = 0; step < steps; ++step)
+        {
+            optimizer_step(optimizer);
+        }
+        times[mode] = (now_seconds() - start) / (double)steps;
+    }
+
+    printf("AdamW over %zu parameters: per tensor %.3f ms, multi tensor %.3f ms\n", total, times[0] * 1e3, times[1] * 1e3);
+    printf("Frozen layer has optimizer state: %s\n", optimizer->moment1[0] || optimizer->moment2[0] ? "yes" : "no");
+
+    optimizer_destroy(optimizer);
+    for (size_t i = 0; i < NUM_LAYERS; ++i)
+    {
+        layer_destroy(layers[i]);
+    }
+
+    pool_destroy();
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <time.h>
+#include <stdio.h>
+#include <cortex.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void fill_ones(tensor_t* tensor)
+{
+    float* grad = tensor_grad(tensor);
+    for (size_t i = 0; i < tensor->size; ++i)
+    {
+        grad[i] = 1.0f;
+    }
+}
+
+// Tiny in-place adds are all overhead, so they show what an idle hook costs per call
+static double time_small_op(tensor_t* a, const tensor_t* b, size_t calls)
+{
+    double start = now_seconds();
+    for (size_t i = 0; i < calls; ++i)
+    {
+        tensor_add_(a, b);
+    }
+    return (now_seconds() - start) / (double)calls;
+}
+
+int main()
+{
+    pool_init(64 * MB);
+    arena_init(8 * MB);
+
+    size_t small_shape[1] = {16};
+    tensor_t* a = tensor_zeros(small_shape, 1);
+    tensor_t* b = tensor_rand(small_shape, 1, 1.0f);
+    size_t calls = 2000000;
+    cortex_no_grad_begin();
+    time_small_op(a, b, calls / 10);
+    double disabled = time_small_op(a, b, calls);
+    profiler_enable();
+    double enabled = time_small_op(a, b, calls / 10);
+    profiler_disable();
+    cortex_no_grad_end();
+    profiler_reset();
+    printf("16-element add_: %.1f ns with the profiler off, %.1f ns with it on\n", disabled * 1e9, enabled * 1e9);
+
+    size_t batch_size = 32;
+    sequential_t* model = sequential_create("mlp");
+    sequential_add(model, dense_create_with_activation("hidden1", 256, 512, ACTIVATION_RELU));
+    sequential_add(model, dense_create_with_activation("hidden2", 512, 512, ACTIVATION_GELU));
+    sequential_add(model, dense_create("logits", 512, 10));
+    optimizer_t* optimizer = optimizer_adam_create(1e-3f, 0.9f, 0.999f, 1e-8f, 0.0f);
+    for (size_t i = 0; i < model->num_layers; ++i)
+    {
+        optimizer_add_parameters(optimizer, model->layers[i]->params);
+    }
+
+    size_t input_shape[2] = {batch_size, 256};
+    tensor_t* input = tensor_rand(input_shape, 2, 1.0f);
+    input->frozen = true;
+
+    // Eager steps go through the autograd engine and allocate their activations, both of which show up per call site
+    profiler_enable();
+    for (size_t step = 0; step < 20; ++step)
+    {
+        arena_begin();
+        tensor_t* output = sequential_forward(model, input);
+        tensor_t* squashed = tensor_tanh(output);
+        fill_ones(squashed);
+        tensor_backward(squashed);
+        arena_end();
+        arena_reset();
+        optimizer_step(optimizer);
+        sequential_zero_grad(model);
+    }
+    profiler_disable();
+
+    profiler_print();
+    printf("Trace export: %s\n", profiler_export_trace("/tmp/cortex_trace.json") == PROFILER_EXPORT_SUCCESS ? "/tmp/cortex_trace.json" : "failed");
+    profiler_reset();
+
+    optimizer_destroy(optimizer);
+    sequential_destroy(model);
+    tensor_destroy(input);
+    tensor_destroy(b);
+    tensor_destroy(a);
+    arena_destroy();
+
+    printf("Used memory after teardown: %zu bytes\n", pool_get_used_memory());
+
+    pool_destroy();
+
+    return 0;
+}
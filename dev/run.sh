@@ -6,33 +6,20 @@ PROGRAM_NAME=$(basename "$PROGRAM_SRC" .c)
 PROGRAM_DIR=$(dirname "$PROGRAM_SRC")
 BASE_DIR=$(dirname "$PROGRAM_DIR")
 BIN_DIR="$BASE_DIR/bin/$PROGRAM_NAME"
+ROOT_DIR=$(cd "$(dirname "$0")/.." && pwd)
+LIB_DIR="$ROOT_DIR/build/lib"
 
 # Create the binary directory if it doesn't exist
 mkdir -p "$BIN_DIR"
 
-# Uninstall the library 
-sudo make uninstall
-
-# Clean project directory 
-make clean
-
-# Compile the library 
-make
-
-# Install the library 
-sudo make install
+# Build the library in the source tree, nothing is installed
+make -C "$ROOT_DIR" || exit 1
 
 # Remove existing binary file
 rm -f "$BIN_DIR/$PROGRAM_NAME"
 
-# Compile the program and place the binary in the specified directory
-gcc -o "$BIN_DIR/$PROGRAM_NAME" "$PROGRAM_SRC" -lcortex -L/usr/local/lib -I/usr/local/include/cortex -lm
-
-# Include installation path to shared library search path
-export LD_LIBRARY_PATH=/usr/local/lib:$LD_LIBRARY_PATH
-
-# Reload the .bashrc file in current shell session
-source ~/.bashrc
+# Compile the program against the local build, the library path is embedded in the binary
+gcc -o "$BIN_DIR/$PROGRAM_NAME" "$PROGRAM_SRC" -lcortex -L"$LIB_DIR" -I"$ROOT_DIR/include" -Wl,-rpath,"$LIB_DIR" -lm
 
 # Run the program
 if [ $? -eq 0 ]; then
@@ -40,4 +27,4 @@ if [ $? -eq 0 ]; then
     "$BIN_DIR/$PROGRAM_NAME"
 else
     exit 1
-fi
\ No newline at end of file
+fi
@@ -0,0 +1,62 @@
+#include <time.h>
+#include <stdio.h>
+#include <cortex.h>
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+    pool_init(256 * MB);
+
+    // 32M floats, a 128 MB activation
+    size_t shape[2] = {8192, 4096};
+    size_t flat_shape[1] = {8192 * 4096};
+    tensor_t* activation = tensor_rand(shape, 2, 1.0f);
+    if (activation == NULL)
+    {
+        printf("Failed to create activation\n");
+        pool_destroy();
+        return -1;
+    }
+
+    double start = now_seconds();
+    tensor_t* flat = tensor_reshape(activation, flat_shape, 1);
+    double reshape_time = now_seconds() - start;
+    printf("reshape:   %10.3f us, shares storage: %s\n", reshape_time * 1e6, (flat && flat->storage == activation->storage) ? "yes" : "no");
+
+    start = now_seconds();
+    tensor_t* transposed = tensor_transpose(activation, 0, 1);
+    double transpose_time = now_seconds() - start;
+    printf("transpose: %10.3f us, contiguous: %s\n", transpose_time * 1e6, tensor_is_contiguous(transposed) ? "yes" : "no");
+
+    start = now_seconds();
+    tensor_t* half = tensor_narrow(activation, 0, 0, shape[0] / 2);
+    double narrow_time = now_seconds() - start;
+    printf("narrow:    %10.3f us, first element matches: %s\n", narrow_time * 1e6, (half && half->data[0] == activation->data[0]) ? "yes" : "no");
+
+    // Reshaping a strided view has to gather its elements into new storage
+    start = now_seconds();
+    tensor_t* gathered = tensor_reshape(transposed, flat_shape, 1);
+    double gather_time = now_seconds() - start;
+    printf("reshape of transpose: %10.3f ms, shares storage: %s\n", gather_time * 1e3, (gathered && gathered->storage == activation->storage) ? "yes" : "no");
+
+    // Views keep the storage alive on their own
+    float expected = activation->data[1];
+    tensor_destroy(activation);
+    tensor_destroy(flat);
+    tensor_destroy(transposed);
+    printf("narrow still readable after base destroy: %s\n", half->data[1] == expected ? "yes" : "no");
+    tensor_destroy(half);
+    tensor_destroy(gathered);
+
+    printf("Used memory: %zu bytes\n", pool_get_used_memory());
+
+    pool_destroy();
+
+    return 0;
+}
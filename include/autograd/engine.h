@@ -0,0 +1,8 @@
+#ifndef AUTOGRAD_ENGINE_H
+#define AUTOGRAD_ENGINE_H
+
+struct tensor;
+
+void autograd_backward(struct tensor* root);
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef AUTOGRAD_MODE_H
+#define AUTOGRAD_MODE_H
+
+#include <stdbool.h>
+
+void cortex_no_grad_begin();
+void cortex_no_grad_end();
+bool cortex_is_grad_enabled();
+
+#endif
@@ -3,11 +3,27 @@
 
 #include "utils/status/status.h"
 #include "utils/memory/pool.h"
+#include "utils/memory/arena.h"
+#include "utils/thread/parallel.h"
+#include "utils/profiler/profiler.h"
 #include "utils/tensor/tensor.h"
 #include "tensor/tensor.h"
+#include "autograd/mode.h"
+#include "autograd/engine.h"
 #include "ops/forward/forward.h"
 #include "ops/backward/backward.h"
+#include "ops/kernels/gemm.h"
+#include "ops/kernels/reduce.h"
+#include "ops/kernels/elementwise.h"
+#include "ops/kernels/activation.h"
+#include "ops/kernels/optimizer.h"
+#include "ops/kernels/quantized.h"
 #include "nn/layers/layer.h"
 #include "nn/layers/dense.h"
+#include "nn/planner/planner.h"
+#include "nn/models/sequential.h"
+#include "nn/checkpoint/checkpoint.h"
+#include "optim/optimizer.h"
+#include "optim/accumulator.h"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef NN_CHECKPOINT_H
+#define NN_CHECKPOINT_H
+
+#include <stdint.h>
+#include "nn/layers/layer.h"
+
+#define CHECKPOINT_MAGIC 0x58545243u
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_ALIGNMENT 64
+#define CHECKPOINT_NAME_SIZE 128
+
+typedef struct checkpoint_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t num_entries;
+    uint64_t data_offset;
+    uint64_t file_size;
+} checkpoint_header_t;
+
+typedef struct checkpoint_entry
+{
+    char name[CHECKPOINT_NAME_SIZE];
+    uint32_t dtype;
+    uint32_t ndim;
+    uint64_t shape[MAX_DIMS];
+    uint64_t offset;
+    uint64_t bytes;
+} checkpoint_entry_t;
+
+typedef struct checkpoint
+{
+    void *map;
+    size_t map_size;
+    const checkpoint_header_t *header;
+    const checkpoint_entry_t *entries;
+} checkpoint_t;
+
+checkpoint_status_code_t checkpoint_save(const char *path, layer_t **layers, size_t num_layers);
+checkpoint_t* checkpoint_open(const char *path);
+checkpoint_status_code_t checkpoint_load(checkpoint_t *checkpoint, layer_t **layers, size_t num_layers, bool zero_copy);
+checkpoint_status_code_t checkpoint_close(checkpoint_t *checkpoint);
+
+#endif
@@ -2,12 +2,14 @@
 #define NN_DENSE_H
 
 #include "nn/layers/layer.h"
+#include "ops/kernels/activation.h"
 
 typedef struct dense_parameters
 {
     parameters_t base;
     tensor_t *weights;
     tensor_t *bias;
+    tensor_t *scales;
 } dense_parameters_t;
 
 typedef struct dense_layer_t
@@ -15,15 +17,28 @@ typedef struct dense_layer_t
     layer_t base;
     size_t input_dim;
     size_t output_dim;
+    activation_t activation;
 } dense_layer_t;
 
+typedef struct dense_context
+{
+    layer_t *layer;
+    tensor_t *preactivation;
+} dense_context_t;
+
 parameters_t* dense_parameters_create(size_t input_dim, size_t output_dim);
 void dense_parameters_freeze(parameters_t *self);
 parameters_status_code_t dense_parameters_destroy(parameters_t *self);
 
 layer_t* dense_create(const char *name, size_t input_dim, size_t output_dim);
+layer_t* dense_create_with_activation(const char *name, size_t input_dim, size_t output_dim, activation_t activation);
+layer_t* dense_create_placeholder(const char *name, size_t input_dim, size_t output_dim, activation_t activation);
 tensor_t* dense_forward(layer_t *self, const tensor_t *input);
+tensor_t* dense_forward_out(layer_t *self, const tensor_t *input, tensor_t *output);
+tensor_t* dense_forward_into(layer_t *self, const tensor_t *input, tensor_t *output);
 void dense_backward(tensor_t *output);
+bool dense_attach_preactivation(layer_t *self, tensor_t *output, tensor_t *preactivation);
+layer_status_code_t dense_quantize(layer_t *self, tensor_dtype_t dtype);
 layer_status_code_t dense_destroy(layer_t *self);
 
 #endif
\ No newline at end of file
@@ -3,12 +3,15 @@
 
 #include "tensor/tensor.h"
 
+#define PARAMETERS_ALIGNMENT 16
+
 typedef struct parameters
 {
     size_t num_params;
     tensor_t **params_array;
     void (*freeze_params)(struct parameters *self);
     parameters_status_code_t (*free)(struct parameters *self);
+    const char *const *names;
 } parameters_t;
 
 typedef struct layer_t
@@ -23,6 +26,10 @@ typedef struct layer_t
 } layer_t;
 
 parameters_status_code_t parameters_destroy(parameters_t *params);
+tensor_t* parameters_flatten(parameters_t **groups, size_t num_groups);
+void parameters_zero_grad(parameters_t *params);
+void parameters_scale_grad(parameters_t *params, float scale);
+void layer_zero_grad(layer_t *layer);
 layer_status_code_t layer_destroy(layer_t *layer);
 
 static inline tensor_t *layer_forward(layer_t *self, const tensor_t *x)
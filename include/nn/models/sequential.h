@@ -0,0 +1,29 @@
+#ifndef NN_SEQUENTIAL_H
+#define NN_SEQUENTIAL_H
+
+#include "nn/layers/layer.h"
+#include "nn/planner/planner.h"
+
+typedef struct sequential
+{
+    char *name;
+    size_t num_layers;
+    size_t capacity;
+    layer_t **layers;
+    size_t input_dim;
+    size_t output_dim;
+    memory_plan_t *plan;
+    tensor_t *parameters;
+    tensor_t *output;
+} sequential_t;
+
+sequential_t* sequential_create(const char *name);
+sequential_status_code_t sequential_add(sequential_t *model, layer_t *layer);
+sequential_status_code_t sequential_flatten_parameters(sequential_t *model);
+sequential_status_code_t sequential_compile(sequential_t *model, size_t batch_size, bool training);
+tensor_t* sequential_forward(sequential_t *model, const tensor_t *input);
+void sequential_backward(sequential_t *model);
+void sequential_zero_grad(sequential_t *model);
+sequential_status_code_t sequential_destroy(sequential_t *model);
+
+#endif
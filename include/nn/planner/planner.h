@@ -0,0 +1,40 @@
+#ifndef NN_PLANNER_H
+#define NN_PLANNER_H
+
+#include "nn/layers/layer.h"
+
+typedef struct memory_plan_buffer
+{
+    size_t size;
+    size_t first;
+    size_t last;
+    size_t offset;
+} memory_plan_buffer_t;
+
+typedef struct memory_plan
+{
+    layer_t **layers;
+    size_t num_layers;
+    size_t batch_size;
+    bool training;
+    size_t num_buffers;
+    memory_plan_buffer_t *buffers;
+    void *memory;
+    float *block;
+    size_t block_size;
+    size_t peak_size;
+    size_t unplanned_size;
+    tensor_t **outputs;
+    float **grads;
+    tensor_t **preactivations;
+} memory_plan_t;
+
+memory_plan_t* memory_plan_create(layer_t **layers, size_t num_layers, size_t batch_size, bool training);
+tensor_t* memory_plan_forward(memory_plan_t *plan, const tensor_t *input);
+void memory_plan_backward(memory_plan_t *plan);
+size_t memory_plan_get_size(const memory_plan_t *plan);
+size_t memory_plan_get_peak(const memory_plan_t *plan);
+size_t memory_plan_get_unplanned_size(const memory_plan_t *plan);
+memory_plan_status_code_t memory_plan_destroy(memory_plan_t *plan);
+
+#endif
@@ -4,6 +4,20 @@
 #include "tensor/tensor.h"
 
 void tensor_add_backward(tensor_t* self);
+void tensor_sub_backward(tensor_t* self);
+void tensor_mul_backward(tensor_t* self);
+void tensor_div_backward(tensor_t* self);
+void tensor_maximum_backward(tensor_t* self);
+void tensor_minimum_backward(tensor_t* self);
+void tensor_neg_backward(tensor_t* self);
+void tensor_abs_backward(tensor_t* self);
+void tensor_sqrt_backward(tensor_t* self);
+void tensor_exp_backward(tensor_t* self);
+void tensor_log_backward(tensor_t* self);
+void tensor_tanh_backward(tensor_t* self);
+void tensor_sigmoid_backward(tensor_t* self);
+void tensor_relu_backward(tensor_t* self);
 void tensor_reshape_backward(tensor_t* self);
+void tensor_view_backward(tensor_t* self);
 
-#endif
\ No newline at end of file
+#endif
@@ -4,6 +4,52 @@
 #include "tensor/tensor.h"
 
 tensor_t* tensor_add(const tensor_t* a, const tensor_t* b);
+tensor_t* tensor_add_out(const tensor_t* a, const tensor_t* b, tensor_t* out);
+tensor_t* tensor_add_(tensor_t* a, const tensor_t* b);
+tensor_t* tensor_sub(const tensor_t* a, const tensor_t* b);
+tensor_t* tensor_sub_out(const tensor_t* a, const tensor_t* b, tensor_t* out);
+tensor_t* tensor_sub_(tensor_t* a, const tensor_t* b);
+tensor_t* tensor_mul(const tensor_t* a, const tensor_t* b);
+tensor_t* tensor_mul_out(const tensor_t* a, const tensor_t* b, tensor_t* out);
+tensor_t* tensor_mul_(tensor_t* a, const tensor_t* b);
+tensor_t* tensor_div(const tensor_t* a, const tensor_t* b);
+tensor_t* tensor_div_out(const tensor_t* a, const tensor_t* b, tensor_t* out);
+tensor_t* tensor_div_(tensor_t* a, const tensor_t* b);
+tensor_t* tensor_maximum(const tensor_t* a, const tensor_t* b);
+tensor_t* tensor_maximum_out(const tensor_t* a, const tensor_t* b, tensor_t* out);
+tensor_t* tensor_maximum_(tensor_t* a, const tensor_t* b);
+tensor_t* tensor_minimum(const tensor_t* a, const tensor_t* b);
+tensor_t* tensor_minimum_out(const tensor_t* a, const tensor_t* b, tensor_t* out);
+tensor_t* tensor_minimum_(tensor_t* a, const tensor_t* b);
+tensor_t* tensor_neg(const tensor_t* x);
+tensor_t* tensor_neg_out(const tensor_t* x, tensor_t* out);
+tensor_t* tensor_neg_(tensor_t* x);
+tensor_t* tensor_abs(const tensor_t* x);
+tensor_t* tensor_abs_out(const tensor_t* x, tensor_t* out);
+tensor_t* tensor_abs_(tensor_t* x);
+tensor_t* tensor_sqrt(const tensor_t* x);
+tensor_t* tensor_sqrt_out(const tensor_t* x, tensor_t* out);
+tensor_t* tensor_sqrt_(tensor_t* x);
+tensor_t* tensor_exp(const tensor_t* x);
+tensor_t* tensor_exp_out(const tensor_t* x, tensor_t* out);
+tensor_t* tensor_exp_(tensor_t* x);
+tensor_t* tensor_log(const tensor_t* x);
+tensor_t* tensor_log_out(const tensor_t* x, tensor_t* out);
+tensor_t* tensor_log_(tensor_t* x);
+tensor_t* tensor_tanh(const tensor_t* x);
+tensor_t* tensor_tanh_out(const tensor_t* x, tensor_t* out);
+tensor_t* tensor_tanh_(tensor_t* x);
+tensor_t* tensor_sigmoid(const tensor_t* x);
+tensor_t* tensor_sigmoid_out(const tensor_t* x, tensor_t* out);
+tensor_t* tensor_sigmoid_(tensor_t* x);
+tensor_t* tensor_relu(const tensor_t* x);
+tensor_t* tensor_relu_out(const tensor_t* x, tensor_t* out);
+tensor_t* tensor_relu_(tensor_t* x);
 tensor_t* tensor_reshape(const tensor_t* tensor, const size_t* new_shape, size_t new_ndim);
+tensor_t* tensor_reshape_out(const tensor_t* tensor, tensor_t* out);
+tensor_t* tensor_transpose(const tensor_t* tensor, size_t dim0, size_t dim1);
+tensor_t* tensor_permute(const tensor_t* tensor, const size_t* dims);
+tensor_t* tensor_narrow(const tensor_t* tensor, size_t dim, size_t start, size_t length);
+tensor_t* tensor_expand(const tensor_t* tensor, const size_t* shape, size_t ndim);
 
-#endif
\ No newline at end of file
+#endif
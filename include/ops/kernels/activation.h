@@ -0,0 +1,18 @@
+#ifndef OPS_KERNELS_ACTIVATION_H
+#define OPS_KERNELS_ACTIVATION_H
+
+#include <stddef.h>
+
+typedef enum activation
+{
+    ACTIVATION_NONE,
+    ACTIVATION_RELU,
+    ACTIVATION_GELU,
+    ACTIVATION_SIGMOID,
+    ACTIVATION_TANH
+} activation_t;
+
+void cortex_sactivation(activation_t activation, size_t m, size_t n, const float* bias, float* c, size_t ldc, float* z, size_t ldz);
+void cortex_sactivation_grad(activation_t activation, size_t m, size_t n, const float* y, const float* z, const float* dy, float* dz, size_t ld);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef OPS_KERNELS_ELEMENTWISE_H
+#define OPS_KERNELS_ELEMENTWISE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum binary_op
+{
+    BINARY_ADD,
+    BINARY_SUB,
+    BINARY_MUL,
+    BINARY_DIV,
+    BINARY_MAX,
+    BINARY_MIN
+} binary_op_t;
+
+typedef enum unary_op
+{
+    UNARY_NEG,
+    UNARY_ABS,
+    UNARY_SQRT,
+    UNARY_EXP,
+    UNARY_LOG,
+    UNARY_TANH,
+    UNARY_SIGMOID,
+    UNARY_RELU
+} unary_op_t;
+
+void cortex_sbinary(binary_op_t op, size_t ndim, const size_t* shape, const float* a, const size_t* a_stride, const float* b, const size_t* b_stride, float* y);
+void cortex_sbinary_grad(binary_op_t op, bool wrt_b, size_t ndim, const size_t* shape, const float* a, const size_t* a_stride, const float* b, const size_t* b_stride, const float* y, const float* dy, float* dx);
+void cortex_sunary(unary_op_t op, size_t ndim, const size_t* shape, const float* x, const size_t* x_stride, float* y);
+void cortex_sunary_grad(unary_op_t op, size_t ndim, const size_t* shape, const float* x, const size_t* x_stride, const float* y, const float* dy, float* dx);
+void cortex_scopy(size_t ndim, const size_t* shape, const float* x, const size_t* x_stride, float* y);
+void cortex_saccumulate(size_t ndim, const size_t* shape, const float* x, float* y, const size_t* y_stride);
+void cortex_sfill(size_t n, float value, float* y);
+void cortex_sscal(size_t n, float alpha, float* y);
+
+#endif
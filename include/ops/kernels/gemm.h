@@ -0,0 +1,18 @@
+#ifndef OPS_KERNELS_GEMM_H
+#define OPS_KERNELS_GEMM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "ops/kernels/activation.h"
+
+typedef struct sgemm_epilogue
+{
+    const float* bias;
+    activation_t activation;
+    float* preactivation;
+} sgemm_epilogue_t;
+
+void cortex_sgemm(bool trans_a, bool trans_b, size_t m, size_t n, size_t k, float alpha, const float* a, size_t lda, const float* b, size_t ldb, float beta, float* c, size_t ldc);
+void cortex_sgemm_fused(bool trans_a, bool trans_b, size_t m, size_t n, size_t k, float alpha, const float* a, size_t lda, const float* b, size_t ldb, float beta, float* c, size_t ldc, const sgemm_epilogue_t* epilogue);
+
+#endif
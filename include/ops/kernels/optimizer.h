@@ -0,0 +1,30 @@
+#ifndef OPS_KERNELS_OPTIMIZER_H
+#define OPS_KERNELS_OPTIMIZER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct sgd_update
+{
+    float learning_rate;
+    float momentum;
+    float weight_decay;
+    bool nesterov;
+    bool zero_grad;
+} sgd_update_t;
+
+typedef struct adam_update
+{
+    float beta1;
+    float beta2;
+    float step_size;
+    float epsilon;
+    float weight_decay;
+    float decay;
+    bool zero_grad;
+} adam_update_t;
+
+void cortex_ssgd(const sgd_update_t* update, size_t n, float* param, float* grad, float* velocity);
+void cortex_sadam(const adam_update_t* update, size_t n, float* param, float* grad, float* m, float* v);
+
+#endif
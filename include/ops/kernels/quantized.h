@@ -0,0 +1,14 @@
+#ifndef OPS_KERNELS_QUANTIZED_H
+#define OPS_KERNELS_QUANTIZED_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "tensor/dtype.h"
+#include "ops/kernels/gemm.h"
+
+void cortex_squantize_rows(size_t m, size_t k, const float* x, size_t ldx, int8_t* q, float* scales);
+void cortex_sconvert_to(tensor_dtype_t dtype, size_t n, const float* x, void* y);
+void cortex_sconvert_from(tensor_dtype_t dtype, size_t n, const void* x, float* y);
+void cortex_sgemm_reduced(tensor_dtype_t dtype, size_t m, size_t n, size_t k, const float* a, size_t lda, const void* b, const float* b_scales, float* c, size_t ldc, const sgemm_epilogue_t* epilogue);
+
+#endif
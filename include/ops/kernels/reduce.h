@@ -0,0 +1,8 @@
+#ifndef OPS_KERNELS_REDUCE_H
+#define OPS_KERNELS_REDUCE_H
+
+#include <stddef.h>
+
+void cortex_scolsum(size_t m, size_t n, const float* a, size_t lda, float* y);
+
+#endif
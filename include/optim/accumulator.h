@@ -0,0 +1,21 @@
+#ifndef OPTIM_ACCUMULATOR_H
+#define OPTIM_ACCUMULATOR_H
+
+#include "nn/layers/layer.h"
+
+typedef struct grad_accumulator
+{
+    size_t steps;
+    size_t micro_step;
+    size_t num_groups;
+    size_t capacity;
+    parameters_t **groups;
+} grad_accumulator_t;
+
+grad_accumulator_t* grad_accumulator_create(size_t steps);
+grad_accumulator_status_code_t grad_accumulator_add_parameters(grad_accumulator_t *accumulator, parameters_t *params);
+bool grad_accumulator_step(grad_accumulator_t *accumulator);
+void grad_accumulator_zero_grad(grad_accumulator_t *accumulator);
+grad_accumulator_status_code_t grad_accumulator_destroy(grad_accumulator_t *accumulator);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef OPTIM_OPTIMIZER_H
+#define OPTIM_OPTIMIZER_H
+
+#include "nn/layers/layer.h"
+
+typedef enum optimizer_type
+{
+    OPTIMIZER_SGD,
+    OPTIMIZER_ADAM,
+    OPTIMIZER_ADAMW
+} optimizer_type_t;
+
+typedef struct optimizer
+{
+    optimizer_type_t type;
+    float learning_rate;
+    float momentum;
+    bool nesterov;
+    float beta1;
+    float beta2;
+    float epsilon;
+    float weight_decay;
+    bool zero_grad;
+    bool multi_tensor;
+    size_t step;
+    size_t num_params;
+    size_t capacity;
+    tensor_t **params;
+    float **moment1;
+    float **moment2;
+    size_t *chunks;
+} optimizer_t;
+
+optimizer_t* optimizer_sgd_create(float learning_rate, float momentum, bool nesterov, float weight_decay);
+optimizer_t* optimizer_adam_create(float learning_rate, float beta1, float beta2, float epsilon, float weight_decay);
+optimizer_t* optimizer_adamw_create(float learning_rate, float beta1, float beta2, float epsilon, float weight_decay);
+optimizer_status_code_t optimizer_add_parameters(optimizer_t *optimizer, parameters_t *params);
+optimizer_status_code_t optimizer_step(optimizer_t *optimizer);
+optimizer_status_code_t optimizer_destroy(optimizer_t *optimizer);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TENSOR_DTYPE_H
+#define TENSOR_DTYPE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum tensor_dtype
+{
+    TENSOR_FLOAT32,
+    TENSOR_FLOAT16,
+    TENSOR_BFLOAT16,
+    TENSOR_INT8,
+    TENSOR_NUM_DTYPES
+} tensor_dtype_t;
+
+static inline size_t tensor_dtype_size(tensor_dtype_t dtype)
+{
+    switch (dtype)
+    {
+    case TENSOR_FLOAT16:
+    case TENSOR_BFLOAT16:
+        return sizeof(uint16_t);
+    case TENSOR_INT8:
+        return sizeof(int8_t);
+    default:
+        return sizeof(float);
+    }
+}
+
+#endif
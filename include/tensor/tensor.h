@@ -3,10 +3,24 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "utils/status/status.h"
+#include "tensor/dtype.h"
+#include "autograd/engine.h"
 
 #define MAX_DIMS 4
 
+typedef struct tensor_storage
+{
+    float* data;
+    float* grad;
+    size_t size;
+    tensor_dtype_t dtype;
+    bool borrowed;
+    bool aligned;
+    atomic_size_t refcount;
+} tensor_storage_t;
+
 typedef struct tensor
 {
     size_t ndim;
@@ -14,29 +28,66 @@ typedef struct tensor
     size_t shape[MAX_DIMS];
     size_t stride[MAX_DIMS];
     bool frozen;
+    tensor_dtype_t dtype;
+    size_t visit;
     float* data;
     float* grad;
+    size_t offset;
+    tensor_storage_t* storage;
     void* context;
     struct tensor* grad_a;
     struct tensor* grad_b;
     void (*backward)(struct tensor* self);
+    void (*release)(struct tensor* self);
 } tensor_t;
 
 tensor_status_code_t tensor_destroy(tensor_t* tensor);
 tensor_t* tensor_from_array(const float* array, const size_t* shape, size_t ndim);
 tensor_t* tensor_rand(const size_t* shape, size_t ndim, float limit);
+tensor_t* tensor_empty(const size_t* shape, size_t ndim);
+tensor_t* tensor_zeros_aligned(const size_t* shape, size_t ndim);
+tensor_t* tensor_empty_dtype(const size_t* shape, size_t ndim, tensor_dtype_t dtype);
+tensor_t* tensor_placeholder(const size_t* shape, size_t ndim);
+bool tensor_allocate(tensor_t* tensor);
+tensor_t* tensor_from_buffer(float* buffer, const size_t* shape, size_t ndim);
 tensor_t* tensor_zeros(const size_t* shape, size_t ndim);
 tensor_t* tensor_ones(const size_t* shape, size_t ndim);
 tensor_t* tensor_full(const size_t* shape, size_t ndim, float value);
 tensor_t* tensor_like(const tensor_t* a);
 tensor_t* tensor_clone(const tensor_t* a);
+tensor_t* tensor_view(const tensor_t* base, const size_t* shape, const size_t* stride, size_t ndim, size_t offset);
+bool tensor_move_into(tensor_t* tensor, const tensor_t* base, size_t offset);
+bool tensor_borrow(tensor_t* tensor, float* buffer);
+bool tensor_is_contiguous(const tensor_t* tensor);
+bool tensor_broadcast_shape(const tensor_t* a, const tensor_t* b, size_t* shape, size_t* ndim);
+bool tensor_broadcast_strides(const tensor_t* tensor, const size_t* shape, size_t ndim, size_t* stride);
+float* tensor_grad(tensor_t* tensor);
 
-static inline void tensor_backward(tensor_t* x)
+// Memory offset of the element at a row-major logical index, honouring the tensor's strides
+static inline size_t tensor_offset(const tensor_t* x, size_t index)
 {
-    if (x->backward)
+    size_t offset = 0;
+    for (size_t i = x->ndim; i > 0; --i)
     {
-        x->backward(x);
+        offset += (index % x->shape[i - 1]) * x->stride[i - 1];
+        index /= x->shape[i - 1];
     }
+    return offset;
+}
+
+// Views share one gradient buffer, so a view may see a buffer allocated through another view of the same storage
+static inline bool tensor_has_grad(tensor_t* x)
+{
+    if (x->grad == NULL && x->storage->grad)
+    {
+        x->grad = x->storage->grad + x->offset;
+    }
+    return x->grad != NULL;
+}
+
+static inline void tensor_backward(tensor_t* x)
+{
+    autograd_backward(x);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "utils/status/status.h"
+
+typedef struct memory_arena
+{
+    uint8_t* base;
+    size_t reserved;
+    size_t committed;
+    size_t chunk_size;
+    size_t used;
+    size_t peak;
+    size_t depth;
+} memory_arena_t;
+
+memory_arena_status_code_t arena_init(size_t chunk_size);
+memory_arena_status_code_t arena_destroy();
+void* arena_alloc(size_t size);
+void arena_reset();
+void arena_begin();
+void arena_end();
+bool arena_is_active();
+bool arena_owns(const void* ptr);
+size_t arena_get_used_memory();
+size_t arena_get_peak_memory();
+
+#endif
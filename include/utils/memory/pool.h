@@ -4,33 +4,95 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include "utils/status/status.h"
 
 #define KB 1024
 #define MB 1024 * 1024
 
+#define POOL_NUM_SMALL_CLASSES 32
+#define POOL_NUM_LARGE_BINS 55
+#define POOL_HISTOGRAM_BINS 24
+#define POOL_NUMA_NONE (-1)
+#define POOL_NUMA_LOCAL (-2)
+
+struct memory_pool;
+struct memory_heap;
+
+typedef enum pool_backing
+{
+    POOL_BACKING_MALLOC,
+    POOL_BACKING_MMAP,
+    POOL_BACKING_HUGETLB
+} pool_backing_t;
+
+typedef struct pool_options
+{
+    pool_backing_t backing;
+    int numa_node;
+} pool_options_t;
+
 typedef struct memory_block 
 {
     size_t size;
-    struct memory_block* next;
+    size_t prev_size;
+    struct memory_pool* pool;
+    const char* tag;
+    uintptr_t magic;
 } memory_block_t;
 
 typedef struct memory_pool 
 {
     uint8_t* pool;
     size_t size;
+    bool mapped;
     size_t used;
-    memory_block_t* free_list;
+    size_t top;
+    size_t top_prev_size;
+    uint64_t large_map;
+    memory_block_t* small_bins[POOL_NUM_SMALL_CLASSES];
+    memory_block_t* large_bins[POOL_NUM_LARGE_BINS];
+    struct memory_heap* heap;
     struct memory_pool* next;
 } memory_pool_t;
 
-extern memory_pool_t* global_memory_pool;
+typedef struct pool_stats
+{
+    size_t used;
+    size_t peak;
+    size_t capacity;
+    size_t num_arenas;
+    size_t free_blocks;
+    size_t largest_free_block;
+    float fragmentation;
+    size_t allocations;
+    size_t frees;
+    size_t live_allocations;
+    size_t histogram[POOL_HISTOGRAM_BINS];
+} pool_stats_t;
+
+typedef struct pool_tag_stats
+{
+    const char* tag;
+    size_t live_allocations;
+    size_t live_bytes;
+} pool_tag_stats_t;
+
+extern _Thread_local memory_pool_t* global_memory_pool;
 
 memory_pool_status_code_t pool_init(size_t initial_size);
+memory_pool_status_code_t pool_init_with_options(size_t initial_size, const pool_options_t* options);
 memory_pool_status_code_t pool_destroy();
 void* pool_alloc(size_t size);
 memory_pool_status_code_t pool_free(void* ptr);
 size_t pool_get_used_memory();
 size_t pool_get_free_memory();
+size_t pool_get_largest_free_block();
+float pool_get_fragmentation();
+memory_pool_status_code_t pool_get_stats(pool_stats_t* stats);
+void pool_reset_peak();
+const char* pool_set_tag(const char* tag);
+size_t pool_get_tag_stats(pool_tag_stats_t* stats, size_t capacity);
+void pool_print_stats();
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,85 @@
+#ifndef UTILS_PROFILER_H
+#define UTILS_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "utils/status/status.h"
+
+#define PROFILER_MAX_EVENTS (1 << 20)
+
+typedef struct profiler_counters
+{
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    size_t depth;
+} profiler_counters_t;
+
+typedef struct profiler_scope
+{
+    uint64_t start;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+} profiler_scope_t;
+
+typedef struct profiler_entry
+{
+    const char *op;
+    char *name;
+    size_t calls;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t flops;
+    uint64_t bytes;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+} profiler_entry_t;
+
+extern atomic_bool profiler_active;
+extern _Thread_local profiler_counters_t profiler_counters;
+
+void profiler_enable(void);
+void profiler_disable(void);
+void profiler_reset(void);
+void profiler_scope_open(profiler_scope_t *scope);
+void profiler_scope_close(const profiler_scope_t *scope, const char *op, const char *name, uint64_t flops, uint64_t bytes);
+const profiler_entry_t* profiler_get_entries(size_t *count);
+void profiler_print(void);
+profiler_status_code_t profiler_export_trace(const char *path);
+
+static inline bool profiler_is_enabled(void)
+{
+    return __builtin_expect(atomic_load_explicit(&profiler_active, memory_order_relaxed), 0);
+}
+
+// A disabled profiler costs one relaxed load and a predicted branch per scope, and nothing at all on close
+static inline profiler_scope_t profiler_begin(void)
+{
+    profiler_scope_t scope = {0, 0, 0};
+    if (profiler_is_enabled())
+    {
+        profiler_scope_open(&scope);
+    }
+    return scope;
+}
+
+static inline void profiler_end(const profiler_scope_t *scope, const char *op, const char *name, uint64_t flops, uint64_t bytes)
+{
+    if (__builtin_expect(scope->start != 0, 0))
+    {
+        profiler_scope_close(scope, op, name, flops, bytes);
+    }
+}
+
+static inline void profiler_count_allocation(size_t size)
+{
+    if (profiler_is_enabled())
+    {
+        profiler_counters.allocations++;
+        profiler_counters.allocated_bytes += size;
+    }
+}
+
+#endif
@@ -10,9 +10,19 @@ typedef const enum memory_pool_status_code
     POOL_DESTROY_SUCCESS,
     POOL_DESTROY_FAILURE,
     POOL_FREE_SUCCESS,
-    POOL_FREE_FAILURE
+    POOL_FREE_FAILURE,
+    POOL_STATS_SUCCESS,
+    POOL_STATS_FAILURE
 } memory_pool_status_code_t;
 
+typedef const enum memory_arena_status_code
+{
+    ARENA_CREATION_SUCCESS,
+    ARENA_CREATION_FAILURE,
+    ARENA_DESTROY_SUCCESS,
+    ARENA_DESTROY_FAILURE
+} memory_arena_status_code_t;
+
 typedef const enum tensor_status_code
 {
     TENSOR_DESTROY_SUCCESS,
@@ -28,7 +38,61 @@ typedef const enum parameters_status_code
 typedef const enum layer_status_code
 {
     LAYER_DESTROY_SUCCESS,
-    LAYER_DESTROY_FAILURE
+    LAYER_DESTROY_FAILURE,
+    LAYER_QUANTIZE_SUCCESS,
+    LAYER_QUANTIZE_FAILURE
 } layer_status_code_t;
 
+typedef const enum memory_plan_status_code
+{
+    MEMORY_PLAN_DESTROY_SUCCESS,
+    MEMORY_PLAN_DESTROY_FAILURE
+} memory_plan_status_code_t;
+
+typedef const enum sequential_status_code
+{
+    SEQUENTIAL_ADD_SUCCESS,
+    SEQUENTIAL_ADD_FAILURE,
+    SEQUENTIAL_FLATTEN_SUCCESS,
+    SEQUENTIAL_FLATTEN_FAILURE,
+    SEQUENTIAL_COMPILE_SUCCESS,
+    SEQUENTIAL_COMPILE_FAILURE,
+    SEQUENTIAL_DESTROY_SUCCESS,
+    SEQUENTIAL_DESTROY_FAILURE
+} sequential_status_code_t;
+
+typedef const enum optimizer_status_code
+{
+    OPTIMIZER_ADD_SUCCESS,
+    OPTIMIZER_ADD_FAILURE,
+    OPTIMIZER_STEP_SUCCESS,
+    OPTIMIZER_STEP_FAILURE,
+    OPTIMIZER_DESTROY_SUCCESS,
+    OPTIMIZER_DESTROY_FAILURE
+} optimizer_status_code_t;
+
+typedef const enum grad_accumulator_status_code
+{
+    GRAD_ACCUMULATOR_ADD_SUCCESS,
+    GRAD_ACCUMULATOR_ADD_FAILURE,
+    GRAD_ACCUMULATOR_DESTROY_SUCCESS,
+    GRAD_ACCUMULATOR_DESTROY_FAILURE
+} grad_accumulator_status_code_t;
+
+typedef const enum checkpoint_status_code
+{
+    CHECKPOINT_SAVE_SUCCESS,
+    CHECKPOINT_SAVE_FAILURE,
+    CHECKPOINT_LOAD_SUCCESS,
+    CHECKPOINT_LOAD_FAILURE,
+    CHECKPOINT_CLOSE_SUCCESS,
+    CHECKPOINT_CLOSE_FAILURE
+} checkpoint_status_code_t;
+
+typedef const enum profiler_status_code
+{
+    PROFILER_EXPORT_SUCCESS,
+    PROFILER_EXPORT_FAILURE
+} profiler_status_code_t;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef UTILS_THREAD_PARALLEL_H
+#define UTILS_THREAD_PARALLEL_H
+
+#include <stddef.h>
+
+typedef void (*parallel_fn_t)(void* ctx, size_t begin, size_t end);
+
+void cortex_parallel_for(size_t range, size_t grain, parallel_fn_t fn, void* ctx);
+void cortex_set_num_threads(size_t num_threads);
+size_t cortex_get_num_threads(void);
+
+#endif
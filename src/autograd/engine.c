@@ -0,0 +1,137 @@
+#include <string.h>
+#include <stdatomic.h>
+#include "tensor/tensor.h"
+#include "autograd/mode.h"
+#include "autograd/engine.h"
+#include "utils/memory/pool.h"
+#include "utils/profiler/profiler.h"
+
+#define ENGINE_INITIAL_CAPACITY 64
+
+typedef struct engine_frame
+{
+    tensor_t* node;
+    size_t next_parent;
+} engine_frame_t;
+
+typedef struct engine_buffer
+{
+    void* items;
+    size_t count;
+    size_t capacity;
+    size_t item_size;
+} engine_buffer_t;
+
+static atomic_size_t engine_epoch = 0;
+
+static bool engine_buffer_reserve(engine_buffer_t* buffer)
+{
+    if (buffer->count < buffer->capacity)
+    {
+        return true;
+    }
+
+    size_t capacity = buffer->capacity ? buffer->capacity * 2 : ENGINE_INITIAL_CAPACITY;
+    void* items = pool_alloc(capacity * buffer->item_size);
+    if (items == NULL)
+    {
+        return false;
+    }
+    if (buffer->items)
+    {
+        memcpy(items, buffer->items, buffer->count * buffer->item_size);
+        pool_free(buffer->items);
+    }
+    buffer->items = items;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static tensor_t* engine_parent(const tensor_t* node, size_t index)
+{
+    if (node->backward == NULL)
+    {
+        return NULL;
+    }
+    return (index == 0) ? node->grad_a : (index == 1) ? node->grad_b : NULL;
+}
+
+// Depth-first post-order over the graph: every node lands in the order after all of its parents
+static bool engine_sort(tensor_t* root, size_t epoch, engine_buffer_t* order)
+{
+    engine_buffer_t stack = {NULL, 0, 0, sizeof(engine_frame_t)};
+    bool ok = engine_buffer_reserve(&stack);
+
+    if (ok)
+    {
+        root->visit = epoch;
+        ((engine_frame_t*)stack.items)[stack.count++] = (engine_frame_t){root, 0};
+    }
+
+    while (ok && stack.count > 0)
+    {
+        engine_frame_t* frame = &((engine_frame_t*)stack.items)[stack.count - 1];
+        if (frame->next_parent < 2)
+        {
+            tensor_t* parent = engine_parent(frame->node, frame->next_parent++);
+            if (parent == NULL || parent->visit == epoch)
+            {
+                continue;
+            }
+            parent->visit = epoch;
+            ok = engine_buffer_reserve(&stack);
+            if (ok)
+            {
+                ((engine_frame_t*)stack.items)[stack.count++] = (engine_frame_t){parent, 0};
+            }
+            continue;
+        }
+
+        tensor_t* node = frame->node;
+        stack.count--;
+        ok = engine_buffer_reserve(order);
+        if (ok)
+        {
+            ((tensor_t**)order->items)[order->count++] = node;
+        }
+    }
+
+    if (stack.items)
+    {
+        pool_free(stack.items);
+    }
+    return ok;
+}
+
+void autograd_backward(tensor_t* root)
+{
+    if (root == NULL || root->backward == NULL || !tensor_has_grad(root) || !cortex_is_grad_enabled())
+    {
+        return;
+    }
+
+    profiler_scope_t scope = profiler_begin();
+    size_t epoch = atomic_fetch_add(&engine_epoch, 1) + 1;
+    engine_buffer_t order = {NULL, 0, 0, sizeof(tensor_t*)};
+
+    if (engine_sort(root, epoch, &order))
+    {
+        // Reverse topological order: a node runs once, after every consumer has added into its gradient.
+        // Leaves stay in the order so those reached only through a view pick up the shared gradient buffer
+        tensor_t** nodes = (tensor_t**)order.items;
+        for (size_t i = order.count; i > 0; --i)
+        {
+            tensor_t* node = nodes[i - 1];
+            if (tensor_has_grad(node) && node->backward)
+            {
+                node->backward(node);
+            }
+        }
+    }
+
+    if (order.items)
+    {
+        pool_free(order.items);
+    }
+    profiler_end(&scope, "backward", NULL, 0, 0);
+}
@@ -0,0 +1,22 @@
+#include <stddef.h>
+#include "autograd/mode.h"
+
+static _Thread_local size_t no_grad_depth = 0;
+
+void cortex_no_grad_begin()
+{
+    no_grad_depth++;
+}
+
+void cortex_no_grad_end()
+{
+    if (no_grad_depth > 0)
+    {
+        no_grad_depth--;
+    }
+}
+
+bool cortex_is_grad_enabled()
+{
+    return no_grad_depth == 0;
+}
@@ -0,0 +1,356 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "utils/memory/pool.h"
+#include "nn/checkpoint/checkpoint.h"
+
+static uint64_t checkpoint_align(uint64_t offset)
+{
+    return (offset + CHECKPOINT_ALIGNMENT - 1) / CHECKPOINT_ALIGNMENT * CHECKPOINT_ALIGNMENT;
+}
+
+// Entries are keyed "<layer>.<parameter>", unnamed layers and parameters fall back to their index
+static bool checkpoint_entry_name(char *name, const layer_t *layer, size_t layer_index, const parameters_t *params, size_t param_index)
+{
+    char layer_name[32];
+    char param_name[32];
+    const char *layer_part = layer->name;
+    const char *param_part = params->names ? params->names[param_index] : NULL;
+    if (layer_part == NULL)
+    {
+        snprintf(layer_name, sizeof(layer_name), "layer%zu", layer_index);
+        layer_part = layer_name;
+    }
+    if (param_part == NULL)
+    {
+        snprintf(param_name, sizeof(param_name), "%zu", param_index);
+        param_part = param_name;
+    }
+    int length = snprintf(name, CHECKPOINT_NAME_SIZE, "%s.%s", layer_part, param_part);
+    return length > 0 && length < CHECKPOINT_NAME_SIZE;
+}
+
+static size_t checkpoint_count_params(layer_t **layers, size_t num_layers)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < num_layers; ++i)
+    {
+        if (layers[i] && layers[i]->params)
+        {
+            count += layers[i]->params->num_params;
+        }
+    }
+    return count;
+}
+
+static bool checkpoint_write_padding(FILE *file, uint64_t from, uint64_t to)
+{
+    static const char zeros[CHECKPOINT_ALIGNMENT] = {0};
+    return to - from <= CHECKPOINT_ALIGNMENT && fwrite(zeros, 1, to - from, file) == to - from;
+}
+
+static bool checkpoint_write(FILE *file, const checkpoint_header_t *header, const checkpoint_entry_t *entries, tensor_t **tensors)
+{
+    if (fwrite(header, sizeof(checkpoint_header_t), 1, file) != 1)
+    {
+        return false;
+    }
+    if (header->num_entries > 0 && fwrite(entries, sizeof(checkpoint_entry_t), header->num_entries, file) != header->num_entries)
+    {
+        return false;
+    }
+
+    uint64_t position = sizeof(checkpoint_header_t) + header->num_entries * sizeof(checkpoint_entry_t);
+    for (size_t i = 0; i < header->num_entries; ++i)
+    {
+        if (!checkpoint_write_padding(file, position, entries[i].offset))
+        {
+            return false;
+        }
+        if (fwrite(tensors[i]->data, 1, entries[i].bytes, file) != entries[i].bytes)
+        {
+            return false;
+        }
+        position = entries[i].offset + entries[i].bytes;
+    }
+    return checkpoint_write_padding(file, position, header->file_size);
+}
+
+// The file is written next to its destination and renamed into place, so readers never map a half-written checkpoint
+checkpoint_status_code_t checkpoint_save(const char *path, layer_t **layers, size_t num_layers)
+{
+    if (path == NULL || layers == NULL)
+    {
+        return CHECKPOINT_SAVE_FAILURE;
+    }
+
+    size_t count = checkpoint_count_params(layers, num_layers);
+    checkpoint_entry_t *entries = (checkpoint_entry_t *)pool_alloc((count ? count : 1) * sizeof(checkpoint_entry_t));
+    tensor_t **tensors = (tensor_t **)pool_alloc((count ? count : 1) * sizeof(tensor_t *));
+    char *temporary = (char *)pool_alloc(strlen(path) + 5);
+    if (entries == NULL || tensors == NULL || temporary == NULL)
+    {
+        void *buffers[] = {entries, tensors, temporary};
+        for (size_t i = 0; i < 3; ++i)
+        {
+            if (buffers[i])
+            {
+                pool_free(buffers[i]);
+            }
+        }
+        return CHECKPOINT_SAVE_FAILURE;
+    }
+    memset(entries, 0, (count ? count : 1) * sizeof(checkpoint_entry_t));
+
+    checkpoint_header_t header = {CHECKPOINT_MAGIC, CHECKPOINT_VERSION, count, 0, 0};
+    header.data_offset = checkpoint_align(sizeof(checkpoint_header_t) + count * sizeof(checkpoint_entry_t));
+
+    bool valid = true;
+    uint64_t offset = header.data_offset;
+    size_t index = 0;
+    for (size_t i = 0; valid && i < num_layers; ++i)
+    {
+        parameters_t *params = layers[i] ? layers[i]->params : NULL;
+        for (size_t j = 0; params && valid && j < params->num_params; ++j)
+        {
+            tensor_t *param = params->params_array[j];
+            checkpoint_entry_t *entry = &entries[index];
+            valid = param->data && tensor_is_contiguous(param) && checkpoint_entry_name(entry->name, layers[i], i, params, j);
+            entry->dtype = (uint32_t)param->dtype;
+            entry->ndim = (uint32_t)param->ndim;
+            for (size_t d = 0; d < param->ndim; ++d)
+            {
+                entry->shape[d] = param->shape[d];
+            }
+            entry->offset = offset;
+            entry->bytes = param->size * tensor_dtype_size(param->dtype);
+            offset = checkpoint_align(offset + entry->bytes);
+            tensors[index++] = param;
+        }
+    }
+    header.file_size = offset;
+
+    snprintf(temporary, strlen(path) + 5, "%s.tmp", path);
+    FILE *file = valid ? fopen(temporary, "wb") : NULL;
+    valid = file != NULL;
+    if (file)
+    {
+        valid = checkpoint_write(file, &header, entries, tensors);
+        valid = (fclose(file) == 0) && valid;
+        valid = valid && rename(temporary, path) == 0;
+        if (!valid)
+        {
+            remove(temporary);
+        }
+    }
+
+    pool_free(temporary);
+    pool_free(tensors);
+    pool_free(entries);
+
+    return valid ? CHECKPOINT_SAVE_SUCCESS : CHECKPOINT_SAVE_FAILURE;
+}
+
+static bool checkpoint_validate(const checkpoint_header_t *header, const checkpoint_entry_t *entries, size_t map_size)
+{
+    if (header->magic != CHECKPOINT_MAGIC || header->version != CHECKPOINT_VERSION || header->file_size != map_size)
+    {
+        return false;
+    }
+    if (header->num_entries > (map_size - sizeof(checkpoint_header_t)) / sizeof(checkpoint_entry_t))
+    {
+        return false;
+    }
+    if (header->data_offset < sizeof(checkpoint_header_t) + header->num_entries * sizeof(checkpoint_entry_t) || header->data_offset > map_size)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < header->num_entries; ++i)
+    {
+        const checkpoint_entry_t *entry = &entries[i];
+        if (memchr(entry->name, '\0', CHECKPOINT_NAME_SIZE) == NULL || entry->dtype >= TENSOR_NUM_DTYPES)
+        {
+            return false;
+        }
+        if (entry->ndim == 0 || entry->ndim > MAX_DIMS || entry->offset % CHECKPOINT_ALIGNMENT != 0)
+        {
+            return false;
+        }
+        if (entry->offset < header->data_offset || entry->offset > map_size || entry->bytes > map_size - entry->offset)
+        {
+            return false;
+        }
+        uint64_t size = 1;
+        for (size_t d = 0; d < entry->ndim; ++d)
+        {
+            if (entry->shape[d] == 0 || size > entry->bytes / entry->shape[d])
+            {
+                return false;
+            }
+            size *= entry->shape[d];
+        }
+        if (size * tensor_dtype_size((tensor_dtype_t)entry->dtype) != entry->bytes)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Pages are mapped copy-on-write: every process reads the same page cache, and a stray write stays private
+checkpoint_t* checkpoint_open(const char *path)
+{
+    if (path == NULL)
+    {
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(checkpoint_header_t))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    size_t map_size = (size_t)st.st_size;
+    void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    const checkpoint_header_t *header = (const checkpoint_header_t *)map;
+    const checkpoint_entry_t *entries = (const checkpoint_entry_t *)(header + 1);
+    checkpoint_t *checkpoint = checkpoint_validate(header, entries, map_size) ? (checkpoint_t *)pool_alloc(sizeof(checkpoint_t)) : NULL;
+    if (checkpoint == NULL)
+    {
+        munmap(map, map_size);
+        return NULL;
+    }
+
+    checkpoint->map = map;
+    checkpoint->map_size = map_size;
+    checkpoint->header = header;
+    checkpoint->entries = entries;
+
+    return checkpoint;
+}
+
+static const checkpoint_entry_t *checkpoint_find(const checkpoint_t *checkpoint, const char *name, const tensor_t *param)
+{
+    for (size_t i = 0; i < checkpoint->header->num_entries; ++i)
+    {
+        const checkpoint_entry_t *entry = &checkpoint->entries[i];
+        if (strcmp(entry->name, name) != 0)
+        {
+            continue;
+        }
+        if (entry->ndim != param->ndim || entry->dtype != param->dtype)
+        {
+            return NULL;
+        }
+        for (size_t d = 0; d < param->ndim; ++d)
+        {
+            if (entry->shape[d] != param->shape[d])
+            {
+                return NULL;
+            }
+        }
+        return entry;
+    }
+    return NULL;
+}
+
+// Every parameter is matched before any is touched, so a mismatched checkpoint leaves the layers as they were
+checkpoint_status_code_t checkpoint_load(checkpoint_t *checkpoint, layer_t **layers, size_t num_layers, bool zero_copy)
+{
+    if (checkpoint == NULL || layers == NULL)
+    {
+        return CHECKPOINT_LOAD_FAILURE;
+    }
+
+    size_t count = checkpoint_count_params(layers, num_layers);
+    if (count == 0)
+    {
+        return CHECKPOINT_LOAD_SUCCESS;
+    }
+    const checkpoint_entry_t **matches = (const checkpoint_entry_t **)pool_alloc(count * sizeof(checkpoint_entry_t *));
+    if (matches == NULL)
+    {
+        return CHECKPOINT_LOAD_FAILURE;
+    }
+
+    bool valid = true;
+    size_t index = 0;
+    for (size_t i = 0; valid && i < num_layers; ++i)
+    {
+        parameters_t *params = layers[i] ? layers[i]->params : NULL;
+        for (size_t j = 0; params && valid && j < params->num_params; ++j)
+        {
+            char name[CHECKPOINT_NAME_SIZE];
+            tensor_t *param = params->params_array[j];
+            valid = checkpoint_entry_name(name, layers[i], i, params, j) && tensor_is_contiguous(param);
+            matches[index] = valid ? checkpoint_find(checkpoint, name, param) : NULL;
+            valid = valid && matches[index++] != NULL;
+        }
+    }
+
+    index = 0;
+    for (size_t i = 0; valid && i < num_layers; ++i)
+    {
+        parameters_t *params = layers[i] ? layers[i]->params : NULL;
+        for (size_t j = 0; params && valid && j < params->num_params; ++j)
+        {
+            tensor_t *param = params->params_array[j];
+            const checkpoint_entry_t *entry = matches[index++];
+            float *data = (float *)((char *)checkpoint->map + entry->offset);
+            if (zero_copy)
+            {
+                valid = tensor_borrow(param, data);
+                param->frozen = valid;
+            }
+            else
+            {
+                // Placeholder parameters get their storage here, uninitialized since the copy fills it
+                valid = param->storage || tensor_allocate(param);
+                if (valid)
+                {
+                    memcpy(param->data, data, entry->bytes);
+                }
+            }
+        }
+    }
+
+    pool_free(matches);
+
+    return valid ? CHECKPOINT_LOAD_SUCCESS : CHECKPOINT_LOAD_FAILURE;
+}
+
+// Tensors loaded without a copy point into the mapping, so their layers have to be destroyed first
+checkpoint_status_code_t checkpoint_close(checkpoint_t *checkpoint)
+{
+    if (checkpoint == NULL)
+    {
+        return CHECKPOINT_CLOSE_FAILURE;
+    }
+    if (munmap(checkpoint->map, checkpoint->map_size) != 0)
+    {
+        return CHECKPOINT_CLOSE_FAILURE;
+    }
+    if (pool_free(checkpoint) == POOL_FREE_FAILURE)
+    {
+        return CHECKPOINT_CLOSE_FAILURE;
+    }
+
+    return CHECKPOINT_CLOSE_SUCCESS;
+}
@@ -2,9 +2,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include "utils/memory/pool.h"
+#include "utils/memory/arena.h"
+#include "autograd/mode.h"
+#include "ops/kernels/gemm.h"
+#include "ops/kernels/reduce.h"
+#include "ops/kernels/quantized.h"
+#include "utils/profiler/profiler.h"
 #include "nn/layers/dense.h"
 
-parameters_t* dense_parameters_create(size_t input_dim, size_t output_dim)
+static const char *const dense_parameter_names[] = {"weights", "bias", "scales"};
+
+// Placeholder parameters are headers only, a checkpoint gives them their elements without an initialization to overwrite
+static parameters_t* dense_parameters_build(size_t input_dim, size_t output_dim, bool placeholder)
 {
     dense_parameters_t *params = (dense_parameters_t *)pool_alloc(sizeof(dense_parameters_t));
     if (params == NULL)
@@ -15,11 +24,13 @@ parameters_t* dense_parameters_create(size_t input_dim, size_t output_dim)
     params->base.freeze_params = dense_parameters_freeze;
     params->base.free = dense_parameters_destroy;
     params->base.num_params = 2;
+    params->base.names = dense_parameter_names;
+    params->scales = NULL;
 
     float limit = sqrtf(1.0f / input_dim);
 
     size_t weights_shape[2] = {output_dim, input_dim};
-    params->weights = tensor_rand(weights_shape, 2, limit);
+    params->weights = placeholder ? tensor_placeholder(weights_shape, 2) : tensor_rand(weights_shape, 2, limit);
     if (params->weights == NULL)
     {
         pool_free(params);
@@ -27,7 +38,7 @@ parameters_t* dense_parameters_create(size_t input_dim, size_t output_dim)
     }
 
     size_t bias_shape[1] = {output_dim};
-    params->bias = tensor_rand(bias_shape, 1, limit);
+    params->bias = placeholder ? tensor_placeholder(bias_shape, 1) : tensor_rand(bias_shape, 1, limit);
     if (params->bias == NULL)
     {
         tensor_destroy(params->weights);
@@ -49,11 +60,20 @@ parameters_t* dense_parameters_create(size_t input_dim, size_t output_dim)
     return (parameters_t *)params;
 }
 
+parameters_t* dense_parameters_create(size_t input_dim, size_t output_dim)
+{
+    return dense_parameters_build(input_dim, output_dim, false);
+}
+
 void dense_parameters_freeze(parameters_t *self)
 {
     dense_parameters_t *params = (dense_parameters_t *)self;
     params->weights->frozen = true;
     params->bias->frozen = true;
+    if (params->scales)
+    {
+        params->scales->frozen = true;
+    }
 }
 
 parameters_status_code_t dense_parameters_destroy(parameters_t *self)
@@ -79,6 +99,13 @@ parameters_status_code_t dense_parameters_destroy(parameters_t *self)
             return PARAMETERS_DESTROY_FAILURE;
         }
     }
+    if (params->scales)
+    {
+        if (tensor_destroy(params->scales) == TENSOR_DESTROY_FAILURE)
+        {
+            return PARAMETERS_DESTROY_FAILURE;
+        }
+    }
     if (pool_free(params) == POOL_FREE_FAILURE)
     {
         return PARAMETERS_DESTROY_FAILURE;
@@ -88,6 +115,11 @@ parameters_status_code_t dense_parameters_destroy(parameters_t *self)
 }
 
 layer_t* dense_create(const char *name, size_t input_dim, size_t output_dim)
+{
+    return dense_create_with_activation(name, input_dim, output_dim, ACTIVATION_NONE);
+}
+
+static layer_t* dense_build(const char *name, size_t input_dim, size_t output_dim, activation_t activation, bool placeholder)
 {
     dense_layer_t *dense = (dense_layer_t *)pool_alloc(sizeof(dense_layer_t));
     if (dense == NULL)
@@ -97,6 +129,7 @@ layer_t* dense_create(const char *name, size_t input_dim, size_t output_dim)
 
     dense->input_dim = input_dim;
     dense->output_dim = output_dim;
+    dense->activation = activation;
 
     dense->base.name = NULL;
     if (name)
@@ -111,10 +144,12 @@ layer_t* dense_create(const char *name, size_t input_dim, size_t output_dim)
         memcpy(dense->base.name, name, name_length);
     }
     dense->base.is_training = false;
+    dense->base.input = NULL;
+    dense->base.output = NULL;
     dense->base.forward = dense_forward;
     dense->base.free = dense_destroy;
 
-    dense->base.params = dense_parameters_create(input_dim, output_dim);
+    dense->base.params = dense_parameters_build(input_dim, output_dim, placeholder);
     if (dense->base.params == NULL)
     {
         if (dense->base.name)
@@ -128,84 +163,322 @@ layer_t* dense_create(const char *name, size_t input_dim, size_t output_dim)
     return (layer_t *)dense;
 }
 
-tensor_t* dense_forward(layer_t *self, const tensor_t *input)
+layer_t* dense_create_with_activation(const char *name, size_t input_dim, size_t output_dim, activation_t activation)
 {
-    if (self == NULL || input == NULL)
+    return dense_build(name, input_dim, output_dim, activation, false);
+}
+
+// The layer refuses to run until checkpoint_load has filled its parameters
+layer_t* dense_create_placeholder(const char *name, size_t input_dim, size_t output_dim, activation_t activation)
+{
+    return dense_build(name, input_dim, output_dim, activation, true);
+}
+
+// Row-strided views go to the GEMM through their leading dimension, transposed views through the transpose flag
+static bool dense_input_layout(const tensor_t *input, bool *trans, size_t *ld)
+{
+    if (input->stride[1] == 1 && input->stride[0] >= input->shape[1])
     {
-        return NULL;
+        *trans = false;
+        *ld = input->stride[0];
+        return true;
+    }
+    if (input->stride[0] == 1 && input->stride[1] >= input->shape[0])
+    {
+        *trans = true;
+        *ld = input->stride[1];
+        return true;
+    }
+    return false;
+}
+
+static bool dense_check_input(const dense_layer_t *dense, const tensor_t *input, bool *trans, size_t *ld)
+{
+    const dense_parameters_t *params = (const dense_parameters_t *)dense->base.params;
+    if (params->weights->data == NULL || params->bias->data == NULL)
+    {
+        return false;
     }
+    if (input->ndim != 2 || input->shape[1] != dense->input_dim)
+    {
+        return false;
+    }
+    return dense_input_layout(input, trans, ld);
+}
 
+// Reduced-precision weights serve inference only: the output is never recorded, and an input that still expects a gradient is refused
+static tensor_t* dense_compute_reduced(layer_t *self, const tensor_t *input, bool input_trans, size_t input_ld, tensor_t *output)
+{
     dense_layer_t *dense = (dense_layer_t *)self;
     dense_parameters_t *params = (dense_parameters_t *)self->params;
 
-    if (input->ndim != 2)
+    if (input_trans || (cortex_is_grad_enabled() && input->backward))
     {
         return NULL;
     }
-    if (input->shape[1] != dense->input_dim)
+
+    sgemm_epilogue_t epilogue = {params->bias->data, dense->activation, NULL};
+    const float *scales = params->scales ? params->scales->data : NULL;
+    cortex_sgemm_reduced(params->weights->dtype, input->shape[0], dense->output_dim, dense->input_dim, input->data, input_ld, params->weights->data, scales, output->data, dense->output_dim, &epilogue);
+
+    self->input = NULL;
+    output->backward = NULL;
+    output->grad_a = NULL;
+    return output;
+}
+
+// Arena memory may have been reset and handed out again since, so a context or buffer that came from one is never looked into
+static void dense_context_release(tensor_t *output)
+{
+    dense_context_t *context = (dense_context_t *)output->context;
+    output->context = NULL;
+    output->release = NULL;
+    if (context == NULL || arena_owns(context))
+    {
+        return;
+    }
+    if (context->preactivation)
     {
-        return NULL;
+        tensor_destroy(context->preactivation);
+    }
+    pool_free(context);
+}
+
+// Every recorded output owns the context its backward reads, so a layer applied twice keeps one pre-activation per call
+static dense_context_t* dense_context_get(layer_t *self, tensor_t *output)
+{
+    dense_context_t *context = (dense_context_t *)output->context;
+    if (output->release != dense_context_release || arena_owns(context))
+    {
+        if (output->release)
+        {
+            output->release(output);
+        }
+        context = (dense_context_t *)(arena_is_active() ? arena_alloc(sizeof(dense_context_t)) : pool_alloc(sizeof(dense_context_t)));
+        if (context == NULL)
+        {
+            return NULL;
+        }
+        context->preactivation = NULL;
+        output->context = context;
+        output->release = dense_context_release;
     }
+    context->layer = self;
+    return context;
+}
+
+// GELU is the only activation whose derivative cannot be recovered from its output, an output recorded into again keeps its buffer
+static float* dense_context_preactivation(dense_context_t *context, size_t batch_size, size_t output_dim)
+{
+    tensor_t *preactivation = context->preactivation;
+    if (preactivation && !arena_owns(preactivation) && preactivation->shape[0] == batch_size && preactivation->shape[1] == output_dim)
+    {
+        return preactivation->data;
+    }
+    if (preactivation)
+    {
+        tensor_destroy(preactivation);
+    }
+
+    size_t shape[2] = {batch_size, output_dim};
+    context->preactivation = tensor_empty(shape, 2);
+    return context->preactivation ? context->preactivation->data : NULL;
+}
+
+// Sets up an output's context ahead of its first recorded call; the output takes ownership of a given pre-activation buffer
+bool dense_attach_preactivation(layer_t *self, tensor_t *output, tensor_t *preactivation)
+{
+    if (self == NULL || output == NULL)
+    {
+        return false;
+    }
+
+    dense_context_t *context = dense_context_get(self, output);
+    if (context == NULL)
+    {
+        return false;
+    }
+    if (preactivation && context->preactivation)
+    {
+        tensor_destroy(context->preactivation);
+    }
+    if (preactivation)
+    {
+        context->preactivation = preactivation;
+    }
+    return true;
+}
+
+static tensor_t* dense_compute_float(layer_t *self, const tensor_t *input, bool input_trans, size_t input_ld, tensor_t *output)
+{
+    dense_layer_t *dense = (dense_layer_t *)self;
+    dense_parameters_t *params = (dense_parameters_t *)self->params;
 
     size_t batch_size = input->shape[0];
     size_t output_dim = dense->output_dim;
     size_t input_dim = dense->input_dim;
+    bool record = cortex_is_grad_enabled();
 
-    size_t output_shape[2] = {batch_size, output_dim};
-    tensor_t *output = tensor_zeros(output_shape, 2);
-    if (output == NULL)
+    float *preactivation = NULL;
+    dense_context_t *context = record ? dense_context_get(self, output) : NULL;
+    if (record && context == NULL)
     {
         return NULL;
     }
-
-    const float *input_data = input->data;
-    const float *weights_data = params->weights->data;
-    const float *bias_data = params->bias->data;
-    float *output_data = output->data;
-
-    for (size_t i = 0; i < batch_size; ++i)
+    if (record && dense->activation == ACTIVATION_GELU)
     {
-        for (size_t j = 0; j < output_dim; ++j)
+        preactivation = dense_context_preactivation(context, batch_size, output_dim);
+        if (preactivation == NULL)
         {
-            float sum = bias_data[j];
-            const float *input_row = &input_data[i * input_dim];
-            const float *weight_row = &weights_data[j * input_dim];
-
-            for (size_t k = 0; k < input_dim; ++k)
-            {
-                sum += input_row[k] * weight_row[k];
-            }
-            output_data[i * output_dim + j] = sum;
+            return NULL;
         }
     }
 
-    self->output = output;
+    // Bias and activation are applied by the GEMM on each output tile as soon as it is complete
+    sgemm_epilogue_t epilogue = {params->bias->data, dense->activation, preactivation};
+    cortex_sgemm_fused(input_trans, true, batch_size, output_dim, input_dim, 1.0f, input->data, input_ld, params->weights->data, input_dim, 0.0f, output->data, output_dim, &epilogue);
+
+    if (!record)
+    {
+        self->input = NULL;
+        output->backward = NULL;
+        output->grad_a = NULL;
+        return output;
+    }
     self->input = (tensor_t *)input;
 
+    // A reused output must not carry the gradient of a previous step into this one
+    if (tensor_has_grad(output))
+    {
+        memset(output->grad, 0, output->size * sizeof(float));
+    }
     output->backward = dense_backward;
-    output->context = self;
+    output->grad_a = (tensor_t *)input;
 
     return output;
 }
 
-void dense_backward(tensor_t *output)
+// Every forward path funnels through here, so this is the one place a dense call is timed
+static tensor_t* dense_compute(layer_t *self, const tensor_t *input, bool input_trans, size_t input_ld, tensor_t *output)
 {
-    if (output == NULL || output->grad == NULL)
+    dense_layer_t *dense = (dense_layer_t *)self;
+    dense_parameters_t *params = (dense_parameters_t *)self->params;
+
+    profiler_scope_t scope = profiler_begin();
+    tensor_t *result = (params->weights->dtype != TENSOR_FLOAT32) ? dense_compute_reduced(self, input, input_trans, input_ld, output) : dense_compute_float(self, input, input_trans, input_ld, output);
+
+    uint64_t batch_size = input->shape[0];
+    uint64_t weights_bytes = params->weights->size * tensor_dtype_size(params->weights->dtype);
+    uint64_t bytes = (batch_size * (dense->input_dim + dense->output_dim) + dense->output_dim) * sizeof(float) + weights_bytes;
+    profiler_end(&scope, "dense_forward", self->name, 2 * batch_size * dense->input_dim * dense->output_dim, bytes);
+
+    return result;
+}
+
+tensor_t* dense_forward(layer_t *self, const tensor_t *input)
+{
+    if (self == NULL || input == NULL)
     {
-        return;
+        return NULL;
+    }
+
+    dense_layer_t *dense = (dense_layer_t *)self;
+
+    bool input_trans;
+    size_t input_ld;
+    if (!dense_check_input(dense, input, &input_trans, &input_ld))
+    {
+        return NULL;
     }
 
-    layer_t *layer = (layer_t *)output->context;
-    if (layer == NULL)
+    size_t batch_size = input->shape[0];
+    size_t output_dim = dense->output_dim;
+    tensor_t *output = NULL;
+
+    // Without autograd nothing can hold on to the previous output, so its buffer is reused across calls
+    tensor_t *previous = self->output;
+    if (!cortex_is_grad_enabled() && previous && previous->backward == NULL && !arena_owns(previous))
     {
-        return;
+        if (previous->shape[0] == batch_size && previous->shape[1] == output_dim)
+        {
+            output = previous;
+        }
+        else
+        {
+            tensor_destroy(previous);
+            self->output = NULL;
+        }
+    }
+    if (output == NULL)
+    {
+        size_t output_shape[2] = {batch_size, output_dim};
+        output = tensor_empty(output_shape, 2);
+    }
+    if (output == NULL)
+    {
+        return NULL;
+    }
+
+    if (dense_compute(self, input, input_trans, input_ld, output) == NULL)
+    {
+        if (output != previous)
+        {
+            tensor_destroy(output);
+        }
+        return NULL;
+    }
+
+    self->output = output;
+    return output;
+}
+
+// Compiled models validate shapes once up front, so their steady-state calls skip every check
+tensor_t* dense_forward_into(layer_t *self, const tensor_t *input, tensor_t *output)
+{
+    bool input_trans = false;
+    size_t input_ld = input->stride[0];
+    dense_input_layout(input, &input_trans, &input_ld);
+    return dense_compute(self, input, input_trans, input_ld, output);
+}
+
+// The output belongs to the caller and is left out of self->output, so it survives the layer
+tensor_t* dense_forward_out(layer_t *self, const tensor_t *input, tensor_t *output)
+{
+    if (self == NULL || input == NULL || output == NULL)
+    {
+        return NULL;
+    }
+
+    dense_layer_t *dense = (dense_layer_t *)self;
+
+    bool input_trans;
+    size_t input_ld;
+    if (!dense_check_input(dense, input, &input_trans, &input_ld))
+    {
+        return NULL;
+    }
+    if (output->ndim != 2 || output->shape[0] != input->shape[0] || output->shape[1] != dense->output_dim || !tensor_is_contiguous(output))
+    {
+        return NULL;
+    }
+    if (cortex_is_grad_enabled() && output->storage == input->storage)
+    {
+        return NULL;
     }
 
+    return dense_compute(self, input, input_trans, input_ld, output);
+}
+
+static void dense_backward_compute(tensor_t *output, const dense_context_t *context)
+{
+    layer_t *layer = context->layer;
     dense_layer_t *dense = (dense_layer_t *)layer;
     dense_parameters_t *params = (dense_parameters_t *)layer->params;
-    tensor_t *input = layer->input;
+    tensor_t *input = output->grad_a;
 
-    if (input == NULL || input->grad == NULL)
+    bool input_trans;
+    size_t input_ld;
+    if (input == NULL || !dense_input_layout(input, &input_trans, &input_ld))
     {
         return;
     }
@@ -215,38 +488,76 @@ void dense_backward(tensor_t *output)
     size_t input_dim = dense->input_dim;
 
     const float *output_grad = output->grad;
+    float *activation_grad = NULL;
+    if (dense->activation != ACTIVATION_NONE)
+    {
+        const float *preactivation = context->preactivation ? context->preactivation->data : NULL;
+        if (dense->activation == ACTIVATION_GELU && preactivation == NULL)
+        {
+            return;
+        }
+        activation_grad = (float *)pool_alloc(batch_size * output_dim * sizeof(float));
+        if (activation_grad == NULL)
+        {
+            return;
+        }
+        cortex_sactivation_grad(dense->activation, batch_size, output_dim, output->data, preactivation, output_grad, activation_grad, output_dim);
+        output_grad = activation_grad;
+    }
+
     const float *input_data = input->data;
-    float *input_grad = input->grad;
     const float *weights_data = params->weights->data;
-    float *weights_grad = params->weights->grad;
-    float *bias_grad = params->bias->grad;
+    float *input_grad = tensor_grad(input);
+    float *weights_grad = tensor_grad(params->weights);
+    float *bias_grad = tensor_grad(params->bias);
 
-    for (size_t i = 0; i < batch_size; ++i)
+    // Frozen tensors have no gradient buffer, so the products feeding them are skipped entirely
+    if (bias_grad)
     {
-        const float *input_row = &input_data[i * input_dim];
-        float *input_grad_row = &input_grad[i * input_dim];
-
-        for (size_t j = 0; j < output_dim; ++j)
-        {
-            float grad_out = output_grad[i * output_dim + j];
-
-            bias_grad[j] += grad_out;
+        cortex_scolsum(batch_size, output_dim, output_grad, output_dim, bias_grad);
+    }
+    if (weights_grad)
+    {
+        cortex_sgemm(true, input_trans, output_dim, input_dim, batch_size, 1.0f, output_grad, output_dim, input_data, input_ld, 1.0f, weights_grad, input_dim);
+    }
+    if (input_grad && !input_trans)
+    {
+        cortex_sgemm(false, false, batch_size, input_dim, output_dim, 1.0f, output_grad, output_dim, weights_data, input_dim, 1.0f, input_grad, input_ld);
+    }
+    else if (input_grad)
+    {
+        // The input gradient shares the transposed layout, so its transpose W^T * dY^T is written row-major
+        cortex_sgemm(true, true, input_dim, batch_size, output_dim, 1.0f, weights_data, input_dim, output_grad, output_dim, 1.0f, input_grad, input_ld);
+    }
 
-            float *weights_grad_row = &weights_grad[j * input_dim];
-            const float *weights_row = &weights_data[j * input_dim];
+    if (activation_grad)
+    {
+        pool_free(activation_grad);
+    }
+}
 
-            for (size_t k = 0; k < input_dim; ++k)
-            {
-                weights_grad_row[k] += grad_out * input_row[k];
-                input_grad_row[k] += grad_out * weights_row[k];
-            }
-        }
+void dense_backward(tensor_t *output)
+{
+    if (output == NULL || output->grad == NULL)
+    {
+        return;
     }
 
-    if (input->backward)
+    const dense_context_t *context = (const dense_context_t *)output->context;
+    if (context == NULL || context->layer == NULL)
     {
-        input->backward(input);
+        return;
     }
+
+    layer_t *layer = context->layer;
+    dense_layer_t *dense = (dense_layer_t *)layer;
+    profiler_scope_t scope = profiler_begin();
+    dense_backward_compute(output, context);
+
+    // Both weight and input gradients are counted, the products skipped for frozen tensors are not subtracted
+    uint64_t batch_size = output->shape[0];
+    uint64_t bytes = (2 * batch_size * (dense->input_dim + dense->output_dim) + 2 * dense->input_dim * dense->output_dim) * sizeof(float);
+    profiler_end(&scope, "dense_backward", layer->name, 4 * batch_size * dense->input_dim * dense->output_dim, bytes);
 }
 
 layer_status_code_t dense_destroy(layer_t *self)
@@ -257,11 +568,73 @@ layer_status_code_t dense_destroy(layer_t *self)
     }
 
     dense_layer_t *dense = (dense_layer_t *)self;
-    
+
     if (pool_free(dense) == POOL_FREE_FAILURE)
     {
         return LAYER_DESTROY_FAILURE;
     }
     
     return LAYER_DESTROY_SUCCESS;
-}
\ No newline at end of file
+}
+
+// Converts trained weights in place for inference; INT8 keeps one symmetric scale per output channel as an extra parameter.
+// The FP32 weights are destroyed, so the parameters must be frozen first, after any optimizer or accumulator over them is gone
+layer_status_code_t dense_quantize(layer_t *self, tensor_dtype_t dtype)
+{
+    if (self == NULL || self->forward != dense_forward || dtype == TENSOR_FLOAT32 || dtype >= TENSOR_NUM_DTYPES)
+    {
+        return LAYER_QUANTIZE_FAILURE;
+    }
+
+    dense_parameters_t *params = (dense_parameters_t *)self->params;
+    tensor_t *weights = params->weights;
+    if (weights->dtype != TENSOR_FLOAT32 || !tensor_is_contiguous(weights) || !weights->frozen || !params->bias->frozen)
+    {
+        return LAYER_QUANTIZE_FAILURE;
+    }
+
+    tensor_t *quantized = tensor_empty_dtype(weights->shape, weights->ndim, dtype);
+    if (quantized == NULL)
+    {
+        return LAYER_QUANTIZE_FAILURE;
+    }
+
+    if (dtype == TENSOR_INT8)
+    {
+        size_t scales_shape[1] = {weights->shape[0]};
+        tensor_t *scales = tensor_empty(scales_shape, 1);
+        tensor_t **params_array = (tensor_t **)pool_alloc(3 * sizeof(tensor_t *));
+        if (scales == NULL || params_array == NULL)
+        {
+            if (scales)
+            {
+                tensor_destroy(scales);
+            }
+            if (params_array)
+            {
+                pool_free(params_array);
+            }
+            tensor_destroy(quantized);
+            return LAYER_QUANTIZE_FAILURE;
+        }
+        cortex_squantize_rows(weights->shape[0], weights->shape[1], weights->data, weights->shape[1], (int8_t *)quantized->data, scales->data);
+
+        params_array[1] = params->bias;
+        params_array[2] = scales;
+        pool_free(params->base.params_array);
+        params->base.params_array = params_array;
+        params->base.num_params = 3;
+        params->scales = scales;
+    }
+    else
+    {
+        cortex_sconvert_to(dtype, weights->size, weights->data, quantized->data);
+    }
+
+    tensor_destroy(weights);
+    params->weights = quantized;
+    params->base.params_array[0] = quantized;
+    params->base.freeze_params(self->params);
+
+    return LAYER_QUANTIZE_SUCCESS;
+}
@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "utils/memory/pool.h"
+#include "ops/kernels/elementwise.h"
 #include "nn/layers/layer.h"
 
 parameters_status_code_t parameters_destroy(parameters_t *params)
@@ -75,4 +76,105 @@ layer_status_code_t layer_destroy(layer_t *layer)
         }
     }
     return LAYER_DESTROY_SUCCESS;
-}
\ No newline at end of file
+}
+// Every tensor starts on a cache line of one shared storage, so its gradients end up in one flat buffer as well
+tensor_t* parameters_flatten(parameters_t **groups, size_t num_groups)
+{
+    if (groups == NULL || num_groups == 0)
+    {
+        return NULL;
+    }
+
+    size_t total = 0;
+    for (size_t g = 0; g < num_groups; ++g)
+    {
+        for (size_t i = 0; groups[g] && i < groups[g]->num_params; ++i)
+        {
+            total += (groups[g]->params_array[i]->size + PARAMETERS_ALIGNMENT - 1) / PARAMETERS_ALIGNMENT * PARAMETERS_ALIGNMENT;
+        }
+    }
+    if (total == 0)
+    {
+        return NULL;
+    }
+
+    size_t shape[1] = {total};
+    tensor_t *flat = tensor_zeros_aligned(shape, 1);
+    if (flat == NULL)
+    {
+        return NULL;
+    }
+    tensor_grad(flat);
+
+    size_t offset = 0;
+    for (size_t g = 0; g < num_groups; ++g)
+    {
+        for (size_t i = 0; groups[g] && i < groups[g]->num_params; ++i)
+        {
+            tensor_t *param = groups[g]->params_array[i];
+            if (!tensor_move_into(param, flat, offset))
+            {
+                tensor_destroy(flat);
+                return NULL;
+            }
+            offset += (param->size + PARAMETERS_ALIGNMENT - 1) / PARAMETERS_ALIGNMENT * PARAMETERS_ALIGNMENT;
+        }
+    }
+
+    return flat;
+}
+
+// Gradients that sit back to back in one storage, as flattened parameters do, are swept as a single run padding included
+static void parameters_scale_runs(parameters_t *params, float scale)
+{
+    if (params == NULL)
+    {
+        return;
+    }
+
+    tensor_storage_t *storage = NULL;
+    float *begin = NULL;
+    float *end = NULL;
+    for (size_t i = 0; i < params->num_params; ++i)
+    {
+        tensor_t *param = params->params_array[i];
+        if (param == NULL || !tensor_has_grad(param) || !tensor_is_contiguous(param))
+        {
+            continue;
+        }
+        if (param->storage == storage && param->grad >= end && param->grad - end < PARAMETERS_ALIGNMENT)
+        {
+            end = param->grad + param->size;
+            continue;
+        }
+        if (begin)
+        {
+            cortex_sscal((size_t)(end - begin), scale, begin);
+        }
+        storage = param->storage;
+        begin = param->grad;
+        end = param->grad + param->size;
+    }
+    if (begin)
+    {
+        cortex_sscal((size_t)(end - begin), scale, begin);
+    }
+}
+
+void parameters_zero_grad(parameters_t *params)
+{
+    parameters_scale_runs(params, 0.0f);
+}
+
+void parameters_scale_grad(parameters_t *params, float scale)
+{
+    parameters_scale_runs(params, scale);
+}
+
+void layer_zero_grad(layer_t *layer)
+{
+    if (layer)
+    {
+        parameters_zero_grad(layer->params);
+    }
+}
@@ -0,0 +1,269 @@
+#include <string.h>
+#include "utils/memory/pool.h"
+#include "utils/profiler/profiler.h"
+#include "ops/kernels/elementwise.h"
+#include "nn/layers/dense.h"
+#include "nn/models/sequential.h"
+
+#define SEQUENTIAL_INITIAL_CAPACITY 4
+
+sequential_t* sequential_create(const char *name)
+{
+    sequential_t *model = (sequential_t *)pool_alloc(sizeof(sequential_t));
+    if (model == NULL)
+    {
+        return NULL;
+    }
+
+    model->name = NULL;
+    if (name)
+    {
+        size_t name_length = strlen(name) + 1;
+        model->name = (char *)pool_alloc(name_length * sizeof(char));
+        if (model->name == NULL)
+        {
+            pool_free(model);
+            return NULL;
+        }
+        memcpy(model->name, name, name_length);
+    }
+    model->num_layers = 0;
+    model->capacity = 0;
+    model->layers = NULL;
+    model->input_dim = 0;
+    model->output_dim = 0;
+    model->plan = NULL;
+    model->parameters = NULL;
+    model->output = NULL;
+
+    return model;
+}
+
+// The last output may live in the plan's block, so it is forgotten together with the plan
+static void sequential_release_plan(sequential_t *model)
+{
+    if (model->plan == NULL)
+    {
+        return;
+    }
+    if (model->output == model->plan->outputs[model->plan->num_layers - 1])
+    {
+        model->output = NULL;
+    }
+    memory_plan_destroy(model->plan);
+    model->plan = NULL;
+}
+
+// Shapes are checked here once, when the layer joins the model, instead of on every forward call
+sequential_status_code_t sequential_add(sequential_t *model, layer_t *layer)
+{
+    if (model == NULL || layer == NULL || layer->forward != dense_forward)
+    {
+        return SEQUENTIAL_ADD_FAILURE;
+    }
+
+    dense_layer_t *dense = (dense_layer_t *)layer;
+    if (model->num_layers > 0 && dense->input_dim != model->output_dim)
+    {
+        return SEQUENTIAL_ADD_FAILURE;
+    }
+
+    if (model->num_layers == model->capacity)
+    {
+        size_t capacity = model->capacity ? 2 * model->capacity : SEQUENTIAL_INITIAL_CAPACITY;
+        layer_t **layers = (layer_t **)pool_alloc(capacity * sizeof(layer_t *));
+        if (layers == NULL)
+        {
+            return SEQUENTIAL_ADD_FAILURE;
+        }
+        if (model->layers)
+        {
+            memcpy(layers, model->layers, model->num_layers * sizeof(layer_t *));
+            pool_free(model->layers);
+        }
+        model->layers = layers;
+        model->capacity = capacity;
+    }
+
+    // A new layer invalidates the compiled plan
+    sequential_release_plan(model);
+
+    if (model->num_layers == 0)
+    {
+        model->input_dim = dense->input_dim;
+    }
+    model->output_dim = dense->output_dim;
+    model->layers[model->num_layers++] = layer;
+
+    return SEQUENTIAL_ADD_SUCCESS;
+}
+
+// Moves every parameter into one aligned buffer and every gradient into a second one, layers added later stay separate
+sequential_status_code_t sequential_flatten_parameters(sequential_t *model)
+{
+    if (model == NULL || model->num_layers == 0)
+    {
+        return SEQUENTIAL_FLATTEN_FAILURE;
+    }
+
+    parameters_t **groups = (parameters_t **)pool_alloc(model->num_layers * sizeof(parameters_t *));
+    if (groups == NULL)
+    {
+        return SEQUENTIAL_FLATTEN_FAILURE;
+    }
+    for (size_t i = 0; i < model->num_layers; ++i)
+    {
+        groups[i] = model->layers[i]->params;
+    }
+    tensor_t *parameters = parameters_flatten(groups, model->num_layers);
+    pool_free(groups);
+    if (parameters == NULL)
+    {
+        return SEQUENTIAL_FLATTEN_FAILURE;
+    }
+
+    // Tensors that were flattened before hold their own reference to the old buffer, which goes once they have moved
+    if (model->parameters)
+    {
+        tensor_destroy(model->parameters);
+    }
+    model->parameters = parameters;
+
+    return SEQUENTIAL_FLATTEN_SUCCESS;
+}
+
+// Compiling fixes the batch size and binds every activation and gradient to a planned buffer
+sequential_status_code_t sequential_compile(sequential_t *model, size_t batch_size, bool training)
+{
+    if (model == NULL || model->num_layers == 0)
+    {
+        return SEQUENTIAL_COMPILE_FAILURE;
+    }
+
+    sequential_release_plan(model);
+
+    model->plan = memory_plan_create(model->layers, model->num_layers, batch_size, training);
+    if (model->plan == NULL)
+    {
+        return SEQUENTIAL_COMPILE_FAILURE;
+    }
+    for (size_t i = 0; i < model->num_layers; ++i)
+    {
+        model->layers[i]->is_training = training;
+    }
+
+    return SEQUENTIAL_COMPILE_SUCCESS;
+}
+
+// Batches the model was not compiled for still run, through the layers' own allocating forward
+tensor_t* sequential_forward(sequential_t *model, const tensor_t *input)
+{
+    if (model == NULL || input == NULL || model->num_layers == 0)
+    {
+        return NULL;
+    }
+
+    profiler_scope_t scope = profiler_begin();
+    if (model->plan && input->ndim == 2 && input->shape[0] == model->plan->batch_size)
+    {
+        model->output = memory_plan_forward(model->plan, input);
+    }
+    else
+    {
+        const tensor_t *x = input;
+        for (size_t i = 0; i < model->num_layers && x; ++i)
+        {
+            x = layer_forward(model->layers[i], x);
+        }
+        model->output = (tensor_t *)x;
+    }
+    profiler_end(&scope, "sequential_forward", model->name, 0, 0);
+
+    return model->output;
+}
+
+// The output gradient is filled in by the caller through tensor_grad before this runs
+void sequential_backward(sequential_t *model)
+{
+    if (model == NULL || model->output == NULL)
+    {
+        return;
+    }
+
+    profiler_scope_t scope = profiler_begin();
+    if (model->plan && model->output == model->plan->outputs[model->num_layers - 1])
+    {
+        memory_plan_backward(model->plan);
+    }
+    else
+    {
+        tensor_backward(model->output);
+    }
+    profiler_end(&scope, "sequential_backward", model->name, 0, 0);
+}
+
+// Flattened parameters are cleared with one sweep over the shared gradient buffer
+void sequential_zero_grad(sequential_t *model)
+{
+    if (model == NULL)
+    {
+        return;
+    }
+
+    tensor_t *flat = model->parameters;
+    if (flat && tensor_has_grad(flat))
+    {
+        cortex_sfill(flat->size, 0.0f, flat->grad);
+    }
+    for (size_t i = 0; i < model->num_layers; ++i)
+    {
+        parameters_t *params = model->layers[i]->params;
+        bool flattened = params != NULL && flat != NULL;
+        for (size_t j = 0; flattened && j < params->num_params; ++j)
+        {
+            flattened = params->params_array[j]->storage == flat->storage;
+        }
+        if (!flattened)
+        {
+            layer_zero_grad(model->layers[i]);
+        }
+    }
+}
+
+sequential_status_code_t sequential_destroy(sequential_t *model)
+{
+    if (model == NULL)
+    {
+        return SEQUENTIAL_DESTROY_FAILURE;
+    }
+
+    if (model->plan && memory_plan_destroy(model->plan) == MEMORY_PLAN_DESTROY_FAILURE)
+    {
+        return SEQUENTIAL_DESTROY_FAILURE;
+    }
+    for (size_t i = 0; i < model->num_layers; ++i)
+    {
+        if (layer_destroy(model->layers[i]) == LAYER_DESTROY_FAILURE)
+        {
+            return SEQUENTIAL_DESTROY_FAILURE;
+        }
+    }
+    if (model->parameters && tensor_destroy(model->parameters) == TENSOR_DESTROY_FAILURE)
+    {
+        return SEQUENTIAL_DESTROY_FAILURE;
+    }
+    if (model->layers && pool_free(model->layers) == POOL_FREE_FAILURE)
+    {
+        return SEQUENTIAL_DESTROY_FAILURE;
+    }
+    if (model->name && pool_free(model->name) == POOL_FREE_FAILURE)
+    {
+        return SEQUENTIAL_DESTROY_FAILURE;
+    }
+    if (pool_free(model) == POOL_FREE_FAILURE)
+    {
+        return SEQUENTIAL_DESTROY_FAILURE;
+    }
+
+    return SEQUENTIAL_DESTROY_SUCCESS;
+}
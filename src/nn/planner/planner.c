@@ -0,0 +1,339 @@
+#include <stdint.h>
+#include <string.h>
+#include "utils/memory/pool.h"
+#include "nn/layers/dense.h"
+#include "nn/planner/planner.h"
+
+#define PLAN_ALIGNMENT 16
+#define PLAN_SLOTS 3
+#define PLAN_OUTPUT 0
+#define PLAN_GRAD 1
+#define PLAN_PREACTIVATION 2
+
+static size_t plan_align(size_t size)
+{
+    return (size + PLAN_ALIGNMENT - 1) / PLAN_ALIGNMENT * PLAN_ALIGNMENT;
+}
+
+static bool plan_overlaps(const memory_plan_buffer_t *a, const memory_plan_buffer_t *b)
+{
+    return a->first <= b->last && b->first <= a->last;
+}
+
+// Forward of layer i runs at step i and its backward at step 2L - 1 - i, every buffer lives from its producer to its last reader
+static void plan_lifetimes(memory_plan_t *plan)
+{
+    size_t num_layers = plan->num_layers;
+    for (size_t i = 0; i < num_layers; ++i)
+    {
+        dense_layer_t *dense = (dense_layer_t *)plan->layers[i];
+        size_t size = plan_align(plan->batch_size * dense->output_dim);
+        memory_plan_buffer_t *slots = &plan->buffers[i * PLAN_SLOTS];
+
+        if (!plan->training)
+        {
+            slots[PLAN_OUTPUT] = (memory_plan_buffer_t){size, i, i + 1, 0};
+            continue;
+        }
+
+        size_t backward = 2 * num_layers - 1 - i;
+        slots[PLAN_OUTPUT] = (memory_plan_buffer_t){size, i, backward, 0};
+        slots[PLAN_GRAD] = (memory_plan_buffer_t){size, backward - 1, backward, 0};
+        if (dense->activation == ACTIVATION_GELU)
+        {
+            slots[PLAN_PREACTIVATION] = (memory_plan_buffer_t){size, i, backward, 0};
+        }
+    }
+}
+
+// Greedy by size: larger buffers are placed first, each at the lowest offset clear of every placed buffer it is live with
+static void plan_assign(memory_plan_t *plan, size_t *order)
+{
+    memory_plan_buffer_t *buffers = plan->buffers;
+    size_t count = plan->num_buffers;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t j = i;
+        for (; j > 0 && buffers[order[j - 1]].size < buffers[i].size; --j)
+        {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+
+    for (size_t i = 0; i < count && buffers[order[i]].size > 0; ++i)
+    {
+        memory_plan_buffer_t *buffer = &buffers[order[i]];
+        size_t offset = 0;
+        bool moved = true;
+        while (moved)
+        {
+            moved = false;
+            for (size_t j = 0; j < i; ++j)
+            {
+                const memory_plan_buffer_t *placed = &buffers[order[j]];
+                if (plan_overlaps(buffer, placed) && offset < placed->offset + placed->size && placed->offset < offset + buffer->size)
+                {
+                    offset = placed->offset + placed->size;
+                    moved = true;
+                }
+            }
+        }
+        buffer->offset = offset;
+    }
+
+    size_t steps = plan->training ? 2 * plan->num_layers : plan->num_layers + 1;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t end = (buffers[i].size > 0) ? buffers[i].offset + buffers[i].size : 0;
+        plan->block_size = (end > plan->block_size) ? end : plan->block_size;
+        plan->unplanned_size += buffers[i].size;
+    }
+    for (size_t step = 0; step < steps; ++step)
+    {
+        size_t live = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (buffers[i].size > 0 && buffers[i].first <= step && step <= buffers[i].last)
+            {
+                live += buffers[i].size;
+            }
+        }
+        plan->peak_size = (live > plan->peak_size) ? live : plan->peak_size;
+    }
+
+    plan->block_size *= sizeof(float);
+    plan->unplanned_size *= sizeof(float);
+    plan->peak_size *= sizeof(float);
+}
+
+static bool plan_check_layers(layer_t **layers, size_t num_layers)
+{
+    for (size_t i = 0; i < num_layers; ++i)
+    {
+        if (layers[i] == NULL || layers[i]->forward != dense_forward)
+        {
+            return false;
+        }
+        if (i > 0 && ((dense_layer_t *)layers[i - 1])->output_dim != ((dense_layer_t *)layers[i])->input_dim)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void *plan_alloc_zeroed(size_t size)
+{
+    void *ptr = pool_alloc(size);
+    if (ptr)
+    {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+// Gradient slots share offsets with forward buffers, so a slot is only attached while its lifetime is running
+static void plan_attach_grad(tensor_t *tensor, float *grad)
+{
+    memset(grad, 0, tensor->size * sizeof(float));
+    tensor->storage->grad = grad;
+    tensor->grad = grad;
+}
+
+static void plan_detach_grad(tensor_t *tensor)
+{
+    tensor->storage->grad = NULL;
+    tensor->grad = NULL;
+}
+
+memory_plan_t* memory_plan_create(layer_t **layers, size_t num_layers, size_t batch_size, bool training)
+{
+    if (layers == NULL || num_layers == 0 || batch_size == 0 || !plan_check_layers(layers, num_layers))
+    {
+        return NULL;
+    }
+
+    memory_plan_t *plan = (memory_plan_t *)plan_alloc_zeroed(sizeof(memory_plan_t));
+    if (plan == NULL)
+    {
+        return NULL;
+    }
+    plan->num_layers = num_layers;
+    plan->batch_size = batch_size;
+    plan->training = training;
+    plan->num_buffers = num_layers * PLAN_SLOTS;
+
+    plan->layers = (layer_t **)plan_alloc_zeroed(num_layers * sizeof(layer_t *));
+    plan->buffers = (memory_plan_buffer_t *)plan_alloc_zeroed(plan->num_buffers * sizeof(memory_plan_buffer_t));
+    plan->outputs = (tensor_t **)plan_alloc_zeroed(num_layers * sizeof(tensor_t *));
+    plan->grads = (float **)plan_alloc_zeroed(num_layers * sizeof(float *));
+    plan->preactivations = (tensor_t **)plan_alloc_zeroed(num_layers * sizeof(tensor_t *));
+    size_t *order = (size_t *)pool_alloc(plan->num_buffers * sizeof(size_t));
+    if (plan->layers == NULL || plan->buffers == NULL || plan->outputs == NULL || plan->grads == NULL || plan->preactivations == NULL || order == NULL)
+    {
+        if (order)
+        {
+            pool_free(order);
+        }
+        memory_plan_destroy(plan);
+        return NULL;
+    }
+    memcpy(plan->layers, layers, num_layers * sizeof(layer_t *));
+
+    plan_lifetimes(plan);
+    plan_assign(plan, order);
+    pool_free(order);
+
+    plan->memory = pool_alloc(plan->block_size + PLAN_ALIGNMENT * sizeof(float));
+    if (plan->memory == NULL)
+    {
+        memory_plan_destroy(plan);
+        return NULL;
+    }
+    size_t alignment = PLAN_ALIGNMENT * sizeof(float);
+    plan->block = (float *)(((uintptr_t)plan->memory + alignment - 1) / alignment * alignment);
+
+    for (size_t i = 0; i < num_layers; ++i)
+    {
+        dense_layer_t *dense = (dense_layer_t *)layers[i];
+        const memory_plan_buffer_t *slots = &plan->buffers[i * PLAN_SLOTS];
+        size_t shape[2] = {batch_size, dense->output_dim};
+
+        plan->outputs[i] = tensor_from_buffer(plan->block + slots[PLAN_OUTPUT].offset, shape, 2);
+        if (plan->outputs[i] == NULL)
+        {
+            memory_plan_destroy(plan);
+            return NULL;
+        }
+        if (slots[PLAN_GRAD].size > 0)
+        {
+            plan->grads[i] = plan->block + slots[PLAN_GRAD].offset;
+        }
+
+        // Recorded outputs carry a context, set up here so that steps stay allocation-free; planned pre-activation buffers go to the output, which owns them from then on
+        if (slots[PLAN_PREACTIVATION].size > 0)
+        {
+            plan->preactivations[i] = tensor_from_buffer(plan->block + slots[PLAN_PREACTIVATION].offset, shape, 2);
+            if (plan->preactivations[i] == NULL)
+            {
+                memory_plan_destroy(plan);
+                return NULL;
+            }
+        }
+        if ((training || plan->preactivations[i]) && !dense_attach_preactivation(layers[i], plan->outputs[i], plan->preactivations[i]))
+        {
+            if (plan->preactivations[i])
+            {
+                tensor_destroy(plan->preactivations[i]);
+                plan->preactivations[i] = NULL;
+            }
+            memory_plan_destroy(plan);
+            return NULL;
+        }
+    }
+
+    return plan;
+}
+
+tensor_t* memory_plan_forward(memory_plan_t *plan, const tensor_t *input)
+{
+    if (plan == NULL || input == NULL || input->ndim != 2 || input->shape[0] != plan->batch_size)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < plan->num_layers; ++i)
+    {
+        plan_detach_grad(plan->outputs[i]);
+    }
+
+    // Only the caller's input needs checking, every later input is a planned buffer whose shape was fixed at creation
+    if (dense_forward_out(plan->layers[0], input, plan->outputs[0]) == NULL)
+    {
+        return NULL;
+    }
+    for (size_t i = 1; i < plan->num_layers; ++i)
+    {
+        dense_forward_into(plan->layers[i], plan->outputs[i - 1], plan->outputs[i]);
+    }
+
+    tensor_t *output = plan->outputs[plan->num_layers - 1];
+    if (plan->training && output->backward)
+    {
+        plan_attach_grad(output, plan->grads[plan->num_layers - 1]);
+    }
+    return output;
+}
+
+// Runs the layers' backward passes itself instead of the autograd engine, so every gradient slot is attached at its planned step
+void memory_plan_backward(memory_plan_t *plan)
+{
+    if (plan == NULL || !plan->training)
+    {
+        return;
+    }
+
+    for (size_t i = plan->num_layers; i > 0; --i)
+    {
+        tensor_t *output = plan->outputs[i - 1];
+        if (output->grad == NULL || output->backward == NULL)
+        {
+            return;
+        }
+        if (i > 1)
+        {
+            plan_attach_grad(plan->outputs[i - 2], plan->grads[i - 2]);
+        }
+        output->backward(output);
+        plan_detach_grad(output);
+    }
+}
+
+size_t memory_plan_get_size(const memory_plan_t *plan)
+{
+    return plan ? plan->block_size : 0;
+}
+
+size_t memory_plan_get_peak(const memory_plan_t *plan)
+{
+    return plan ? plan->peak_size : 0;
+}
+
+size_t memory_plan_get_unplanned_size(const memory_plan_t *plan)
+{
+    return plan ? plan->unplanned_size : 0;
+}
+
+// Planned pre-activation buffers belong to the planned outputs and go with them
+memory_plan_status_code_t memory_plan_destroy(memory_plan_t *plan)
+{
+    if (plan == NULL)
+    {
+        return MEMORY_PLAN_DESTROY_FAILURE;
+    }
+
+    for (size_t i = 0; i < plan->num_layers; ++i)
+    {
+        if (plan->outputs && plan->outputs[i])
+        {
+            tensor_destroy(plan->outputs[i]);
+        }
+    }
+
+    void *arrays[] = {plan->memory, plan->layers, plan->buffers, plan->outputs, plan->grads, plan->preactivations};
+    for (size_t i = 0; i < sizeof(arrays) / sizeof(arrays[0]); ++i)
+    {
+        if (arrays[i] && pool_free(arrays[i]) == POOL_FREE_FAILURE)
+        {
+            return MEMORY_PLAN_DESTROY_FAILURE;
+        }
+    }
+    if (pool_free(plan) == POOL_FREE_FAILURE)
+    {
+        return MEMORY_PLAN_DESTROY_FAILURE;
+    }
+
+    return MEMORY_PLAN_DESTROY_SUCCESS;
+}
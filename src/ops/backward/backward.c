@@ -1,44 +1,174 @@
 #include <string.h> 
+#include "utils/memory/pool.h"
 #include "ops/backward/backward.h"
+#include "ops/kernels/elementwise.h"
+#include "utils/profiler/profiler.h"
 
-void tensor_add_backward(tensor_t* self) 
+static const char* const binary_backward_names[] = {"add_backward", "sub_backward", "mul_backward", "div_backward", "maximum_backward", "minimum_backward"};
+static const char* const unary_backward_names[] = {"neg_backward", "abs_backward", "sqrt_backward", "exp_backward", "log_backward", "tanh_backward", "sigmoid_backward", "relu_backward"};
+
+// Gradients are formed at the broadcast output shape and folded back into each input over its repeated dimensions
+static void tensor_binary_backward(tensor_t* self, binary_op_t op)
 {
-    if (self == NULL || self->grad_a == NULL || self->grad_b == NULL)
+    if (self == NULL || self->grad == NULL || self->grad_a == NULL || self->grad_b == NULL)
     {
         return;
     }
 
-    tensor_t* a = self->grad_a;
-    tensor_t* b = self->grad_b;
-    float* a_grad = a->grad;
-    float* b_grad = b->grad;
-    const float* grad_output = self->grad;
+    tensor_t* inputs[2] = {self->grad_a, self->grad_b};
+    size_t strides[2][MAX_DIMS];
+    tensor_broadcast_strides(inputs[0], self->shape, self->ndim, strides[0]);
+    tensor_broadcast_strides(inputs[1], self->shape, self->ndim, strides[1]);
 
-    for (size_t i = 0; i < self->size; ++i) 
+    profiler_scope_t scope = profiler_begin();
+    float* scratch = NULL;
+    for (size_t side = 0; side < 2; ++side)
     {
-        a_grad[i] += grad_output[i];
-        b_grad[i] += grad_output[i];
+        // Frozen inputs have no gradient buffer and are skipped
+        float* grad = tensor_grad(inputs[side]);
+        if (grad == NULL)
+        {
+            continue;
+        }
+
+        const float* local = self->grad;
+        bool passthrough = (op == BINARY_ADD) || (op == BINARY_SUB && side == 0);
+        if (!passthrough)
+        {
+            if (scratch == NULL)
+            {
+                scratch = (float*)pool_alloc(self->size * sizeof(float));
+            }
+            if (scratch == NULL)
+            {
+                break;
+            }
+            cortex_sbinary_grad(op, side == 1, self->ndim, self->shape, inputs[0]->data, strides[0], inputs[1]->data, strides[1], self->data, self->grad, scratch);
+            local = scratch;
+        }
+
+        cortex_saccumulate(self->ndim, self->shape, local, grad, strides[side]);
     }
 
-    tensor_backward(a);
-    tensor_backward(b);
+    if (scratch)
+    {
+        pool_free(scratch);
+    }
+    profiler_end(&scope, binary_backward_names[op], NULL, 2 * self->size, 4 * self->size * sizeof(float));
+}
+
+static void tensor_unary_backward(tensor_t* self, unary_op_t op)
+{
+    if (self == NULL || self->grad == NULL || self->grad_a == NULL)
+    {
+        return;
+    }
+
+    tensor_t* x = self->grad_a;
+    float* grad = tensor_grad(x);
+    if (grad == NULL)
+    {
+        return;
+    }
+
+    profiler_scope_t scope = profiler_begin();
+    float* local = (float*)pool_alloc(self->size * sizeof(float));
+    if (local)
+    {
+        cortex_sunary_grad(op, x->ndim, x->shape, x->data, x->stride, self->data, self->grad, local);
+        cortex_saccumulate(x->ndim, x->shape, local, grad, x->stride);
+        pool_free(local);
+    }
+    profiler_end(&scope, unary_backward_names[op], NULL, 2 * self->size, 4 * self->size * sizeof(float));
+}
+
+void tensor_add_backward(tensor_t* self) 
+{
+    tensor_binary_backward(self, BINARY_ADD);
+}
+
+void tensor_sub_backward(tensor_t* self)
+{
+    tensor_binary_backward(self, BINARY_SUB);
+}
+
+void tensor_mul_backward(tensor_t* self)
+{
+    tensor_binary_backward(self, BINARY_MUL);
+}
+
+void tensor_div_backward(tensor_t* self)
+{
+    tensor_binary_backward(self, BINARY_DIV);
+}
+
+void tensor_maximum_backward(tensor_t* self)
+{
+    tensor_binary_backward(self, BINARY_MAX);
+}
+
+void tensor_minimum_backward(tensor_t* self)
+{
+    tensor_binary_backward(self, BINARY_MIN);
+}
+
+void tensor_neg_backward(tensor_t* self)
+{
+    tensor_unary_backward(self, UNARY_NEG);
+}
+
+void tensor_abs_backward(tensor_t* self)
+{
+    tensor_unary_backward(self, UNARY_ABS);
+}
+
+void tensor_sqrt_backward(tensor_t* self)
+{
+    tensor_unary_backward(self, UNARY_SQRT);
+}
+
+void tensor_exp_backward(tensor_t* self)
+{
+    tensor_unary_backward(self, UNARY_EXP);
+}
+
+void tensor_log_backward(tensor_t* self)
+{
+    tensor_unary_backward(self, UNARY_LOG);
+}
+
+void tensor_tanh_backward(tensor_t* self)
+{
+    tensor_unary_backward(self, UNARY_TANH);
+}
+
+void tensor_sigmoid_backward(tensor_t* self)
+{
+    tensor_unary_backward(self, UNARY_SIGMOID);
+}
+
+void tensor_relu_backward(tensor_t* self)
+{
+    tensor_unary_backward(self, UNARY_RELU);
 }
 
 void tensor_reshape_backward(tensor_t* self) 
 {
-    if (self == NULL || self->grad_a == NULL)
+    if (self == NULL || self->grad == NULL || self->grad_a == NULL)
     {
         return;
     }
 
     tensor_t* tensor = self->grad_a;
-    float* grad = tensor->grad;
-    const float* self_grad = self->grad;
+    float* grad = tensor_grad(tensor);
 
-    for (size_t i = 0; i < self->size; ++i) 
+    if (grad)
     {
-        grad[i] += self_grad[i];
+        cortex_saccumulate(tensor->ndim, tensor->shape, self->grad, grad, tensor->stride);
     }
+}
 
-    tensor_backward(tensor);
-}
\ No newline at end of file
+void tensor_view_backward(tensor_t* self)
+{
+    (void)self;
+}
@@ -1,63 +1,509 @@
 #include <string.h>
 #include "ops/forward/forward.h"
+#include "autograd/mode.h"
 #include "ops/backward/backward.h"
+#include "ops/kernels/elementwise.h"
+#include "utils/profiler/profiler.h"
 
-tensor_t* tensor_add(const tensor_t* a, const tensor_t* b) 
+static const char* const binary_op_names[] = {"add", "sub", "mul", "div", "maximum", "minimum"};
+static const char* const unary_op_names[] = {"neg", "abs", "sqrt", "exp", "log", "tanh", "sigmoid", "relu"};
+
+// A view is part of the graph only so the engine can reach its base, its gradient already lands in the shared storage
+static tensor_t* tensor_view_record(tensor_t* view, const tensor_t* base)
 {
-    if (a == NULL || b == NULL)
+    if (view && cortex_is_grad_enabled())
     {
-        return NULL;
+        view->backward = tensor_view_backward;
+        view->grad_a = (tensor_t*)base;
+    }
+    return view;
+}
+
+// Caller-provided outputs are written densely, so they must be contiguous and already have the result shape
+static bool tensor_out_matches(const tensor_t* out, const size_t* shape, size_t ndim)
+{
+    if (out == NULL || out->ndim != ndim || out->dtype != TENSOR_FLOAT32 || !tensor_is_contiguous(out))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < ndim; ++i)
+    {
+        if (out->shape[i] != shape[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Recording into a tensor that already shares storage with an input would overwrite values its backward still needs
+static bool tensor_out_aliases(const tensor_t* out, const tensor_t* a, const tensor_t* b)
+{
+    return cortex_is_grad_enabled() && (out->storage == a->storage || (b && out->storage == b->storage));
+}
+
+// Reused outputs drop any graph and gradient left over from a previous call
+static tensor_t* tensor_record(tensor_t* result, void (*backward)(tensor_t*), const tensor_t* a, const tensor_t* b)
+{
+    bool record = cortex_is_grad_enabled();
+    result->backward = record ? backward : NULL;
+    result->grad_a = record ? (tensor_t*)a : NULL;
+    result->grad_b = record ? (tensor_t*)b : NULL;
+    if (record && tensor_has_grad(result))
+    {
+        memset(result->grad, 0, result->size * sizeof(float));
     }
-    if (a->size != b->size)
+    return result;
+}
+
+static tensor_t* tensor_binary(const tensor_t* a, const tensor_t* b, binary_op_t op, void (*backward)(tensor_t*), tensor_t* out)
+{
+    if (a == NULL || b == NULL || a->dtype != TENSOR_FLOAT32 || b->dtype != TENSOR_FLOAT32)
     {
         return NULL;
     }
 
-    tensor_t* result = tensor_like(a);
-    if (result == NULL)
+    size_t shape[MAX_DIMS];
+    size_t ndim;
+    size_t a_stride[MAX_DIMS];
+    size_t b_stride[MAX_DIMS];
+    if (!tensor_broadcast_shape(a, b, shape, &ndim))
+    {
+        return NULL;
+    }
+    if (out && (!tensor_out_matches(out, shape, ndim) || tensor_out_aliases(out, a, b)))
     {
         return NULL;
     }
+    tensor_broadcast_strides(a, shape, ndim, a_stride);
+    tensor_broadcast_strides(b, shape, ndim, b_stride);
+
+    profiler_scope_t scope = profiler_begin();
+    tensor_t* result = out ? out : tensor_empty(shape, ndim);
+    if (result)
+    {
+        cortex_sbinary(op, ndim, shape, a->data, a_stride, b->data, b_stride, result->data);
+        tensor_record(result, backward, a, b);
+    }
+    profiler_end(&scope, binary_op_names[op], NULL, result ? result->size : 0, result ? 3 * result->size * sizeof(float) : 0);
 
-    size_t size = a->size;
-    const float* a_data = a->data;
-    const float* b_data = b->data;
-    float* res_data = result->data;
+    return result;
+}
 
-    for (size_t i = 0; i < size; ++i) 
+static tensor_t* tensor_unary(const tensor_t* x, unary_op_t op, void (*backward)(tensor_t*), tensor_t* out)
+{
+    if (x == NULL || x->dtype != TENSOR_FLOAT32)
+    {
+        return NULL;
+    }
+    if (out && (!tensor_out_matches(out, x->shape, x->ndim) || tensor_out_aliases(out, x, NULL)))
     {
-        res_data[i] = a_data[i] + b_data[i];
+        return NULL;
     }
 
-    result->backward = tensor_add_backward;
-    result->grad_a = (tensor_t*)a;
-    result->grad_b = (tensor_t*)b;
+    profiler_scope_t scope = profiler_begin();
+    tensor_t* result = out ? out : tensor_empty(x->shape, x->ndim);
+    if (result)
+    {
+        cortex_sunary(op, x->ndim, x->shape, x->data, x->stride, result->data);
+        tensor_record(result, backward, x, NULL);
+    }
+    profiler_end(&scope, unary_op_names[op], NULL, result ? result->size : 0, result ? 2 * result->size * sizeof(float) : 0);
 
     return result;
 }
 
+// In-place updates destroy values the graph may have saved, so they are only available with autograd off
+static tensor_t* tensor_binary_inplace(tensor_t* a, const tensor_t* b, binary_op_t op)
+{
+    if (a == NULL || b == NULL || b->dtype != TENSOR_FLOAT32 || cortex_is_grad_enabled())
+    {
+        return NULL;
+    }
+
+    size_t b_stride[MAX_DIMS];
+    if (!tensor_out_matches(a, a->shape, a->ndim) || !tensor_broadcast_strides(b, a->shape, a->ndim, b_stride))
+    {
+        return NULL;
+    }
+
+    profiler_scope_t scope = profiler_begin();
+    cortex_sbinary(op, a->ndim, a->shape, a->data, a->stride, b->data, b_stride, a->data);
+    profiler_end(&scope, binary_op_names[op], NULL, a->size, 3 * a->size * sizeof(float));
+
+    return a;
+}
+
+static tensor_t* tensor_unary_inplace(tensor_t* x, unary_op_t op)
+{
+    if (x == NULL || x->dtype != TENSOR_FLOAT32 || cortex_is_grad_enabled() || !tensor_is_contiguous(x))
+    {
+        return NULL;
+    }
+
+    profiler_scope_t scope = profiler_begin();
+    cortex_sunary(op, x->ndim, x->shape, x->data, x->stride, x->data);
+    profiler_end(&scope, unary_op_names[op], NULL, x->size, 2 * x->size * sizeof(float));
+
+    return x;
+}
+
+tensor_t* tensor_add(const tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary(a, b, BINARY_ADD, tensor_add_backward, NULL);
+}
+
+tensor_t* tensor_add_out(const tensor_t* a, const tensor_t* b, tensor_t* out)
+{
+    return tensor_binary(a, b, BINARY_ADD, tensor_add_backward, out);
+}
+
+tensor_t* tensor_add_(tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary_inplace(a, b, BINARY_ADD);
+}
+
+tensor_t* tensor_sub(const tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary(a, b, BINARY_SUB, tensor_sub_backward, NULL);
+}
+
+tensor_t* tensor_sub_out(const tensor_t* a, const tensor_t* b, tensor_t* out)
+{
+    return tensor_binary(a, b, BINARY_SUB, tensor_sub_backward, out);
+}
+
+tensor_t* tensor_sub_(tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary_inplace(a, b, BINARY_SUB);
+}
+
+tensor_t* tensor_mul(const tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary(a, b, BINARY_MUL, tensor_mul_backward, NULL);
+}
+
+tensor_t* tensor_mul_out(const tensor_t* a, const tensor_t* b, tensor_t* out)
+{
+    return tensor_binary(a, b, BINARY_MUL, tensor_mul_backward, out);
+}
+
+tensor_t* tensor_mul_(tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary_inplace(a, b, BINARY_MUL);
+}
+
+tensor_t* tensor_div(const tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary(a, b, BINARY_DIV, tensor_div_backward, NULL);
+}
+
+tensor_t* tensor_div_out(const tensor_t* a, const tensor_t* b, tensor_t* out)
+{
+    return tensor_binary(a, b, BINARY_DIV, tensor_div_backward, out);
+}
+
+tensor_t* tensor_div_(tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary_inplace(a, b, BINARY_DIV);
+}
+
+tensor_t* tensor_maximum(const tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary(a, b, BINARY_MAX, tensor_maximum_backward, NULL);
+}
+
+tensor_t* tensor_maximum_out(const tensor_t* a, const tensor_t* b, tensor_t* out)
+{
+    return tensor_binary(a, b, BINARY_MAX, tensor_maximum_backward, out);
+}
+
+tensor_t* tensor_maximum_(tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary_inplace(a, b, BINARY_MAX);
+}
+
+tensor_t* tensor_minimum(const tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary(a, b, BINARY_MIN, tensor_minimum_backward, NULL);
+}
+
+tensor_t* tensor_minimum_out(const tensor_t* a, const tensor_t* b, tensor_t* out)
+{
+    return tensor_binary(a, b, BINARY_MIN, tensor_minimum_backward, out);
+}
+
+tensor_t* tensor_minimum_(tensor_t* a, const tensor_t* b)
+{
+    return tensor_binary_inplace(a, b, BINARY_MIN);
+}
+
+tensor_t* tensor_neg(const tensor_t* x)
+{
+    return tensor_unary(x, UNARY_NEG, tensor_neg_backward, NULL);
+}
+
+tensor_t* tensor_neg_out(const tensor_t* x, tensor_t* out)
+{
+    return tensor_unary(x, UNARY_NEG, tensor_neg_backward, out);
+}
+
+tensor_t* tensor_neg_(tensor_t* x)
+{
+    return tensor_unary_inplace(x, UNARY_NEG);
+}
+
+tensor_t* tensor_abs(const tensor_t* x)
+{
+    return tensor_unary(x, UNARY_ABS, tensor_abs_backward, NULL);
+}
+
+tensor_t* tensor_abs_out(const tensor_t* x, tensor_t* out)
+{
+    return tensor_unary(x, UNARY_ABS, tensor_abs_backward, out);
+}
+
+tensor_t* tensor_abs_(tensor_t* x)
+{
+    return tensor_unary_inplace(x, UNARY_ABS);
+}
+
+tensor_t* tensor_sqrt(const tensor_t* x)
+{
+    return tensor_unary(x, UNARY_SQRT, tensor_sqrt_backward, NULL);
+}
+
+tensor_t* tensor_sqrt_out(const tensor_t* x, tensor_t* out)
+{
+    return tensor_unary(x, UNARY_SQRT, tensor_sqrt_backward, out);
+}
+
+tensor_t* tensor_sqrt_(tensor_t* x)
+{
+    return tensor_unary_inplace(x, UNARY_SQRT);
+}
+
+tensor_t* tensor_exp(const tensor_t* x)
+{
+    return tensor_unary(x, UNARY_EXP, tensor_exp_backward, NULL);
+}
+
+tensor_t* tensor_exp_out(const tensor_t* x, tensor_t* out)
+{
+    return tensor_unary(x, UNARY_EXP, tensor_exp_backward, out);
+}
+
+tensor_t* tensor_exp_(tensor_t* x)
+{
+    return tensor_unary_inplace(x, UNARY_EXP);
+}
+
+tensor_t* tensor_log(const tensor_t* x)
+{
+    return tensor_unary(x, UNARY_LOG, tensor_log_backward, NULL);
+}
+
+tensor_t* tensor_log_out(const tensor_t* x, tensor_t* out)
+{
+    return tensor_unary(x, UNARY_LOG, tensor_log_backward, out);
+}
+
+tensor_t* tensor_log_(tensor_t* x)
+{
+    return tensor_unary_inplace(x, UNARY_LOG);
+}
+
+tensor_t* tensor_tanh(const tensor_t* x)
+{
+    return tensor_unary(x, UNARY_TANH, tensor_tanh_backward, NULL);
+}
+
+tensor_t* tensor_tanh_out(const tensor_t* x, tensor_t* out)
+{
+    return tensor_unary(x, UNARY_TANH, tensor_tanh_backward, out);
+}
+
+tensor_t* tensor_tanh_(tensor_t* x)
+{
+    return tensor_unary_inplace(x, UNARY_TANH);
+}
+
+tensor_t* tensor_sigmoid(const tensor_t* x)
+{
+    return tensor_unary(x, UNARY_SIGMOID, tensor_sigmoid_backward, NULL);
+}
+
+tensor_t* tensor_sigmoid_out(const tensor_t* x, tensor_t* out)
+{
+    return tensor_unary(x, UNARY_SIGMOID, tensor_sigmoid_backward, out);
+}
+
+tensor_t* tensor_sigmoid_(tensor_t* x)
+{
+    return tensor_unary_inplace(x, UNARY_SIGMOID);
+}
+
+tensor_t* tensor_relu(const tensor_t* x)
+{
+    return tensor_unary(x, UNARY_RELU, tensor_relu_backward, NULL);
+}
+
+tensor_t* tensor_relu_out(const tensor_t* x, tensor_t* out)
+{
+    return tensor_unary(x, UNARY_RELU, tensor_relu_backward, out);
+}
+
+tensor_t* tensor_relu_(tensor_t* x)
+{
+    return tensor_unary_inplace(x, UNARY_RELU);
+}
+
 tensor_t* tensor_reshape(const tensor_t* tensor, const size_t* new_shape, size_t new_ndim) 
 {
     if (tensor == NULL || new_shape == NULL)
     {
         return NULL;
     }
-    if (new_ndim == 0)
+    if (new_ndim == 0 || new_ndim > MAX_DIMS)
     {
         return NULL;
     }
 
-    tensor_t *result = tensor_zeros(new_shape, new_ndim);
+    size_t size = 1;
+    size_t stride[MAX_DIMS];
+    for (size_t i = new_ndim; i > 0; --i)
+    {
+        stride[i - 1] = size;
+        size *= new_shape[i - 1];
+    }
+    if (size != tensor->size)
+    {
+        return NULL;
+    }
+
+    if (tensor_is_contiguous(tensor))
+    {
+        return tensor_view_record(tensor_view(tensor, new_shape, stride, new_ndim, 0), tensor);
+    }
+
+    // Strided layouts cannot be reinterpreted in place, so they are gathered into a fresh buffer
+    tensor_t *result = tensor_empty(new_shape, new_ndim);
     if (result == NULL)
     {
         return NULL;
     }
 
-    memcpy(result->data, tensor->data, tensor->size * sizeof(float));
-    memcpy(result->grad, tensor->grad, tensor->size * sizeof(float));
+    cortex_scopy(tensor->ndim, tensor->shape, tensor->data, tensor->stride, result->data);
 
-    result->backward = tensor_reshape_backward;
-    result->grad_a = (tensor_t*)tensor;
+    if (cortex_is_grad_enabled())
+    {
+        result->backward = tensor_reshape_backward;
+        result->grad_a = (tensor_t*)tensor;
+    }
 
     return result;
-}
\ No newline at end of file
+}
+
+// Always gathers into out, so the result never aliases the input even when a view would have been possible
+tensor_t* tensor_reshape_out(const tensor_t* tensor, tensor_t* out)
+{
+    if (tensor == NULL || out == NULL)
+    {
+        return NULL;
+    }
+    if (out->size != tensor->size || tensor->dtype != TENSOR_FLOAT32 || out->dtype != TENSOR_FLOAT32 || !tensor_is_contiguous(out) || tensor_out_aliases(out, tensor, NULL))
+    {
+        return NULL;
+    }
+
+    cortex_scopy(tensor->ndim, tensor->shape, tensor->data, tensor->stride, out->data);
+
+    return tensor_record(out, tensor_reshape_backward, tensor, NULL);
+}
+
+tensor_t* tensor_transpose(const tensor_t* tensor, size_t dim0, size_t dim1)
+{
+    if (tensor == NULL)
+    {
+        return NULL;
+    }
+    if (dim0 >= tensor->ndim || dim1 >= tensor->ndim)
+    {
+        return NULL;
+    }
+
+    size_t shape[MAX_DIMS];
+    size_t stride[MAX_DIMS];
+    memcpy(shape, tensor->shape, sizeof(shape));
+    memcpy(stride, tensor->stride, sizeof(stride));
+
+    shape[dim0] = tensor->shape[dim1];
+    shape[dim1] = tensor->shape[dim0];
+    stride[dim0] = tensor->stride[dim1];
+    stride[dim1] = tensor->stride[dim0];
+
+    return tensor_view_record(tensor_view(tensor, shape, stride, tensor->ndim, 0), tensor);
+}
+
+tensor_t* tensor_permute(const tensor_t* tensor, const size_t* dims)
+{
+    if (tensor == NULL || dims == NULL)
+    {
+        return NULL;
+    }
+
+    size_t shape[MAX_DIMS];
+    size_t stride[MAX_DIMS];
+    bool seen[MAX_DIMS] = {false};
+    for (size_t i = 0; i < tensor->ndim; ++i)
+    {
+        if (dims[i] >= tensor->ndim || seen[dims[i]])
+        {
+            return NULL;
+        }
+        seen[dims[i]] = true;
+        shape[i] = tensor->shape[dims[i]];
+        stride[i] = tensor->stride[dims[i]];
+    }
+
+    return tensor_view_record(tensor_view(tensor, shape, stride, tensor->ndim, 0), tensor);
+}
+
+tensor_t* tensor_narrow(const tensor_t* tensor, size_t dim, size_t start, size_t length)
+{
+    if (tensor == NULL)
+    {
+        return NULL;
+    }
+    if (dim >= tensor->ndim || start > tensor->shape[dim] || length > tensor->shape[dim] - start)
+    {
+        return NULL;
+    }
+
+    size_t shape[MAX_DIMS];
+    memcpy(shape, tensor->shape, sizeof(shape));
+    shape[dim] = length;
+
+    return tensor_view_record(tensor_view(tensor, shape, tensor->stride, tensor->ndim, start * tensor->stride[dim]), tensor);
+}
+
+tensor_t* tensor_expand(const tensor_t* tensor, const size_t* shape, size_t ndim)
+{
+    if (tensor == NULL || shape == NULL)
+    {
+        return NULL;
+    }
+    if (ndim < tensor->ndim || ndim > MAX_DIMS)
+    {
+        return NULL;
+    }
+
+    // Missing and size-one dimensions repeat with a zero stride
+    size_t stride[MAX_DIMS];
+    if (!tensor_broadcast_strides(tensor, shape, ndim, stride))
+    {
+        return NULL;
+    }
+
+    return tensor_view_record(tensor_view(tensor, shape, stride, ndim, 0), tensor);
+}
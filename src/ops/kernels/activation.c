@@ -0,0 +1,164 @@
+#include <math.h>
+#include <pthread.h>
+#include "utils/thread/parallel.h"
+#include "ops/kernels/activation.h"
+
+#define ACTIVATION_GRAIN 16384
+#define ACTIVATION_INLINE static inline __attribute__((always_inline))
+
+// tanh approximation of GELU
+#define GELU_SCALE 0.7978845608f
+#define GELU_CUBIC 0.044715f
+
+typedef void (*activation_row_fn)(activation_t activation, size_t n, const float* bias, float* c, float* z);
+typedef void (*activation_grad_row_fn)(activation_t activation, size_t n, const float* y, const float* z, const float* dy, float* dz);
+
+typedef struct activation_kernels
+{
+    activation_row_fn row;
+    activation_grad_row_fn grad_row;
+} activation_kernels_t;
+
+typedef struct activation_grad_args
+{
+    const activation_kernels_t* kernels;
+    activation_t activation;
+    size_t n;
+    size_t ld;
+    const float* y;
+    const float* z;
+    const float* dy;
+    float* dz;
+} activation_grad_args_t;
+
+static const activation_kernels_t* activation_kernels;
+static pthread_once_t activation_kernels_once = PTHREAD_ONCE_INIT;
+
+#define ACTIVATION_CASE(activation, expr)                       \
+    case activation:                                            \
+        for (size_t j = 0; j < n; ++j)                          \
+        {                                                       \
+            float x = c[j] + (bias ? bias[j] : 0.0f);           \
+            if (z)                                              \
+            {                                                   \
+                z[j] = x;                                       \
+            }                                                   \
+            c[j] = (expr);                                      \
+        }                                                       \
+        break;
+
+#define ACTIVATION_GRAD_CASE(activation, expr)                  \
+    case activation:                                            \
+        for (size_t j = 0; j < n; ++j)                          \
+        {                                                       \
+            float g = dy[j];                                    \
+            dz[j] = (expr);                                     \
+        }                                                       \
+        break;
+
+ACTIVATION_INLINE float gelu_grad(float x)
+{
+    float t = tanhf(GELU_SCALE * (x + GELU_CUBIC * x * x * x));
+    return 0.5f * (1.0f + t) + 0.5f * x * (1.0f - t * t) * GELU_SCALE * (1.0f + 3.0f * GELU_CUBIC * x * x);
+}
+
+ACTIVATION_INLINE void activation_row(activation_t activation, size_t n, const float* bias, float* c, float* z)
+{
+    switch (activation)
+    {
+        ACTIVATION_CASE(ACTIVATION_NONE, x)
+        ACTIVATION_CASE(ACTIVATION_RELU, (x > 0.0f) ? x : 0.0f)
+        ACTIVATION_CASE(ACTIVATION_GELU, 0.5f * x * (1.0f + tanhf(GELU_SCALE * (x + GELU_CUBIC * x * x * x))))
+        ACTIVATION_CASE(ACTIVATION_SIGMOID, 1.0f / (1.0f + expf(-x)))
+        ACTIVATION_CASE(ACTIVATION_TANH, tanhf(x))
+    }
+}
+
+// Every activation but GELU is differentiated from its output, GELU needs the pre-activation
+ACTIVATION_INLINE void activation_grad_row(activation_t activation, size_t n, const float* y, const float* z, const float* dy, float* dz)
+{
+    switch (activation)
+    {
+        ACTIVATION_GRAD_CASE(ACTIVATION_NONE, g)
+        ACTIVATION_GRAD_CASE(ACTIVATION_RELU, (y[j] > 0.0f) ? g : 0.0f)
+        ACTIVATION_GRAD_CASE(ACTIVATION_GELU, g * gelu_grad(z[j]))
+        ACTIVATION_GRAD_CASE(ACTIVATION_SIGMOID, g * y[j] * (1.0f - y[j]))
+        ACTIVATION_GRAD_CASE(ACTIVATION_TANH, g * (1.0f - y[j] * y[j]))
+    }
+}
+
+#define ACTIVATION_DEFINE_KERNELS(isa, attribute)                                                                                   \
+    attribute static void activation_row_##isa(activation_t activation, size_t n, const float* bias, float* c, float* z)            \
+    {                                                                                                                               \
+        activation_row(activation, n, bias, c, z);                                                                                  \
+    }                                                                                                                               \
+    attribute static void activation_grad_row_##isa(activation_t activation, size_t n, const float* y, const float* z,              \
+                                                    const float* dy, float* dz)                                                     \
+    {                                                                                                                               \
+        activation_grad_row(activation, n, y, z, dy, dz);                                                                           \
+    }                                                                                                                               \
+    static const activation_kernels_t activation_kernels_##isa = {activation_row_##isa, activation_grad_row_##isa};
+
+ACTIVATION_DEFINE_KERNELS(scalar, )
+ACTIVATION_DEFINE_KERNELS(avx2, __attribute__((target("avx2,fma"))))
+ACTIVATION_DEFINE_KERNELS(avx512, __attribute__((target("avx512f"))))
+
+static void activation_detect_kernels(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        activation_kernels = &activation_kernels_avx512;
+    }
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        activation_kernels = &activation_kernels_avx2;
+    }
+    else
+    {
+        activation_kernels = &activation_kernels_scalar;
+    }
+}
+
+static const activation_kernels_t* activation_select_kernels(void)
+{
+    pthread_once(&activation_kernels_once, activation_detect_kernels);
+    return activation_kernels;
+}
+
+// Applied to one tile at a time by the GEMM epilogue, so it stays serial and works on whatever is already in cache
+void cortex_sactivation(activation_t activation, size_t m, size_t n, const float* bias, float* c, size_t ldc, float* z, size_t ldz)
+{
+    if (activation == ACTIVATION_NONE && bias == NULL && z == NULL)
+    {
+        return;
+    }
+
+    const activation_kernels_t* kernels = activation_select_kernels();
+    for (size_t i = 0; i < m; ++i)
+    {
+        kernels->row(activation, n, bias, &c[i * ldc], z ? &z[i * ldz] : NULL);
+    }
+}
+
+static void activation_grad_body(void* ctx, size_t begin, size_t end)
+{
+    const activation_grad_args_t* args = (const activation_grad_args_t*)ctx;
+    for (size_t i = begin; i < end; ++i)
+    {
+        size_t row = i * args->ld;
+        args->kernels->grad_row(args->activation, args->n, args->y ? &args->y[row] : NULL, args->z ? &args->z[row] : NULL, &args->dy[row], &args->dz[row]);
+    }
+}
+
+void cortex_sactivation_grad(activation_t activation, size_t m, size_t n, const float* y, const float* z, const float* dy, float* dz, size_t ld)
+{
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+
+    activation_grad_args_t args = {activation_select_kernels(), activation, n, ld, y, z, dy, dz};
+    size_t grain = (ACTIVATION_GRAIN + n - 1) / n;
+    cortex_parallel_for(m, grain, activation_grad_body, &args);
+}
@@ -0,0 +1,825 @@
+#include <math.h>
+#include <string.h>
+#include <pthread.h>
+#include "utils/thread/parallel.h"
+#include "ops/kernels/reduce.h"
+#include "ops/kernels/elementwise.h"
+
+#define ELEMENTWISE_MAX_DIMS 4
+#define ELEMENTWISE_MAX_OPERANDS 2
+#define ELEMENTWISE_GRAIN 16384
+#define ELEMENTWISE_TILE 64
+#define ELEMENTWISE_INLINE static inline __attribute__((always_inline))
+
+typedef void (*binary_run_fn)(binary_op_t op, size_t n, const float* a, size_t sa, const float* b, size_t sb, float* y);
+typedef void (*binary_grad_run_fn)(binary_op_t op, bool wrt_b, size_t n, const float* a, size_t sa, const float* b, size_t sb, const float* y, const float* dy, float* dx);
+typedef void (*unary_run_fn)(unary_op_t op, size_t n, const float* x, size_t sx, float* y);
+typedef void (*unary_grad_run_fn)(unary_op_t op, size_t n, const float* x, size_t sx, const float* y, const float* dy, float* dx);
+typedef void (*copy_run_fn)(size_t n, const float* x, size_t sx, float* y);
+typedef void (*accumulate_run_fn)(size_t n, const float* x, float* y, size_t sy);
+typedef float (*sum_run_fn)(size_t n, const float* x, size_t sx);
+typedef void (*fill_run_fn)(size_t n, float value, float* y);
+typedef void (*scale_run_fn)(size_t n, float alpha, float* y);
+
+typedef struct elementwise_kernels
+{
+    binary_run_fn binary;
+    binary_grad_run_fn binary_grad;
+    unary_run_fn unary;
+    unary_grad_run_fn unary_grad;
+    copy_run_fn copy;
+    accumulate_run_fn accumulate;
+    sum_run_fn sum;
+    fill_run_fn fill;
+    scale_run_fn scale;
+} elementwise_kernels_t;
+
+// Shape and per-operand strides after dropping unit dimensions and merging dimensions that are contiguous for every operand
+typedef struct elementwise_plan
+{
+    size_t ndim;
+    size_t size;
+    size_t shape[ELEMENTWISE_MAX_DIMS];
+    size_t stride[ELEMENTWISE_MAX_OPERANDS][ELEMENTWISE_MAX_DIMS];
+} elementwise_plan_t;
+
+typedef enum elementwise_kind
+{
+    ELEMENTWISE_BINARY,
+    ELEMENTWISE_BINARY_GRAD,
+    ELEMENTWISE_UNARY,
+    ELEMENTWISE_UNARY_GRAD,
+    ELEMENTWISE_COPY
+} elementwise_kind_t;
+
+typedef struct elementwise_args
+{
+    const elementwise_kernels_t* kernels;
+    elementwise_plan_t plan;
+    elementwise_kind_t kind;
+    binary_op_t binary_op;
+    unary_op_t unary_op;
+    bool wrt_b;
+    bool transposed[ELEMENTWISE_MAX_OPERANDS];
+    const float* x[ELEMENTWISE_MAX_OPERANDS];
+    const float* y;
+    const float* dy;
+    float* out;
+} elementwise_args_t;
+
+typedef struct accumulate_args
+{
+    const elementwise_kernels_t* kernels;
+    elementwise_plan_t kept;
+    elementwise_plan_t reduced;
+    const float* x;
+    float* y;
+} accumulate_args_t;
+
+typedef struct fill_args
+{
+    const elementwise_kernels_t* kernels;
+    float value;
+    float* y;
+} fill_args_t;
+
+static const elementwise_kernels_t* elementwise_kernels;
+static pthread_once_t elementwise_kernels_once = PTHREAD_ONCE_INIT;
+
+#define BINARY_CASE(op, expr)                   \
+    case op:                                    \
+        for (size_t i = 0; i < n; ++i)          \
+        {                                       \
+            float av = a[i * sa];               \
+            float bv = b[i * sb];               \
+            y[i] = (expr);                      \
+        }                                       \
+        break;
+
+#define BINARY_GRAD_CASE(op, expr_a, expr_b)    \
+    case op:                                    \
+        for (size_t i = 0; i < n; ++i)          \
+        {                                       \
+            float av = a[i * sa];               \
+            float bv = b[i * sb];               \
+            float yv = y[i];                    \
+            float g = dy[i];                    \
+            (void)av, (void)bv, (void)yv;       \
+            dx[i] = wrt_b ? (expr_b) : (expr_a);\
+        }                                       \
+        break;
+
+#define UNARY_CASE(op, expr)                    \
+    case op:                                    \
+        for (size_t i = 0; i < n; ++i)          \
+        {                                       \
+            float xv = x[i * sx];               \
+            y[i] = (expr);                      \
+        }                                       \
+        break;
+
+#define UNARY_GRAD_CASE(op, expr)               \
+    case op:                                    \
+        for (size_t i = 0; i < n; ++i)          \
+        {                                       \
+            float xv = x[i * sx];               \
+            float yv = y[i];                    \
+            float g = dy[i];                    \
+            (void)xv, (void)yv;                 \
+            dx[i] = (expr);                     \
+        }                                       \
+        break;
+
+ELEMENTWISE_INLINE void binary_loop(binary_op_t op, size_t n, const float* a, size_t sa, const float* b, size_t sb, float* y)
+{
+    switch (op)
+    {
+        BINARY_CASE(BINARY_ADD, av + bv)
+        BINARY_CASE(BINARY_SUB, av - bv)
+        BINARY_CASE(BINARY_MUL, av * bv)
+        BINARY_CASE(BINARY_DIV, av / bv)
+        BINARY_CASE(BINARY_MAX, (av >= bv) ? av : bv)
+        BINARY_CASE(BINARY_MIN, (av <= bv) ? av : bv)
+    }
+}
+
+// Ties in max and min send the whole gradient to a, matching the forward selection
+ELEMENTWISE_INLINE void binary_grad_loop(binary_op_t op, bool wrt_b, size_t n, const float* a, size_t sa, const float* b, size_t sb, const float* y, const float* dy, float* dx)
+{
+    switch (op)
+    {
+        BINARY_GRAD_CASE(BINARY_ADD, g, g)
+        BINARY_GRAD_CASE(BINARY_SUB, g, -g)
+        BINARY_GRAD_CASE(BINARY_MUL, g * bv, g * av)
+        BINARY_GRAD_CASE(BINARY_DIV, g / bv, -g * yv / bv)
+        BINARY_GRAD_CASE(BINARY_MAX, (av >= bv) ? g : 0.0f, (av >= bv) ? 0.0f : g)
+        BINARY_GRAD_CASE(BINARY_MIN, (av <= bv) ? g : 0.0f, (av <= bv) ? 0.0f : g)
+    }
+}
+
+ELEMENTWISE_INLINE void unary_loop(unary_op_t op, size_t n, const float* x, size_t sx, float* y)
+{
+    switch (op)
+    {
+        UNARY_CASE(UNARY_NEG, -xv)
+        UNARY_CASE(UNARY_ABS, fabsf(xv))
+        UNARY_CASE(UNARY_SQRT, sqrtf(xv))
+        UNARY_CASE(UNARY_EXP, expf(xv))
+        UNARY_CASE(UNARY_LOG, logf(xv))
+        UNARY_CASE(UNARY_TANH, tanhf(xv))
+        UNARY_CASE(UNARY_SIGMOID, 1.0f / (1.0f + expf(-xv)))
+        UNARY_CASE(UNARY_RELU, (xv > 0.0f) ? xv : 0.0f)
+    }
+}
+
+ELEMENTWISE_INLINE void unary_grad_loop(unary_op_t op, size_t n, const float* x, size_t sx, const float* y, const float* dy, float* dx)
+{
+    switch (op)
+    {
+        UNARY_GRAD_CASE(UNARY_NEG, -g)
+        UNARY_GRAD_CASE(UNARY_ABS, (xv > 0.0f) ? g : (xv < 0.0f) ? -g : 0.0f)
+        UNARY_GRAD_CASE(UNARY_SQRT, 0.5f * g / yv)
+        UNARY_GRAD_CASE(UNARY_EXP, g * yv)
+        UNARY_GRAD_CASE(UNARY_LOG, g / xv)
+        UNARY_GRAD_CASE(UNARY_TANH, g * (1.0f - yv * yv))
+        UNARY_GRAD_CASE(UNARY_SIGMOID, g * yv * (1.0f - yv))
+        UNARY_GRAD_CASE(UNARY_RELU, (xv > 0.0f) ? g : 0.0f)
+    }
+}
+
+// Unit and zero strides are spelled out as constants so the inlined loops vectorize
+ELEMENTWISE_INLINE void binary_run(binary_op_t op, size_t n, const float* a, size_t sa, const float* b, size_t sb, float* y)
+{
+    if (sa == 1 && sb == 1)
+    {
+        binary_loop(op, n, a, 1, b, 1, y);
+    }
+    else if (sa == 1 && sb == 0)
+    {
+        binary_loop(op, n, a, 1, b, 0, y);
+    }
+    else if (sa == 0 && sb == 1)
+    {
+        binary_loop(op, n, a, 0, b, 1, y);
+    }
+    else
+    {
+        binary_loop(op, n, a, sa, b, sb, y);
+    }
+}
+
+ELEMENTWISE_INLINE void binary_grad_run(binary_op_t op, bool wrt_b, size_t n, const float* a, size_t sa, const float* b, size_t sb, const float* y, const float* dy, float* dx)
+{
+    if (sa == 1 && sb == 1)
+    {
+        binary_grad_loop(op, wrt_b, n, a, 1, b, 1, y, dy, dx);
+    }
+    else if (sa == 1 && sb == 0)
+    {
+        binary_grad_loop(op, wrt_b, n, a, 1, b, 0, y, dy, dx);
+    }
+    else if (sa == 0 && sb == 1)
+    {
+        binary_grad_loop(op, wrt_b, n, a, 0, b, 1, y, dy, dx);
+    }
+    else
+    {
+        binary_grad_loop(op, wrt_b, n, a, sa, b, sb, y, dy, dx);
+    }
+}
+
+ELEMENTWISE_INLINE void unary_run(unary_op_t op, size_t n, const float* x, size_t sx, float* y)
+{
+    if (sx == 1)
+    {
+        unary_loop(op, n, x, 1, y);
+    }
+    else
+    {
+        unary_loop(op, n, x, sx, y);
+    }
+}
+
+ELEMENTWISE_INLINE void unary_grad_run(unary_op_t op, size_t n, const float* x, size_t sx, const float* y, const float* dy, float* dx)
+{
+    if (sx == 1)
+    {
+        unary_grad_loop(op, n, x, 1, y, dy, dx);
+    }
+    else
+    {
+        unary_grad_loop(op, n, x, sx, y, dy, dx);
+    }
+}
+
+ELEMENTWISE_INLINE void copy_run(size_t n, const float* x, size_t sx, float* y)
+{
+    if (sx == 1)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            y[i] = x[i];
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            y[i] = x[i * sx];
+        }
+    }
+}
+
+ELEMENTWISE_INLINE void accumulate_run(size_t n, const float* x, float* y, size_t sy)
+{
+    if (sy == 1)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            y[i] += x[i];
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            y[i * sy] += x[i];
+        }
+    }
+}
+
+ELEMENTWISE_INLINE float sum_run(size_t n, const float* x, size_t sx)
+{
+    float sum = 0.0f;
+    if (sx == 1)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            sum += x[i];
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            sum += x[i * sx];
+        }
+    }
+    return sum;
+}
+
+// glibc's memset is dispatched per ISA already and switches to streaming stores on buffers larger than the cache
+ELEMENTWISE_INLINE void fill_run(size_t n, float value, float* y)
+{
+    if (value == 0.0f)
+    {
+        memset(y, 0, n * sizeof(float));
+        return;
+    }
+    for (size_t i = 0; i < n; ++i)
+    {
+        y[i] = value;
+    }
+}
+
+ELEMENTWISE_INLINE void scale_run(size_t n, float alpha, float* y)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        y[i] *= alpha;
+    }
+}
+
+#define ELEMENTWISE_DEFINE_KERNELS(isa, attribute)                                                                                              \
+    attribute static void binary_run_##isa(binary_op_t op, size_t n, const float* a, size_t sa, const float* b, size_t sb, float* y)            \
+    {                                                                                                                                           \
+        binary_run(op, n, a, sa, b, sb, y);                                                                                                     \
+    }                                                                                                                                           \
+    attribute static void binary_grad_run_##isa(binary_op_t op, bool wrt_b, size_t n, const float* a, size_t sa, const float* b, size_t sb,     \
+                                                const float* y, const float* dy, float* dx)                                                     \
+    {                                                                                                                                           \
+        binary_grad_run(op, wrt_b, n, a, sa, b, sb, y, dy, dx);                                                                                 \
+    }                                                                                                                                           \
+    attribute static void unary_run_##isa(unary_op_t op, size_t n, const float* x, size_t sx, float* y)                                         \
+    {                                                                                                                                           \
+        unary_run(op, n, x, sx, y);                                                                                                             \
+    }                                                                                                                                           \
+    attribute static void unary_grad_run_##isa(unary_op_t op, size_t n, const float* x, size_t sx, const float* y, const float* dy, float* dx)  \
+    {                                                                                                                                           \
+        unary_grad_run(op, n, x, sx, y, dy, dx);                                                                                                \
+    }                                                                                                                                           \
+    attribute static void copy_run_##isa(size_t n, const float* x, size_t sx, float* y)                                                         \
+    {                                                                                                                                           \
+        copy_run(n, x, sx, y);                                                                                                                  \
+    }                                                                                                                                           \
+    attribute static void accumulate_run_##isa(size_t n, const float* x, float* y, size_t sy)                                                   \
+    {                                                                                                                                           \
+        accumulate_run(n, x, y, sy);                                                                                                            \
+    }                                                                                                                                           \
+    attribute static float sum_run_##isa(size_t n, const float* x, size_t sx)                                                                   \
+    {                                                                                                                                           \
+        return sum_run(n, x, sx);                                                                                                               \
+    }                                                                                                                                           \
+    attribute static void fill_run_##isa(size_t n, float value, float* y)                                                                       \
+    {                                                                                                                                           \
+        fill_run(n, value, y);                                                                                                                  \
+    }                                                                                                                                           \
+    attribute static void scale_run_##isa(size_t n, float alpha, float* y)                                                                      \
+    {                                                                                                                                           \
+        scale_run(n, alpha, y);                                                                                                                 \
+    }                                                                                                                                           \
+    static const elementwise_kernels_t elementwise_kernels_##isa = {                                                                            \
+        binary_run_##isa, binary_grad_run_##isa, unary_run_##isa, unary_grad_run_##isa, copy_run_##isa, accumulate_run_##isa, sum_run_##isa,    \
+        fill_run_##isa, scale_run_##isa                                                                                                         \
+    };
+
+ELEMENTWISE_DEFINE_KERNELS(scalar, )
+ELEMENTWISE_DEFINE_KERNELS(avx2, __attribute__((target("avx2,fma"))))
+ELEMENTWISE_DEFINE_KERNELS(avx512, __attribute__((target("avx512f"))))
+
+static void elementwise_detect_kernels(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        elementwise_kernels = &elementwise_kernels_avx512;
+    }
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        elementwise_kernels = &elementwise_kernels_avx2;
+    }
+    else
+    {
+        elementwise_kernels = &elementwise_kernels_scalar;
+    }
+}
+
+static const elementwise_kernels_t* elementwise_select_kernels(void)
+{
+    pthread_once(&elementwise_kernels_once, elementwise_detect_kernels);
+    return elementwise_kernels;
+}
+
+// A NULL stride stands for the contiguous layout of shape
+static void plan_init(elementwise_plan_t* plan, size_t ndim, const size_t* shape, size_t num_operands, const size_t* const* strides)
+{
+    size_t contiguous[ELEMENTWISE_MAX_DIMS];
+    size_t size = 1;
+    for (size_t d = ndim; d > 0; --d)
+    {
+        contiguous[d - 1] = size;
+        size *= shape[d - 1];
+    }
+
+    plan->ndim = 0;
+    plan->size = size;
+    for (size_t d = 0; d < ndim; ++d)
+    {
+        if (shape[d] == 1)
+        {
+            continue;
+        }
+
+        size_t p = plan->ndim;
+        bool merge = (p > 0);
+        for (size_t k = 0; k < num_operands; ++k)
+        {
+            size_t stride = strides[k] ? strides[k][d] : contiguous[d];
+            merge = merge && plan->stride[k][p - 1] == stride * shape[d];
+        }
+
+        if (merge)
+        {
+            plan->shape[p - 1] *= shape[d];
+        }
+        else
+        {
+            plan->shape[p] = shape[d];
+            plan->ndim++;
+        }
+        for (size_t k = 0; k < num_operands; ++k)
+        {
+            plan->stride[k][plan->ndim - 1] = strides[k] ? strides[k][d] : contiguous[d];
+        }
+    }
+
+    if (plan->ndim == 0)
+    {
+        plan->ndim = 1;
+        plan->shape[0] = 1;
+        for (size_t k = 0; k < num_operands; ++k)
+        {
+            plan->stride[k][0] = 0;
+        }
+    }
+}
+
+static void plan_offsets(const elementwise_plan_t* plan, size_t index, size_t num_operands, size_t* offsets)
+{
+    for (size_t k = 0; k < num_operands; ++k)
+    {
+        offsets[k] = 0;
+    }
+    for (size_t d = plan->ndim; d > 0; --d)
+    {
+        size_t coord = index % plan->shape[d - 1];
+        index /= plan->shape[d - 1];
+        for (size_t k = 0; k < num_operands; ++k)
+        {
+            offsets[k] += coord * plan->stride[k][d - 1];
+        }
+    }
+}
+
+// Runs count output elements starting at output index i
+static void elementwise_apply(const elementwise_args_t* args, size_t count, const float* x0, size_t s0, const float* x1, size_t s1, size_t i)
+{
+    const elementwise_kernels_t* kernels = args->kernels;
+    switch (args->kind)
+    {
+        case ELEMENTWISE_BINARY:
+            kernels->binary(args->binary_op, count, x0, s0, x1, s1, args->out + i);
+            break;
+        case ELEMENTWISE_BINARY_GRAD:
+            kernels->binary_grad(args->binary_op, args->wrt_b, count, x0, s0, x1, s1, args->y + i, args->dy + i, args->out + i);
+            break;
+        case ELEMENTWISE_UNARY:
+            kernels->unary(args->unary_op, count, x0, s0, args->out + i);
+            break;
+        case ELEMENTWISE_UNARY_GRAD:
+            kernels->unary_grad(args->unary_op, count, x0, s0, args->y + i, args->dy + i, args->out + i);
+            break;
+        case ELEMENTWISE_COPY:
+            kernels->copy(count, x0, s0, args->out + i);
+            break;
+    }
+}
+
+// Work is split by output element and handed to the kernels as runs along the innermost collapsed dimension
+static void elementwise_body(void* ctx, size_t begin, size_t end)
+{
+    const elementwise_args_t* args = (const elementwise_args_t*)ctx;
+    const elementwise_plan_t* plan = &args->plan;
+
+    size_t last = plan->ndim - 1;
+    size_t inner = plan->shape[last];
+    size_t s0 = plan->stride[0][last];
+    size_t s1 = plan->stride[1][last];
+
+    for (size_t i = begin; i < end;)
+    {
+        size_t count = inner - i % inner;
+        count = (count < end - i) ? count : end - i;
+
+        size_t offsets[ELEMENTWISE_MAX_OPERANDS];
+        plan_offsets(plan, i, ELEMENTWISE_MAX_OPERANDS, offsets);
+        elementwise_apply(args, count, args->x[0] + offsets[0], s0, args->x[1] + offsets[1], s1, i);
+        i += count;
+    }
+}
+
+// The source lines of a tile stay in L1 after its first row, so reading across them lets every row be written contiguously
+static void elementwise_transpose_tile(size_t rows, size_t cols, const float* x, size_t sx, float* y, size_t ldy)
+{
+    for (size_t r = 0; r < rows; ++r)
+    {
+        for (size_t c = 0; c < cols; ++c)
+        {
+            y[r * ldy + c] = x[r + c * sx];
+        }
+    }
+}
+
+// Transposed operands would touch a new cache line per element, so work is split into tiles over the two innermost
+// dimensions and each transposed operand is copied into an L1 sized tile first, the kernels then see unit strides
+static void elementwise_tiled_body(void* ctx, size_t begin, size_t end)
+{
+    const elementwise_args_t* args = (const elementwise_args_t*)ctx;
+    const elementwise_plan_t* plan = &args->plan;
+
+    size_t last = plan->ndim - 1;
+    size_t rows = plan->shape[last - 1];
+    size_t cols = plan->shape[last];
+    size_t row_tiles = (rows + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+    size_t col_tiles = (cols + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+    float tiles[ELEMENTWISE_MAX_OPERANDS][ELEMENTWISE_TILE * ELEMENTWISE_TILE] __attribute__((aligned(64)));
+
+    for (size_t t = begin; t < end; ++t)
+    {
+        size_t outer = t / (row_tiles * col_tiles);
+        size_t r0 = (t / col_tiles) % row_tiles * ELEMENTWISE_TILE;
+        size_t c0 = t % col_tiles * ELEMENTWISE_TILE;
+        size_t num_rows = (rows - r0 < ELEMENTWISE_TILE) ? rows - r0 : ELEMENTWISE_TILE;
+        size_t num_cols = (cols - c0 < ELEMENTWISE_TILE) ? cols - c0 : ELEMENTWISE_TILE;
+        size_t index = (outer * rows + r0) * cols + c0;
+
+        size_t offsets[ELEMENTWISE_MAX_OPERANDS];
+        plan_offsets(plan, index, ELEMENTWISE_MAX_OPERANDS, offsets);
+
+        // A copy only has the one transposed operand and goes straight into the output
+        if (args->kind == ELEMENTWISE_COPY)
+        {
+            elementwise_transpose_tile(num_rows, num_cols, args->x[0] + offsets[0], plan->stride[0][last], args->out + index, cols);
+            continue;
+        }
+
+        const float* x[ELEMENTWISE_MAX_OPERANDS];
+        size_t col_stride[ELEMENTWISE_MAX_OPERANDS];
+        size_t row_stride[ELEMENTWISE_MAX_OPERANDS];
+        for (size_t k = 0; k < ELEMENTWISE_MAX_OPERANDS; ++k)
+        {
+            x[k] = args->x[k] + offsets[k];
+            col_stride[k] = plan->stride[k][last];
+            row_stride[k] = plan->stride[k][last - 1];
+            if (args->transposed[k])
+            {
+                elementwise_transpose_tile(num_rows, num_cols, x[k], col_stride[k], tiles[k], ELEMENTWISE_TILE);
+                x[k] = tiles[k];
+                col_stride[k] = 1;
+                row_stride[k] = ELEMENTWISE_TILE;
+            }
+        }
+
+        for (size_t r = 0; r < num_rows; ++r)
+        {
+            elementwise_apply(args, num_cols, x[0] + r * row_stride[0], col_stride[0], x[1] + r * row_stride[1], col_stride[1], index + r * cols);
+        }
+    }
+}
+
+static void elementwise_run(elementwise_args_t* args, size_t ndim, const size_t* shape, const size_t* stride0, const size_t* stride1)
+{
+    const size_t* strides[ELEMENTWISE_MAX_OPERANDS] = {stride0, stride1};
+    plan_init(&args->plan, ndim, shape, ELEMENTWISE_MAX_OPERANDS, strides);
+    if (args->plan.size == 0)
+    {
+        return;
+    }
+
+    // Unary kinds leave the second operand unused, it is pointed at the first so offsets stay in bounds
+    if (args->x[1] == NULL)
+    {
+        args->x[1] = args->x[0];
+    }
+    args->kernels = elementwise_select_kernels();
+
+    // An operand is transposed when it strides along the innermost dimension but is contiguous along the next one out
+    const elementwise_plan_t* plan = &args->plan;
+    size_t last = plan->ndim - 1;
+    size_t num_operands = (args->kind == ELEMENTWISE_BINARY || args->kind == ELEMENTWISE_BINARY_GRAD) ? 2 : 1;
+    bool tiled = false;
+    for (size_t k = 0; k < ELEMENTWISE_MAX_OPERANDS; ++k)
+    {
+        args->transposed[k] = k < num_operands && plan->ndim >= 2 && plan->stride[k][last] > 1 && plan->stride[k][last - 1] == 1;
+        tiled = tiled || args->transposed[k];
+    }
+
+    if (tiled)
+    {
+        size_t row_tiles = (plan->shape[last - 1] + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+        size_t col_tiles = (plan->shape[last] + ELEMENTWISE_TILE - 1) / ELEMENTWISE_TILE;
+        size_t num_tiles = plan->size / (plan->shape[last - 1] * plan->shape[last]) * row_tiles * col_tiles;
+        cortex_parallel_for(num_tiles, ELEMENTWISE_GRAIN / (ELEMENTWISE_TILE * ELEMENTWISE_TILE), elementwise_tiled_body, args);
+        return;
+    }
+    cortex_parallel_for(args->plan.size, ELEMENTWISE_GRAIN, elementwise_body, args);
+}
+
+void cortex_sbinary(binary_op_t op, size_t ndim, const size_t* shape, const float* a, const size_t* a_stride, const float* b, const size_t* b_stride, float* y)
+{
+    if (ndim > ELEMENTWISE_MAX_DIMS)
+    {
+        return;
+    }
+    elementwise_args_t args = {.kind = ELEMENTWISE_BINARY, .binary_op = op, .x = {a, b}, .out = y};
+    elementwise_run(&args, ndim, shape, a_stride, b_stride);
+}
+
+void cortex_sbinary_grad(binary_op_t op, bool wrt_b, size_t ndim, const size_t* shape, const float* a, const size_t* a_stride, const float* b, const size_t* b_stride, const float* y, const float* dy, float* dx)
+{
+    if (ndim > ELEMENTWISE_MAX_DIMS)
+    {
+        return;
+    }
+    elementwise_args_t args = {.kind = ELEMENTWISE_BINARY_GRAD, .binary_op = op, .wrt_b = wrt_b, .x = {a, b}, .y = y, .dy = dy, .out = dx};
+    elementwise_run(&args, ndim, shape, a_stride, b_stride);
+}
+
+void cortex_sunary(unary_op_t op, size_t ndim, const size_t* shape, const float* x, const size_t* x_stride, float* y)
+{
+    if (ndim > ELEMENTWISE_MAX_DIMS)
+    {
+        return;
+    }
+    elementwise_args_t args = {.kind = ELEMENTWISE_UNARY, .unary_op = op, .x = {x, NULL}, .out = y};
+    elementwise_run(&args, ndim, shape, x_stride, x_stride);
+}
+
+void cortex_sunary_grad(unary_op_t op, size_t ndim, const size_t* shape, const float* x, const size_t* x_stride, const float* y, const float* dy, float* dx)
+{
+    if (ndim > ELEMENTWISE_MAX_DIMS)
+    {
+        return;
+    }
+    elementwise_args_t args = {.kind = ELEMENTWISE_UNARY_GRAD, .unary_op = op, .x = {x, NULL}, .y = y, .dy = dy, .out = dx};
+    elementwise_run(&args, ndim, shape, x_stride, x_stride);
+}
+
+void cortex_scopy(size_t ndim, const size_t* shape, const float* x, const size_t* x_stride, float* y)
+{
+    if (ndim > ELEMENTWISE_MAX_DIMS)
+    {
+        return;
+    }
+    elementwise_args_t args = {.kind = ELEMENTWISE_COPY, .x = {x, NULL}, .out = y};
+    elementwise_run(&args, ndim, shape, x_stride, x_stride);
+}
+
+static void accumulate_body(void* ctx, size_t begin, size_t end)
+{
+    const accumulate_args_t* args = (const accumulate_args_t*)ctx;
+    const elementwise_plan_t* plan = &args->kept;
+    const elementwise_kernels_t* kernels = args->kernels;
+
+    size_t last = plan->ndim - 1;
+    size_t inner = plan->shape[last];
+    size_t sy = plan->stride[0][last];
+
+    for (size_t i = begin; i < end;)
+    {
+        size_t count = inner - i % inner;
+        count = (count < end - i) ? count : end - i;
+
+        size_t offsets[ELEMENTWISE_MAX_OPERANDS];
+        plan_offsets(plan, i, ELEMENTWISE_MAX_OPERANDS, offsets);
+        kernels->accumulate(count, args->x + offsets[1], args->y + offsets[0], sy);
+        i += count;
+    }
+}
+
+// Every kept element owns its output slot and sums its whole broadcast fiber, so no two threads write the same slot
+static void reduce_body(void* ctx, size_t begin, size_t end)
+{
+    const accumulate_args_t* args = (const accumulate_args_t*)ctx;
+    const elementwise_plan_t* kept = &args->kept;
+    const elementwise_plan_t* reduced = &args->reduced;
+    const elementwise_kernels_t* kernels = args->kernels;
+
+    size_t last = reduced->ndim - 1;
+    size_t inner = reduced->shape[last];
+    size_t sx = reduced->stride[1][last];
+
+    for (size_t k = begin; k < end; ++k)
+    {
+        size_t offsets[ELEMENTWISE_MAX_OPERANDS];
+        plan_offsets(kept, k, ELEMENTWISE_MAX_OPERANDS, offsets);
+
+        float sum = 0.0f;
+        for (size_t r = 0; r < reduced->size; r += inner)
+        {
+            size_t fiber[ELEMENTWISE_MAX_OPERANDS];
+            plan_offsets(reduced, r, ELEMENTWISE_MAX_OPERANDS, fiber);
+            sum += kernels->sum(inner, args->x + offsets[1] + fiber[1], sx);
+        }
+        args->y[offsets[0]] += sum;
+    }
+}
+
+static void plan_split(const elementwise_plan_t* plan, bool want_reduced, elementwise_plan_t* part)
+{
+    part->ndim = 0;
+    part->size = 1;
+    for (size_t d = 0; d < plan->ndim; ++d)
+    {
+        bool is_reduced = (plan->stride[0][d] == 0 && plan->shape[d] > 1);
+        if (is_reduced != want_reduced)
+        {
+            continue;
+        }
+        part->shape[part->ndim] = plan->shape[d];
+        part->stride[0][part->ndim] = plan->stride[0][d];
+        part->stride[1][part->ndim] = plan->stride[1][d];
+        part->size *= plan->shape[d];
+        part->ndim++;
+    }
+    if (part->ndim == 0)
+    {
+        part->ndim = 1;
+        part->shape[0] = 1;
+        part->stride[0][0] = 0;
+        part->stride[1][0] = 0;
+    }
+}
+
+void cortex_saccumulate(size_t ndim, const size_t* shape, const float* x, float* y, const size_t* y_stride)
+{
+    if (ndim > ELEMENTWISE_MAX_DIMS)
+    {
+        return;
+    }
+
+    accumulate_args_t args;
+    elementwise_plan_t plan;
+    const size_t* strides[ELEMENTWISE_MAX_OPERANDS] = {y_stride, NULL};
+    plan_init(&plan, ndim, shape, ELEMENTWISE_MAX_OPERANDS, strides);
+    if (plan.size == 0)
+    {
+        return;
+    }
+
+    args.kernels = elementwise_select_kernels();
+    args.x = x;
+    args.y = y;
+    plan_split(&plan, false, &args.kept);
+    plan_split(&plan, true, &args.reduced);
+
+    if (args.reduced.size == 1)
+    {
+        cortex_parallel_for(args.kept.size, ELEMENTWISE_GRAIN, accumulate_body, &args);
+        return;
+    }
+
+    // Leading broadcast rows over a contiguous row is the bias-gradient shape, the column sum kernel handles it best
+    if (plan.ndim == 2 && plan.stride[0][0] == 0 && plan.stride[0][1] == 1)
+    {
+        cortex_scolsum(plan.shape[0], plan.shape[1], x, plan.stride[1][0], y);
+        return;
+    }
+
+    size_t grain = (ELEMENTWISE_GRAIN + args.reduced.size - 1) / args.reduced.size;
+    cortex_parallel_for(args.kept.size, grain, reduce_body, &args);
+}
+
+static void fill_body(void* ctx, size_t begin, size_t end)
+{
+    const fill_args_t* args = (const fill_args_t*)ctx;
+    args->kernels->fill(end - begin, args->value, args->y + begin);
+}
+
+static void scale_body(void* ctx, size_t begin, size_t end)
+{
+    const fill_args_t* args = (const fill_args_t*)ctx;
+    args->kernels->scale(end - begin, args->value, args->y + begin);
+}
+
+void cortex_sfill(size_t n, float value, float* y)
+{
+    fill_args_t args = {elementwise_select_kernels(), value, y};
+    cortex_parallel_for(n, ELEMENTWISE_GRAIN, fill_body, &args);
+}
+
+// Scaling by zero is a fill, so NaN or Inf left in y does not survive it
+void cortex_sscal(size_t n, float alpha, float* y)
+{
+    if (alpha == 0.0f)
+    {
+        cortex_sfill(n, 0.0f, y);
+        return;
+    }
+    if (alpha == 1.0f)
+    {
+        return;
+    }
+    fill_args_t args = {elementwise_select_kernels(), alpha, y};
+    cortex_parallel_for(n, ELEMENTWISE_GRAIN, scale_body, &args);
+}
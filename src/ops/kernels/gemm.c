@@ -0,0 +1,633 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <immintrin.h>
+#include "utils/thread/parallel.h"
+#include "ops/kernels/gemm.h"
+
+#define GEMM_MR 6
+#define GEMM_NR_MAX 32
+#define GEMM_MC 120
+#define GEMM_KC 256
+#define GEMM_NC 3072
+#define GEMM_PARALLEL_MIN_FLOPS (1 << 21)
+#define GEMM_GEMV_MAX_ROWS 16
+#define GEMM_GEMV_BLOCK_BYTES (128 * 1024)
+#define GEMM_DOT_ROWS 4
+
+typedef void (*sgemm_kernel_fn)(size_t k, const float* a, const float* b, float* c, size_t ldc, bool accumulate);
+typedef void (*sgemm_dot_fn)(size_t k, const float* a, const float* b, size_t ldb, size_t rows, float* out);
+
+typedef struct sgemm_kernel
+{
+    size_t nr;
+    sgemm_kernel_fn fn;
+    sgemm_dot_fn dot;
+} sgemm_kernel_t;
+
+typedef struct sgemm_workspace
+{
+    float* data;
+    size_t capacity;
+} sgemm_workspace_t;
+
+typedef struct sgemm_args
+{
+    bool trans_a;
+    bool trans_b;
+    size_t m;
+    size_t n;
+    size_t k;
+    float alpha;
+    const float* a;
+    size_t lda;
+    const float* b;
+    size_t ldb;
+    bool overwrite;
+    float* c;
+    size_t ldc;
+    const sgemm_epilogue_t* epilogue;
+    bool split_rows;
+    size_t tile;
+} sgemm_args_t;
+
+typedef struct sgemv_args
+{
+    sgemm_dot_fn dot;
+    size_t m;
+    size_t n;
+    size_t k;
+    float alpha;
+    const float* a;
+    size_t lda;
+    const float* b;
+    size_t ldb;
+    bool overwrite;
+    float* c;
+    size_t ldc;
+    const sgemm_epilogue_t* epilogue;
+    size_t block;
+} sgemv_args_t;
+
+static sgemm_kernel_t sgemm_kernel;
+static pthread_once_t sgemm_kernel_once = PTHREAD_ONCE_INIT;
+static pthread_key_t sgemm_workspace_key;
+static pthread_once_t sgemm_workspace_once = PTHREAD_ONCE_INIT;
+
+static void sgemm_kernel_scalar(size_t k, const float* a, const float* b, float* c, size_t ldc, bool accumulate)
+{
+    float acc[GEMM_MR][16] = {{0}};
+
+    for (size_t p = 0; p < k; ++p)
+    {
+        for (size_t i = 0; i < GEMM_MR; ++i)
+        {
+            float a_value = a[i];
+            for (size_t j = 0; j < 16; ++j)
+            {
+                acc[i][j] += a_value * b[j];
+            }
+        }
+        a += GEMM_MR;
+        b += 16;
+    }
+
+    for (size_t i = 0; i < GEMM_MR; ++i)
+    {
+        for (size_t j = 0; j < 16; ++j)
+        {
+            c[i * ldc + j] = accumulate ? c[i * ldc + j] + acc[i][j] : acc[i][j];
+        }
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void sgemm_kernel_avx2(size_t k, const float* a, const float* b, float* c, size_t ldc, bool accumulate)
+{
+    __m256 acc[GEMM_MR][2];
+    for (size_t i = 0; i < GEMM_MR; ++i)
+    {
+        acc[i][0] = _mm256_setzero_ps();
+        acc[i][1] = _mm256_setzero_ps();
+    }
+
+    for (size_t p = 0; p < k; ++p)
+    {
+        __m256 b0 = _mm256_loadu_ps(b);
+        __m256 b1 = _mm256_loadu_ps(b + 8);
+        for (size_t i = 0; i < GEMM_MR; ++i)
+        {
+            __m256 a_value = _mm256_broadcast_ss(a + i);
+            acc[i][0] = _mm256_fmadd_ps(a_value, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(a_value, b1, acc[i][1]);
+        }
+        a += GEMM_MR;
+        b += 16;
+    }
+
+    for (size_t i = 0; i < GEMM_MR; ++i)
+    {
+        float* c_row = c + i * ldc;
+        if (accumulate)
+        {
+            acc[i][0] = _mm256_add_ps(_mm256_loadu_ps(c_row), acc[i][0]);
+            acc[i][1] = _mm256_add_ps(_mm256_loadu_ps(c_row + 8), acc[i][1]);
+        }
+        _mm256_storeu_ps(c_row, acc[i][0]);
+        _mm256_storeu_ps(c_row + 8, acc[i][1]);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void sgemm_kernel_avx512(size_t k, const float* a, const float* b, float* c, size_t ldc, bool accumulate)
+{
+    __m512 acc[GEMM_MR][2];
+    for (size_t i = 0; i < GEMM_MR; ++i)
+    {
+        acc[i][0] = _mm512_setzero_ps();
+        acc[i][1] = _mm512_setzero_ps();
+    }
+
+    for (size_t p = 0; p < k; ++p)
+    {
+        __m512 b0 = _mm512_loadu_ps(b);
+        __m512 b1 = _mm512_loadu_ps(b + 16);
+        for (size_t i = 0; i < GEMM_MR; ++i)
+        {
+            __m512 a_value = _mm512_set1_ps(a[i]);
+            acc[i][0] = _mm512_fmadd_ps(a_value, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_ps(a_value, b1, acc[i][1]);
+        }
+        a += GEMM_MR;
+        b += 32;
+    }
+
+    for (size_t i = 0; i < GEMM_MR; ++i)
+    {
+        float* c_row = c + i * ldc;
+        if (accumulate)
+        {
+            acc[i][0] = _mm512_add_ps(_mm512_loadu_ps(c_row), acc[i][0]);
+            acc[i][1] = _mm512_add_ps(_mm512_loadu_ps(c_row + 16), acc[i][1]);
+        }
+        _mm512_storeu_ps(c_row, acc[i][0]);
+        _mm512_storeu_ps(c_row + 16, acc[i][1]);
+    }
+}
+
+static inline float sgemm_dot_tail(size_t begin, size_t k, const float* a, const float* b)
+{
+    float sum = 0.0f;
+    for (size_t p = begin; p < k; ++p)
+    {
+        sum += a[p] * b[p];
+    }
+    return sum;
+}
+
+static void sgemm_dot_scalar(size_t k, const float* a, const float* b, size_t ldb, size_t rows, float* out)
+{
+    for (size_t r = 0; r < rows; ++r)
+    {
+        out[r] = sgemm_dot_tail(0, k, a, b + r * ldb);
+    }
+}
+
+// Up to four weight rows share each load of the input row
+__attribute__((target("avx2,fma")))
+static void sgemm_dot_avx2(size_t k, const float* a, const float* b, size_t ldb, size_t rows, float* out)
+{
+    __m256 acc[GEMM_DOT_ROWS];
+    for (size_t r = 0; r < rows; ++r)
+    {
+        acc[r] = _mm256_setzero_ps();
+    }
+    size_t p = 0;
+    for (; p + 8 <= k; p += 8)
+    {
+        __m256 va = _mm256_loadu_ps(a + p);
+        for (size_t r = 0; r < rows; ++r)
+        {
+            acc[r] = _mm256_fmadd_ps(va, _mm256_loadu_ps(b + r * ldb + p), acc[r]);
+        }
+    }
+    for (size_t r = 0; r < rows; ++r)
+    {
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc[r]), _mm256_extractf128_ps(acc[r], 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+        out[r] = _mm_cvtss_f32(sum) + sgemm_dot_tail(p, k, a, b + r * ldb);
+    }
+}
+
+__attribute__((target("avx512f")))
+static void sgemm_dot_avx512(size_t k, const float* a, const float* b, size_t ldb, size_t rows, float* out)
+{
+    __m512 acc[GEMM_DOT_ROWS];
+    for (size_t r = 0; r < rows; ++r)
+    {
+        acc[r] = _mm512_setzero_ps();
+    }
+    size_t p = 0;
+    for (; p + 16 <= k; p += 16)
+    {
+        __m512 va = _mm512_loadu_ps(a + p);
+        for (size_t r = 0; r < rows; ++r)
+        {
+            acc[r] = _mm512_fmadd_ps(va, _mm512_loadu_ps(b + r * ldb + p), acc[r]);
+        }
+    }
+    for (size_t r = 0; r < rows; ++r)
+    {
+        out[r] = _mm512_reduce_add_ps(acc[r]) + sgemm_dot_tail(p, k, a, b + r * ldb);
+    }
+}
+
+static void sgemm_detect_kernel(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        sgemm_kernel = (sgemm_kernel_t){32, sgemm_kernel_avx512, sgemm_dot_avx512};
+    }
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        sgemm_kernel = (sgemm_kernel_t){16, sgemm_kernel_avx2, sgemm_dot_avx2};
+    }
+    else
+    {
+        sgemm_kernel = (sgemm_kernel_t){16, sgemm_kernel_scalar, sgemm_dot_scalar};
+    }
+}
+
+static sgemm_kernel_t sgemm_select_kernel(void)
+{
+    pthread_once(&sgemm_kernel_once, sgemm_detect_kernel);
+    return sgemm_kernel;
+}
+
+static inline float matrix_at(const float* x, size_t ld, bool trans, size_t row, size_t col)
+{
+    return trans ? x[col * ld + row] : x[row * ld + col];
+}
+
+static void sgemm_pack_a(bool trans_a, const float* a, size_t lda, size_t row, size_t col, size_t mc, size_t kc, float alpha, float* packed)
+{
+    for (size_t ir = 0; ir < mc; ir += GEMM_MR)
+    {
+        size_t mr = (mc - ir < GEMM_MR) ? mc - ir : GEMM_MR;
+        for (size_t p = 0; p < kc; ++p)
+        {
+            for (size_t i = 0; i < mr; ++i)
+            {
+                packed[i] = alpha * matrix_at(a, lda, trans_a, row + ir + i, col + p);
+            }
+            for (size_t i = mr; i < GEMM_MR; ++i)
+            {
+                packed[i] = 0.0f;
+            }
+            packed += GEMM_MR;
+        }
+    }
+}
+
+static void sgemm_pack_b(bool trans_b, const float* b, size_t ldb, size_t row, size_t col, size_t kc, size_t nc, size_t nr_max, float* packed)
+{
+    for (size_t jr = 0; jr < nc; jr += nr_max)
+    {
+        size_t nr = (nc - jr < nr_max) ? nc - jr : nr_max;
+        for (size_t p = 0; p < kc; ++p)
+        {
+            if (!trans_b && nr == nr_max)
+            {
+                memcpy(packed, &b[(row + p) * ldb + col + jr], nr * sizeof(float));
+            }
+            else
+            {
+                for (size_t j = 0; j < nr; ++j)
+                {
+                    packed[j] = matrix_at(b, ldb, trans_b, row + p, col + jr + j);
+                }
+                for (size_t j = nr; j < nr_max; ++j)
+                {
+                    packed[j] = 0.0f;
+                }
+            }
+            packed += nr_max;
+        }
+    }
+}
+
+// The epilogue runs on each output tile straight after its last K panel, while the tile is still in L1
+static void sgemm_macro_kernel(sgemm_kernel_t kernel, size_t mc, size_t nc, size_t kc, const float* packed_a, const float* packed_b, float* c, size_t ldc, bool accumulate, const sgemm_epilogue_t* epilogue)
+{
+    float tile[GEMM_MR * GEMM_NR_MAX];
+
+    for (size_t jr = 0; jr < nc; jr += kernel.nr)
+    {
+        size_t nr = (nc - jr < kernel.nr) ? nc - jr : kernel.nr;
+        const float* b_panel = &packed_b[jr * kc];
+
+        for (size_t ir = 0; ir < mc; ir += GEMM_MR)
+        {
+            size_t mr = (mc - ir < GEMM_MR) ? mc - ir : GEMM_MR;
+            const float* a_panel = &packed_a[ir * kc];
+            float* c_tile = &c[ir * ldc + jr];
+
+            if (mr == GEMM_MR && nr == kernel.nr)
+            {
+                kernel.fn(kc, a_panel, b_panel, c_tile, ldc, accumulate);
+            }
+            else
+            {
+                // Partial tiles go through a scratch buffer so the kernel never writes out of bounds
+                kernel.fn(kc, a_panel, b_panel, tile, kernel.nr, false);
+                for (size_t i = 0; i < mr; ++i)
+                {
+                    for (size_t j = 0; j < nr; ++j)
+                    {
+                        float value = tile[i * kernel.nr + j];
+                        c_tile[i * ldc + j] = accumulate ? c_tile[i * ldc + j] + value : value;
+                    }
+                }
+            }
+
+            if (epilogue)
+            {
+                float* z = epilogue->preactivation ? &epilogue->preactivation[ir * ldc + jr] : NULL;
+                cortex_sactivation(epilogue->activation, mr, nr, epilogue->bias ? &epilogue->bias[jr] : NULL, c_tile, ldc, z, ldc);
+            }
+        }
+    }
+}
+
+static void sgemm_reference(bool trans_a, bool trans_b, size_t m, size_t n, size_t k, float alpha, const float* a, size_t lda, const float* b, size_t ldb, float* c, size_t ldc)
+{
+    for (size_t i = 0; i < m; ++i)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            float sum = 0.0f;
+            for (size_t p = 0; p < k; ++p)
+            {
+                sum += matrix_at(a, lda, trans_a, i, p) * matrix_at(b, ldb, trans_b, p, j);
+            }
+            c[i * ldc + j] += alpha * sum;
+        }
+    }
+}
+
+static void sgemm_scale(size_t m, size_t n, float beta, float* c, size_t ldc)
+{
+    if (beta == 1.0f)
+    {
+        return;
+    }
+    for (size_t i = 0; i < m; ++i)
+    {
+        float* c_row = &c[i * ldc];
+        if (beta == 0.0f)
+        {
+            memset(c_row, 0, n * sizeof(float));
+            continue;
+        }
+        for (size_t j = 0; j < n; ++j)
+        {
+            c_row[j] *= beta;
+        }
+    }
+}
+
+static void sgemm_workspace_release(void* ptr)
+{
+    sgemm_workspace_t* workspace = (sgemm_workspace_t*)ptr;
+    free(workspace->data);
+    free(workspace);
+}
+
+static void sgemm_workspace_key_create(void)
+{
+    pthread_key_create(&sgemm_workspace_key, sgemm_workspace_release);
+}
+
+// Packing buffers are cached per thread so that repeated calls, and calls from worker threads, never allocate
+static float* sgemm_workspace_get(size_t count)
+{
+    pthread_once(&sgemm_workspace_once, sgemm_workspace_key_create);
+
+    sgemm_workspace_t* workspace = (sgemm_workspace_t*)pthread_getspecific(sgemm_workspace_key);
+    if (workspace == NULL)
+    {
+        workspace = (sgemm_workspace_t*)calloc(1, sizeof(sgemm_workspace_t));
+        if (workspace == NULL)
+        {
+            return NULL;
+        }
+        if (pthread_setspecific(sgemm_workspace_key, workspace) != 0)
+        {
+            free(workspace);
+            return NULL;
+        }
+    }
+
+    if (workspace->capacity < count)
+    {
+        size_t bytes = ((count * sizeof(float) + 63) / 64) * 64;
+        float* data = (float*)aligned_alloc(64, bytes);
+        if (data == NULL)
+        {
+            return NULL;
+        }
+        free(workspace->data);
+        workspace->data = data;
+        workspace->capacity = count;
+    }
+
+    return workspace->data;
+}
+
+// Moves an epilogue to the sub-block of C that starts at (row, col)
+static const sgemm_epilogue_t* sgemm_epilogue_offset(const sgemm_epilogue_t* epilogue, size_t row, size_t col, size_t ldc, sgemm_epilogue_t* shifted)
+{
+    if (epilogue == NULL)
+    {
+        return NULL;
+    }
+    shifted->activation = epilogue->activation;
+    shifted->bias = epilogue->bias ? epilogue->bias + col : NULL;
+    shifted->preactivation = epilogue->preactivation ? epilogue->preactivation + row * ldc + col : NULL;
+    return shifted;
+}
+
+static void sgemm_serial(bool trans_a, bool trans_b, size_t m, size_t n, size_t k, float alpha, const float* a, size_t lda, const float* b, size_t ldb, bool overwrite, float* c, size_t ldc, const sgemm_epilogue_t* epilogue)
+{
+    sgemm_kernel_t kernel = sgemm_select_kernel();
+    size_t nc_max = (n < GEMM_NC) ? ((n + kernel.nr - 1) / kernel.nr) * kernel.nr : GEMM_NC;
+    size_t kc_max = (k < GEMM_KC) ? k : GEMM_KC;
+
+    float* packed_a = sgemm_workspace_get(GEMM_MC * kc_max + kc_max * nc_max);
+    if (packed_a == NULL)
+    {
+        if (overwrite)
+        {
+            sgemm_scale(m, n, 0.0f, c, ldc);
+        }
+        sgemm_reference(trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, c, ldc);
+        if (epilogue)
+        {
+            cortex_sactivation(epilogue->activation, m, n, epilogue->bias, c, ldc, epilogue->preactivation, ldc);
+        }
+        return;
+    }
+    float* packed_b = packed_a + GEMM_MC * kc_max;
+
+    for (size_t jc = 0; jc < n; jc += GEMM_NC)
+    {
+        size_t nc = (n - jc < GEMM_NC) ? n - jc : GEMM_NC;
+
+        for (size_t pc = 0; pc < k; pc += GEMM_KC)
+        {
+            size_t kc = (k - pc < GEMM_KC) ? k - pc : GEMM_KC;
+            bool accumulate = !(overwrite && pc == 0);
+            bool last_panel = (pc + kc == k);
+            sgemm_pack_b(trans_b, b, ldb, pc, jc, kc, nc, kernel.nr, packed_b);
+
+            for (size_t ic = 0; ic < m; ic += GEMM_MC)
+            {
+                size_t mc = (m - ic < GEMM_MC) ? m - ic : GEMM_MC;
+                sgemm_epilogue_t shifted;
+                const sgemm_epilogue_t* block_epilogue = last_panel ? sgemm_epilogue_offset(epilogue, ic, jc, ldc, &shifted) : NULL;
+                sgemm_pack_a(trans_a, a, lda, ic, pc, mc, kc, alpha, packed_a);
+                sgemm_macro_kernel(kernel, mc, nc, kc, packed_a, packed_b, &c[ic * ldc + jc], ldc, accumulate, block_epilogue);
+            }
+        }
+    }
+}
+
+// Each task owns a disjoint slab of C, split along whichever of m and n is larger
+static void sgemm_parallel_body(void* ctx, size_t begin, size_t end)
+{
+    const sgemm_args_t* args = (const sgemm_args_t*)ctx;
+    size_t limit = args->split_rows ? args->m : args->n;
+    size_t first = begin * args->tile;
+    size_t last = (end * args->tile < limit) ? end * args->tile : limit;
+    sgemm_epilogue_t shifted;
+
+    if (args->split_rows)
+    {
+        const float* a = args->trans_a ? args->a + first : args->a + first * args->lda;
+        const sgemm_epilogue_t* epilogue = sgemm_epilogue_offset(args->epilogue, first, 0, args->ldc, &shifted);
+        sgemm_serial(args->trans_a, args->trans_b, last - first, args->n, args->k, args->alpha, a, args->lda, args->b, args->ldb, args->overwrite, args->c + first * args->ldc, args->ldc, epilogue);
+    }
+    else
+    {
+        const float* b = args->trans_b ? args->b + first * args->ldb : args->b + first;
+        const sgemm_epilogue_t* epilogue = sgemm_epilogue_offset(args->epilogue, 0, first, args->ldc, &shifted);
+        sgemm_serial(args->trans_a, args->trans_b, args->m, last - first, args->k, args->alpha, args->a, args->lda, b, args->ldb, args->overwrite, args->c + first, args->ldc, epilogue);
+    }
+}
+
+static void sgemv_block(const sgemv_args_t* args, size_t first, size_t rows)
+{
+    float sums[GEMM_DOT_ROWS];
+    for (size_t i = 0; i < args->m; ++i)
+    {
+        const float* a_row = &args->a[i * args->lda];
+        float* c_row = &args->c[i * args->ldc + first];
+        for (size_t j = 0; j < rows; j += GEMM_DOT_ROWS)
+        {
+            size_t count = (rows - j < GEMM_DOT_ROWS) ? rows - j : GEMM_DOT_ROWS;
+            args->dot(args->k, a_row, &args->b[(first + j) * args->ldb], args->ldb, count, sums);
+            for (size_t r = 0; r < count; ++r)
+            {
+                c_row[j + r] = args->overwrite ? args->alpha * sums[r] : c_row[j + r] + args->alpha * sums[r];
+            }
+        }
+    }
+
+    if (args->epilogue)
+    {
+        const float* bias = args->epilogue->bias ? args->epilogue->bias + first : NULL;
+        float* z = args->epilogue->preactivation ? args->epilogue->preactivation + first : NULL;
+        cortex_sactivation(args->epilogue->activation, args->m, rows, bias, &args->c[first], args->ldc, z, args->ldc);
+    }
+}
+
+static void sgemv_body(void* ctx, size_t begin, size_t end)
+{
+    const sgemv_args_t* args = (const sgemv_args_t*)ctx;
+    for (size_t index = begin; index < end; ++index)
+    {
+        size_t first = index * args->block;
+        size_t rows = (first + args->block < args->n) ? args->block : args->n - first;
+        sgemv_block(args, first, rows);
+    }
+}
+
+// A handful of rows against row-major B^T reads every weight once either way, so the rows are streamed as dot products
+// instead of being repacked on every call; a block of them stays in L2 while each input row passes over it
+static void sgemv(size_t m, size_t n, size_t k, float alpha, const float* a, size_t lda, const float* b, size_t ldb, bool overwrite, float* c, size_t ldc, const sgemm_epilogue_t* epilogue)
+{
+    sgemv_args_t args = {sgemm_select_kernel().dot, m, n, k, alpha, a, lda, b, ldb, overwrite, c, ldc, epilogue, 0};
+    size_t block = GEMM_GEMV_BLOCK_BYTES / (k * sizeof(float));
+    block = (block / GEMM_DOT_ROWS) * GEMM_DOT_ROWS;
+    args.block = (block < GEMM_DOT_ROWS) ? GEMM_DOT_ROWS : block;
+
+    size_t num_blocks = (n + args.block - 1) / args.block;
+    double flops_per_block = 2.0 * (double)m * (double)args.block * (double)k;
+    size_t grain = (size_t)((double)GEMM_PARALLEL_MIN_FLOPS / flops_per_block) + 1;
+    cortex_parallel_for(num_blocks, grain, sgemv_body, &args);
+}
+
+void cortex_sgemm(bool trans_a, bool trans_b, size_t m, size_t n, size_t k, float alpha, const float* a, size_t lda, const float* b, size_t ldb, float beta, float* c, size_t ldc)
+{
+    cortex_sgemm_fused(trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, NULL);
+}
+
+void cortex_sgemm_fused(bool trans_a, bool trans_b, size_t m, size_t n, size_t k, float alpha, const float* a, size_t lda, const float* b, size_t ldb, float beta, float* c, size_t ldc, const sgemm_epilogue_t* epilogue)
+{
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+
+    if (k == 0 || alpha == 0.0f)
+    {
+        sgemm_scale(m, n, beta, c, ldc);
+        if (epilogue)
+        {
+            cortex_sactivation(epilogue->activation, m, n, epilogue->bias, c, ldc, epilogue->preactivation, ldc);
+        }
+        return;
+    }
+
+    // With beta == 0 the first K panel stores instead of accumulating, so C is never cleared separately
+    bool overwrite = (beta == 0.0f);
+    if (!overwrite)
+    {
+        sgemm_scale(m, n, beta, c, ldc);
+    }
+
+    if (!trans_a && trans_b && m <= GEMM_GEMV_MAX_ROWS)
+    {
+        sgemv(m, n, k, alpha, a, lda, b, ldb, overwrite, c, ldc, epilogue);
+        return;
+    }
+
+    double flops = 2.0 * (double)m * (double)n * (double)k;
+    if (flops < 2.0 * GEMM_PARALLEL_MIN_FLOPS || cortex_get_num_threads() == 1)
+    {
+        sgemm_serial(trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, overwrite, c, ldc, epilogue);
+        return;
+    }
+
+    sgemm_args_t args = {trans_a, trans_b, m, n, k, alpha, a, lda, b, ldb, overwrite, c, ldc, epilogue, m >= n, 0};
+    args.tile = args.split_rows ? GEMM_MR : sgemm_select_kernel().nr;
+
+    size_t extent = args.split_rows ? m : n;
+    size_t tiles = (extent + args.tile - 1) / args.tile;
+    double flops_per_tile = flops * (double)args.tile / (double)extent;
+    size_t grain = (size_t)((double)GEMM_PARALLEL_MIN_FLOPS / flops_per_tile) + 1;
+
+    cortex_parallel_for(tiles, grain, sgemm_parallel_body, &args);
+}
@@ -0,0 +1,131 @@
+#include <math.h>
+#include <pthread.h>
+#include "ops/kernels/optimizer.h"
+
+#define OPTIMIZER_INLINE static inline __attribute__((always_inline))
+
+typedef void (*sgd_fn)(const sgd_update_t* update, size_t n, float* param, float* grad, float* velocity);
+typedef void (*adam_fn)(const adam_update_t* update, size_t n, float* param, float* grad, float* m, float* v);
+
+typedef struct optimizer_kernels
+{
+    sgd_fn sgd;
+    adam_fn adam;
+} optimizer_kernels_t;
+
+static const optimizer_kernels_t* optimizer_kernels;
+static pthread_once_t optimizer_kernels_once = PTHREAD_ONCE_INIT;
+
+// Every buffer is read and written exactly once, the gradient is cleared in the same pass when asked to
+OPTIMIZER_INLINE void sgd_body(const sgd_update_t* update, size_t n, float* restrict p, float* restrict g, float* restrict velocity)
+{
+    float lr = update->learning_rate;
+    float mu = update->momentum;
+    float wd = update->weight_decay;
+    bool zero_grad = update->zero_grad;
+
+    if (velocity == NULL)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            float d = g[j] + wd * p[j];
+            p[j] -= lr * d;
+            g[j] = zero_grad ? 0.0f : g[j];
+        }
+    }
+    else if (update->nesterov)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            float d = g[j] + wd * p[j];
+            float v = mu * velocity[j] + d;
+            velocity[j] = v;
+            p[j] -= lr * (d + mu * v);
+            g[j] = zero_grad ? 0.0f : g[j];
+        }
+    }
+    else
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            float d = g[j] + wd * p[j];
+            float v = mu * velocity[j] + d;
+            velocity[j] = v;
+            p[j] -= lr * v;
+            g[j] = zero_grad ? 0.0f : g[j];
+        }
+    }
+}
+
+// Bias correction is folded into step_size and epsilon by the caller, AdamW's decoupled decay into the decay factor
+OPTIMIZER_INLINE void adam_body(const adam_update_t* update, size_t n, float* restrict p, float* restrict g, float* restrict m, float* restrict v)
+{
+    float b1 = update->beta1;
+    float b2 = update->beta2;
+    float step_size = update->step_size;
+    float eps = update->epsilon;
+    float wd = update->weight_decay;
+    float decay = update->decay;
+    bool zero_grad = update->zero_grad;
+
+    for (size_t j = 0; j < n; ++j)
+    {
+        float d = g[j] + wd * p[j];
+        float mj = b1 * m[j] + (1.0f - b1) * d;
+        float vj = b2 * v[j] + (1.0f - b2) * d * d;
+        m[j] = mj;
+        v[j] = vj;
+        p[j] = decay * p[j] - step_size * mj / (sqrtf(vj) + eps);
+        g[j] = zero_grad ? 0.0f : g[j];
+    }
+}
+
+#define OPTIMIZER_DEFINE_KERNELS(isa, attribute)                                                                        \
+    attribute static void sgd_##isa(const sgd_update_t* update, size_t n, float* param, float* grad, float* velocity)  \
+    {                                                                                                                   \
+        sgd_body(update, n, param, grad, velocity);                                                                     \
+    }                                                                                                                   \
+    attribute static void adam_##isa(const adam_update_t* update, size_t n, float* param, float* grad, float* m,        \
+                                     float* v)                                                                          \
+    {                                                                                                                   \
+        adam_body(update, n, param, grad, m, v);                                                                        \
+    }                                                                                                                   \
+    static const optimizer_kernels_t optimizer_kernels_##isa = {sgd_##isa, adam_##isa};
+
+OPTIMIZER_DEFINE_KERNELS(scalar, )
+OPTIMIZER_DEFINE_KERNELS(avx2, __attribute__((target("avx2,fma"))))
+OPTIMIZER_DEFINE_KERNELS(avx512, __attribute__((target("avx512f"))))
+
+static void optimizer_detect_kernels(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        optimizer_kernels = &optimizer_kernels_avx512;
+    }
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+        optimizer_kernels = &optimizer_kernels_avx2;
+    }
+    else
+    {
+        optimizer_kernels = &optimizer_kernels_scalar;
+    }
+}
+
+static const optimizer_kernels_t* optimizer_select_kernels(void)
+{
+    pthread_once(&optimizer_kernels_once, optimizer_detect_kernels);
+    return optimizer_kernels;
+}
+
+// Serial over one slice, the optimizer decides how slices are spread over the thread pool
+void cortex_ssgd(const sgd_update_t* update, size_t n, float* param, float* grad, float* velocity)
+{
+    optimizer_select_kernels()->sgd(update, n, param, grad, velocity);
+}
+
+void cortex_sadam(const adam_update_t* update, size_t n, float* param, float* grad, float* m, float* v)
+{
+    optimizer_select_kernels()->adam(update, n, param, grad, m, v);
+}
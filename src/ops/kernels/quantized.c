@@ -0,0 +1,818 @@
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <immintrin.h>
+#include "utils/memory/pool.h"
+#include "utils/thread/parallel.h"
+#include "ops/kernels/quantized.h"
+
+#define QUANTIZED_INLINE static inline __attribute__((always_inline))
+#define QUANTIZED_BLOCK_BYTES (128 * 1024)
+#define QUANTIZED_BLOCK_ALIGN 16
+#define QUANTIZE_GRAIN 16384
+#define QUANTIZED_DOT_ROWS 64
+#define QUANTIZED_GEMV_MAX_ROWS 16
+#define QUANTIZED_GEMM_BLOCK 256
+
+typedef void (*quantize_row_fn)(size_t k, const float* x, int8_t* q, float* scale);
+typedef void (*dot_int8_fn)(size_t k, const int8_t* a, const int8_t* b, size_t rows, int32_t* out);
+typedef void (*convert_to_fn)(size_t n, const float* x, uint16_t* y);
+typedef void (*convert_from_fn)(size_t n, const uint16_t* x, float* y);
+typedef void (*dot_reduced_fn)(size_t k, const float* a, const uint16_t* b, size_t rows, float* out);
+
+typedef struct quantized_kernels
+{
+    quantize_row_fn quantize_row;
+    dot_int8_fn dot_int8;
+    convert_to_fn to_half;
+    convert_from_fn from_half;
+    convert_to_fn to_bfloat;
+    convert_from_fn from_bfloat;
+    dot_reduced_fn dot_half;
+    dot_reduced_fn dot_bfloat;
+} quantized_kernels_t;
+
+typedef struct quantize_args
+{
+    const quantized_kernels_t* kernels;
+    size_t k;
+    const float* x;
+    size_t ldx;
+    int8_t* q;
+    float* scales;
+} quantize_args_t;
+
+typedef struct reduced_args
+{
+    const quantized_kernels_t* kernels;
+    tensor_dtype_t dtype;
+    size_t m;
+    size_t n;
+    size_t k;
+    size_t block;
+    const float* a;
+    size_t lda;
+    const int8_t* a_quantized;
+    const float* a_scales;
+    const void* b;
+    const float* b_scales;
+    float* c;
+    size_t ldc;
+    const sgemm_epilogue_t* epilogue;
+} reduced_args_t;
+
+typedef struct quantized_workspace
+{
+    float* data;
+    size_t capacity;
+} quantized_workspace_t;
+
+static const quantized_kernels_t* quantized_kernels;
+static pthread_once_t quantized_kernels_once = PTHREAD_ONCE_INIT;
+static pthread_key_t quantized_workspace_key;
+static pthread_once_t quantized_workspace_once = PTHREAD_ONCE_INIT;
+
+// Symmetric: the largest magnitude of the row maps to 127 and zero stays exactly zero
+QUANTIZED_INLINE void quantize_row(size_t k, const float* x, int8_t* q, float* scale)
+{
+    float max = 0.0f;
+    for (size_t i = 0; i < k; ++i)
+    {
+        max = fmaxf(max, fabsf(x[i]));
+    }
+    *scale = max / 127.0f;
+    float inverse = (max > 0.0f) ? 127.0f / max : 0.0f;
+    for (size_t i = 0; i < k; ++i)
+    {
+        float value = x[i] * inverse;
+        q[i] = (int8_t)(value + ((value >= 0.0f) ? 0.5f : -0.5f));
+    }
+}
+
+QUANTIZED_INLINE int32_t dot_int8_tail(size_t begin, size_t k, const int8_t* a, const int8_t* b)
+{
+    int32_t sum = 0;
+    for (size_t i = begin; i < k; ++i)
+    {
+        sum += (int32_t)a[i] * (int32_t)b[i];
+    }
+    return sum;
+}
+
+QUANTIZED_INLINE void to_half(size_t n, const float* x, uint16_t* y)
+{
+    _Float16* h = (_Float16*)y;
+    for (size_t i = 0; i < n; ++i)
+    {
+        h[i] = (_Float16)x[i];
+    }
+}
+
+QUANTIZED_INLINE void from_half(size_t n, const uint16_t* x, float* y)
+{
+    const _Float16* h = (const _Float16*)x;
+    for (size_t i = 0; i < n; ++i)
+    {
+        y[i] = (float)h[i];
+    }
+}
+
+// Rounds to nearest even on the 16 dropped mantissa bits
+QUANTIZED_INLINE void to_bfloat(size_t n, const float* x, uint16_t* y)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t bits;
+        memcpy(&bits, &x[i], sizeof(bits));
+        bits += 0x7FFFu + ((bits >> 16) & 1u);
+        y[i] = (uint16_t)(bits >> 16);
+    }
+}
+
+QUANTIZED_INLINE void from_bfloat(size_t n, const uint16_t* x, float* y)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t bits = (uint32_t)x[i] << 16;
+        memcpy(&y[i], &bits, sizeof(bits));
+    }
+}
+
+QUANTIZED_INLINE float reduced_value(uint16_t x, bool bfloat)
+{
+    if (bfloat)
+    {
+        uint32_t bits = (uint32_t)x << 16;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    _Float16 half;
+    memcpy(&half, &x, sizeof(half));
+    return (float)half;
+}
+
+QUANTIZED_INLINE float dot_reduced_tail(size_t begin, size_t k, const float* a, const uint16_t* b, bool bfloat)
+{
+    float sum = 0.0f;
+    for (size_t i = begin; i < k; ++i)
+    {
+        sum += a[i] * reduced_value(b[i], bfloat);
+    }
+    return sum;
+}
+
+static void quantize_row_scalar(size_t k, const float* x, int8_t* q, float* scale)
+{
+    quantize_row(k, x, q, scale);
+}
+
+static void dot_int8_scalar(size_t k, const int8_t* a, const int8_t* b, size_t rows, int32_t* out)
+{
+    for (size_t j = 0; j < rows; ++j)
+    {
+        out[j] = dot_int8_tail(0, k, a, &b[j * k]);
+    }
+}
+
+static void to_half_scalar(size_t n, const float* x, uint16_t* y)
+{
+    to_half(n, x, y);
+}
+
+static void from_half_scalar(size_t n, const uint16_t* x, float* y)
+{
+    from_half(n, x, y);
+}
+
+static void to_bfloat_scalar(size_t n, const float* x, uint16_t* y)
+{
+    to_bfloat(n, x, y);
+}
+
+static void from_bfloat_scalar(size_t n, const uint16_t* x, float* y)
+{
+    from_bfloat(n, x, y);
+}
+
+static void dot_half_scalar(size_t k, const float* a, const uint16_t* b, size_t rows, float* out)
+{
+    for (size_t j = 0; j < rows; ++j)
+    {
+        out[j] = dot_reduced_tail(0, k, a, &b[j * k], false);
+    }
+}
+
+static void dot_bfloat_scalar(size_t k, const float* a, const uint16_t* b, size_t rows, float* out)
+{
+    for (size_t j = 0; j < rows; ++j)
+    {
+        out[j] = dot_reduced_tail(0, k, a, &b[j * k], true);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static void quantize_row_avx2(size_t k, const float* x, int8_t* q, float* scale)
+{
+    quantize_row(k, x, q, scale);
+}
+
+__attribute__((target("avx2")))
+static inline int32_t reduce_epi32_avx2(__m256i x)
+{
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+// Both operands are sign-extended to 16 bits and pmaddwd sums adjacent products into 32-bit lanes, so nothing saturates
+// the way maddubs would on unsigned times signed bytes; the activation row is widened once for four weight rows
+__attribute__((target("avx2")))
+static inline void dot_int8_rows_avx2(size_t k, const int8_t* a, const int8_t* b, size_t rows, int32_t* out)
+{
+    __m256i acc[4];
+    for (size_t r = 0; r < rows; ++r)
+    {
+        acc[r] = _mm256_setzero_si256();
+    }
+    size_t i = 0;
+    for (; i + 16 <= k; i += 16)
+    {
+        __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(a + i)));
+        for (size_t r = 0; r < rows; ++r)
+        {
+            __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(b + r * k + i)));
+            acc[r] = _mm256_add_epi32(acc[r], _mm256_madd_epi16(va, vb));
+        }
+    }
+    for (size_t r = 0; r < rows; ++r)
+    {
+        out[r] = reduce_epi32_avx2(acc[r]) + dot_int8_tail(i, k, a, b + r * k);
+    }
+}
+
+__attribute__((target("avx2")))
+static void dot_int8_avx2(size_t k, const int8_t* a, const int8_t* b, size_t rows, int32_t* out)
+{
+    size_t j = 0;
+    for (; j + 4 <= rows; j += 4)
+    {
+        dot_int8_rows_avx2(k, a, &b[j * k], 4, &out[j]);
+    }
+    for (; j < rows; ++j)
+    {
+        dot_int8_rows_avx2(k, a, &b[j * k], 1, &out[j]);
+    }
+}
+
+__attribute__((target("avx2,f16c")))
+static void to_half_avx2(size_t n, const float* x, uint16_t* y)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm_storeu_si128((__m128i*)(y + i), _mm256_cvtps_ph(_mm256_loadu_ps(x + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+    to_half(n - i, x + i, y + i);
+}
+
+__attribute__((target("avx2,f16c")))
+static void from_half_avx2(size_t n, const uint16_t* x, float* y)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_ps(y + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(x + i))));
+    }
+    from_half(n - i, x + i, y + i);
+}
+
+// packus interleaves the two 128-bit lanes, the permute puts the eight results back in order
+__attribute__((target("avx2")))
+static void to_bfloat_avx2(size_t n, const float* x, uint16_t* y)
+{
+    const __m256i bias = _mm256_set1_epi32(0x7FFF);
+    const __m256i one = _mm256_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i bits = _mm256_castps_si256(_mm256_loadu_ps(x + i));
+        __m256i rounding = _mm256_add_epi32(bias, _mm256_and_si256(_mm256_srli_epi32(bits, 16), one));
+        __m256i high = _mm256_srli_epi32(_mm256_add_epi32(bits, rounding), 16);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(high, high), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i*)(y + i), _mm256_castsi256_si128(packed));
+    }
+    to_bfloat(n - i, x + i, y + i);
+}
+
+__attribute__((target("avx2")))
+static void from_bfloat_avx2(size_t n, const uint16_t* x, float* y)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i wide = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(x + i)));
+        _mm256_storeu_ps(y + i, _mm256_castsi256_ps(_mm256_slli_epi32(wide, 16)));
+    }
+    from_bfloat(n - i, x + i, y + i);
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static inline __m256 widen_avx2(const uint16_t* x, bool bfloat)
+{
+    __m128i raw = _mm_loadu_si128((const __m128i*)x);
+    return bfloat ? _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(raw), 16)) : _mm256_cvtph_ps(raw);
+}
+
+// 16-bit weights are widened in registers right before the multiply, so they cross the memory bus at half the FP32 cost
+__attribute__((target("avx2,fma,f16c")))
+static inline void dot_reduced_rows_avx2(size_t k, const float* a, const uint16_t* b, size_t rows, float* out, bool bfloat)
+{
+    __m256 acc[4];
+    for (size_t r = 0; r < rows; ++r)
+    {
+        acc[r] = _mm256_setzero_ps();
+    }
+    size_t i = 0;
+    for (; i + 8 <= k; i += 8)
+    {
+        __m256 va = _mm256_loadu_ps(a + i);
+        for (size_t r = 0; r < rows; ++r)
+        {
+            acc[r] = _mm256_fmadd_ps(va, widen_avx2(b + r * k + i, bfloat), acc[r]);
+        }
+    }
+    for (size_t r = 0; r < rows; ++r)
+    {
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc[r]), _mm256_extractf128_ps(acc[r], 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+        out[r] = _mm_cvtss_f32(sum) + dot_reduced_tail(i, k, a, b + r * k, bfloat);
+    }
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static inline void dot_reduced_avx2(size_t k, const float* a, const uint16_t* b, size_t rows, float* out, bool bfloat)
+{
+    size_t j = 0;
+    for (; j + 4 <= rows; j += 4)
+    {
+        dot_reduced_rows_avx2(k, a, &b[j * k], 4, &out[j], bfloat);
+    }
+    for (; j < rows; ++j)
+    {
+        dot_reduced_rows_avx2(k, a, &b[j * k], 1, &out[j], bfloat);
+    }
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static void dot_half_avx2(size_t k, const float* a, const uint16_t* b, size_t rows, float* out)
+{
+    dot_reduced_avx2(k, a, b, rows, out, false);
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static void dot_bfloat_avx2(size_t k, const float* a, const uint16_t* b, size_t rows, float* out)
+{
+    dot_reduced_avx2(k, a, b, rows, out, true);
+}
+
+__attribute__((target("avx512f")))
+static void quantize_row_avx512(size_t k, const float* x, int8_t* q, float* scale)
+{
+    quantize_row(k, x, q, scale);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static inline void dot_int8_rows_avx512(size_t k, const int8_t* a, const int8_t* b, size_t rows, int32_t* out)
+{
+    __m512i acc[4];
+    for (size_t r = 0; r < rows; ++r)
+    {
+        acc[r] = _mm512_setzero_si512();
+    }
+    size_t i = 0;
+    for (; i + 32 <= k; i += 32)
+    {
+        __m512i va = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(a + i)));
+        for (size_t r = 0; r < rows; ++r)
+        {
+            __m512i vb = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(b + r * k + i)));
+            acc[r] = _mm512_add_epi32(acc[r], _mm512_madd_epi16(va, vb));
+        }
+    }
+    for (size_t r = 0; r < rows; ++r)
+    {
+        out[r] = _mm512_reduce_add_epi32(acc[r]) + dot_int8_tail(i, k, a, b + r * k);
+    }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void dot_int8_avx512(size_t k, const int8_t* a, const int8_t* b, size_t rows, int32_t* out)
+{
+    size_t j = 0;
+    for (; j + 4 <= rows; j += 4)
+    {
+        dot_int8_rows_avx512(k, a, &b[j * k], 4, &out[j]);
+    }
+    for (; j < rows; ++j)
+    {
+        dot_int8_rows_avx512(k, a, &b[j * k], 1, &out[j]);
+    }
+}
+
+__attribute__((target("avx512f,f16c")))
+static void to_half_avx512(size_t n, const float* x, uint16_t* y)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        _mm256_storeu_si256((__m256i*)(y + i), _mm512_cvtps_ph(_mm512_loadu_ps(x + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+    to_half(n - i, x + i, y + i);
+}
+
+__attribute__((target("avx512f,f16c")))
+static void from_half_avx512(size_t n, const uint16_t* x, float* y)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        _mm512_storeu_ps(y + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)(x + i))));
+    }
+    from_half(n - i, x + i, y + i);
+}
+
+__attribute__((target("avx512f")))
+static void to_bfloat_avx512(size_t n, const float* x, uint16_t* y)
+{
+    const __m512i bias = _mm512_set1_epi32(0x7FFF);
+    const __m512i one = _mm512_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i bits = _mm512_castps_si512(_mm512_loadu_ps(x + i));
+        __m512i rounding = _mm512_add_epi32(bias, _mm512_and_si512(_mm512_srli_epi32(bits, 16), one));
+        __m512i high = _mm512_srli_epi32(_mm512_add_epi32(bits, rounding), 16);
+        _mm256_storeu_si256((__m256i*)(y + i), _mm512_cvtepi32_epi16(high));
+    }
+    to_bfloat(n - i, x + i, y + i);
+}
+
+__attribute__((target("avx512f")))
+static void from_bfloat_avx512(size_t n, const uint16_t* x, float* y)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i wide = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)(x + i)));
+        _mm512_storeu_ps(y + i, _mm512_castsi512_ps(_mm512_slli_epi32(wide, 16)));
+    }
+    from_bfloat(n - i, x + i, y + i);
+}
+
+__attribute__((target("avx512f,f16c")))
+static inline __m512 widen_avx512(const uint16_t* x, bool bfloat)
+{
+    __m256i raw = _mm256_loadu_si256((const __m256i*)x);
+    return bfloat ? _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(raw), 16)) : _mm512_cvtph_ps(raw);
+}
+
+__attribute__((target("avx512f,f16c")))
+static inline void dot_reduced_rows_avx512(size_t k, const float* a, const uint16_t* b, size_t rows, float* out, bool bfloat)
+{
+    __m512 acc[4];
+    for (size_t r = 0; r < rows; ++r)
+    {
+        acc[r] = _mm512_setzero_ps();
+    }
+    size_t i = 0;
+    for (; i + 16 <= k; i += 16)
+    {
+        __m512 va = _mm512_loadu_ps(a + i);
+        for (size_t r = 0; r < rows; ++r)
+        {
+            acc[r] = _mm512_fmadd_ps(va, widen_avx512(b + r * k + i, bfloat), acc[r]);
+        }
+    }
+    for (size_t r = 0; r < rows; ++r)
+    {
+        out[r] = _mm512_reduce_add_ps(acc[r]) + dot_reduced_tail(i, k, a, b + r * k, bfloat);
+    }
+}
+
+__attribute__((target("avx512f,f16c")))
+static inline void dot_reduced_avx512(size_t k, const float* a, const uint16_t* b, size_t rows, float* out, bool bfloat)
+{
+    size_t j = 0;
+    for (; j + 4 <= rows; j += 4)
+    {
+        dot_reduced_rows_avx512(k, a, &b[j * k], 4, &out[j], bfloat);
+    }
+    for (; j < rows; ++j)
+    {
+        dot_reduced_rows_avx512(k, a, &b[j * k], 1, &out[j], bfloat);
+    }
+}
+
+__attribute__((target("avx512f,f16c")))
+static void dot_half_avx512(size_t k, const float* a, const uint16_t* b, size_t rows, float* out)
+{
+    dot_reduced_avx512(k, a, b, rows, out, false);
+}
+
+__attribute__((target("avx512f,f16c")))
+static void dot_bfloat_avx512(size_t k, const float* a, const uint16_t* b, size_t rows, float* out)
+{
+    dot_reduced_avx512(k, a, b, rows, out, true);
+}
+
+static const quantized_kernels_t quantized_kernels_scalar = {
+    quantize_row_scalar, dot_int8_scalar, to_half_scalar, from_half_scalar, to_bfloat_scalar, from_bfloat_scalar, dot_half_scalar, dot_bfloat_scalar
+};
+static const quantized_kernels_t quantized_kernels_avx2 = {
+    quantize_row_avx2, dot_int8_avx2, to_half_avx2, from_half_avx2, to_bfloat_avx2, from_bfloat_avx2, dot_half_avx2, dot_bfloat_avx2
+};
+static const quantized_kernels_t quantized_kernels_avx512 = {
+    quantize_row_avx512, dot_int8_avx512, to_half_avx512, from_half_avx512, to_bfloat_avx512, from_bfloat_avx512, dot_half_avx512, dot_bfloat_avx512
+};
+
+static void quantized_detect_kernels(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    {
+        quantized_kernels = &quantized_kernels_avx512;
+    }
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c"))
+    {
+        quantized_kernels = &quantized_kernels_avx2;
+    }
+    else
+    {
+        quantized_kernels = &quantized_kernels_scalar;
+    }
+}
+
+static const quantized_kernels_t* quantized_select_kernels(void)
+{
+    pthread_once(&quantized_kernels_once, quantized_detect_kernels);
+    return quantized_kernels;
+}
+
+static void quantized_workspace_release(void* ptr)
+{
+    quantized_workspace_t* workspace = (quantized_workspace_t*)ptr;
+    free(workspace->data);
+    free(workspace);
+}
+
+static void quantized_workspace_key_create(void)
+{
+    pthread_key_create(&quantized_workspace_key, quantized_workspace_release);
+}
+
+// Dequantized weight blocks are cached per thread the same way the GEMM caches its packing buffers
+static float* quantized_workspace_get(size_t count)
+{
+    pthread_once(&quantized_workspace_once, quantized_workspace_key_create);
+
+    quantized_workspace_t* workspace = (quantized_workspace_t*)pthread_getspecific(quantized_workspace_key);
+    if (workspace == NULL)
+    {
+        workspace = (quantized_workspace_t*)calloc(1, sizeof(quantized_workspace_t));
+        if (workspace == NULL)
+        {
+            return NULL;
+        }
+        if (pthread_setspecific(quantized_workspace_key, workspace) != 0)
+        {
+            free(workspace);
+            return NULL;
+        }
+    }
+
+    if (workspace->capacity < count)
+    {
+        size_t bytes = ((count * sizeof(float) + 63) / 64) * 64;
+        float* data = (float*)aligned_alloc(64, bytes);
+        if (data == NULL)
+        {
+            return NULL;
+        }
+        free(workspace->data);
+        workspace->data = data;
+        workspace->capacity = count;
+    }
+
+    return workspace->data;
+}
+
+static void quantize_body(void* ctx, size_t begin, size_t end)
+{
+    const quantize_args_t* args = (const quantize_args_t*)ctx;
+    for (size_t i = begin; i < end; ++i)
+    {
+        args->kernels->quantize_row(args->k, &args->x[i * args->ldx], &args->q[i * args->k], &args->scales[i]);
+    }
+}
+
+void cortex_squantize_rows(size_t m, size_t k, const float* x, size_t ldx, int8_t* q, float* scales)
+{
+    if (m == 0 || k == 0)
+    {
+        return;
+    }
+    quantize_args_t args = {quantized_select_kernels(), k, x, ldx, q, scales};
+    size_t grain = (QUANTIZE_GRAIN + k - 1) / k;
+    cortex_parallel_for(m, grain, quantize_body, &args);
+}
+
+void cortex_sconvert_to(tensor_dtype_t dtype, size_t n, const float* x, void* y)
+{
+    const quantized_kernels_t* kernels = quantized_select_kernels();
+    if (dtype == TENSOR_FLOAT16)
+    {
+        kernels->to_half(n, x, (uint16_t*)y);
+    }
+    else if (dtype == TENSOR_BFLOAT16)
+    {
+        kernels->to_bfloat(n, x, (uint16_t*)y);
+    }
+    else if (dtype == TENSOR_FLOAT32)
+    {
+        memcpy(y, x, n * sizeof(float));
+    }
+}
+
+void cortex_sconvert_from(tensor_dtype_t dtype, size_t n, const void* x, float* y)
+{
+    const quantized_kernels_t* kernels = quantized_select_kernels();
+    if (dtype == TENSOR_FLOAT16)
+    {
+        kernels->from_half(n, (const uint16_t*)x, y);
+    }
+    else if (dtype == TENSOR_BFLOAT16)
+    {
+        kernels->from_bfloat(n, (const uint16_t*)x, y);
+    }
+    else if (dtype == TENSOR_FLOAT32)
+    {
+        memcpy(y, x, n * sizeof(float));
+    }
+}
+
+// 16-bit weights are widened one block of rows at a time and handed to the FP32 GEMM while the block is still in cache
+static void reduced_float_block(const reduced_args_t* args, size_t first, size_t rows, float* block)
+{
+    const uint16_t* b = (const uint16_t*)args->b + first * args->k;
+    if (args->dtype == TENSOR_FLOAT16)
+    {
+        args->kernels->from_half(rows * args->k, b, block);
+    }
+    else
+    {
+        args->kernels->from_bfloat(rows * args->k, b, block);
+    }
+
+    sgemm_epilogue_t epilogue = {NULL, ACTIVATION_NONE, NULL};
+    if (args->epilogue)
+    {
+        epilogue.bias = args->epilogue->bias ? args->epilogue->bias + first : NULL;
+        epilogue.activation = args->epilogue->activation;
+        epilogue.preactivation = args->epilogue->preactivation ? args->epilogue->preactivation + first : NULL;
+    }
+    cortex_sgemm_fused(false, true, args->m, rows, args->k, 1.0f, args->a, args->lda, block, args->k, 0.0f, &args->c[first], args->ldc, &epilogue);
+}
+
+// Small batches read every weight once either way, so widening in registers beats staging a float copy for the GEMM
+static void reduced_dot_block(const reduced_args_t* args, size_t first, size_t rows)
+{
+    const uint16_t* b = (const uint16_t*)args->b + first * args->k;
+    dot_reduced_fn dot = (args->dtype == TENSOR_FLOAT16) ? args->kernels->dot_half : args->kernels->dot_bfloat;
+    for (size_t i = 0; i < args->m; ++i)
+    {
+        dot(args->k, &args->a[i * args->lda], b, rows, &args->c[i * args->ldc + first]);
+    }
+
+    if (args->epilogue)
+    {
+        const float* bias = args->epilogue->bias ? args->epilogue->bias + first : NULL;
+        float* z = args->epilogue->preactivation ? args->epilogue->preactivation + first : NULL;
+        cortex_sactivation(args->epilogue->activation, args->m, rows, bias, &args->c[first], args->ldc, z, args->ldc);
+    }
+}
+
+// Each output is an int32 dot product rescaled by its row and channel scales, then bias and activation run on the block
+static void reduced_int8_block(const reduced_args_t* args, size_t first, size_t rows)
+{
+    const int8_t* b = (const int8_t*)args->b + first * args->k;
+    int32_t dots[QUANTIZED_DOT_ROWS];
+    for (size_t i = 0; i < args->m; ++i)
+    {
+        float* c = &args->c[i * args->ldc + first];
+        for (size_t j = 0; j < rows; j += QUANTIZED_DOT_ROWS)
+        {
+            size_t count = (j + QUANTIZED_DOT_ROWS < rows) ? QUANTIZED_DOT_ROWS : rows - j;
+            args->kernels->dot_int8(args->k, &args->a_quantized[i * args->k], &b[j * args->k], count, dots);
+            for (size_t r = 0; r < count; ++r)
+            {
+                c[j + r] = (float)dots[r] * args->a_scales[i] * args->b_scales[first + j + r];
+            }
+        }
+    }
+
+    if (args->epilogue)
+    {
+        const float* bias = args->epilogue->bias ? args->epilogue->bias + first : NULL;
+        float* z = args->epilogue->preactivation ? args->epilogue->preactivation + first : NULL;
+        cortex_sactivation(args->epilogue->activation, args->m, rows, bias, &args->c[first], args->ldc, z, args->ldc);
+    }
+}
+
+static void reduced_body(void* ctx, size_t begin, size_t end)
+{
+    const reduced_args_t* args = (const reduced_args_t*)ctx;
+    bool widen = args->dtype != TENSOR_INT8 && args->m > QUANTIZED_GEMV_MAX_ROWS;
+    float* block = NULL;
+    if (widen)
+    {
+        block = quantized_workspace_get(args->block * args->k);
+        if (block == NULL)
+        {
+            return;
+        }
+    }
+
+    for (size_t index = begin; index < end; ++index)
+    {
+        size_t first = index * args->block;
+        size_t rows = (first + args->block < args->n) ? args->block : args->n - first;
+        if (args->dtype == TENSOR_INT8)
+        {
+            reduced_int8_block(args, first, rows);
+        }
+        else if (widen)
+        {
+            reduced_float_block(args, first, rows, block);
+        }
+        else
+        {
+            reduced_dot_block(args, first, rows);
+        }
+    }
+}
+
+// C = A * B^T with B stored as n rows of k reduced-precision values; INT8 rows carry one scale each in b_scales
+void cortex_sgemm_reduced(tensor_dtype_t dtype, size_t m, size_t n, size_t k, const float* a, size_t lda, const void* b, const float* b_scales, float* c, size_t ldc, const sgemm_epilogue_t* epilogue)
+{
+    if (m == 0 || n == 0 || k == 0)
+    {
+        return;
+    }
+    if (dtype == TENSOR_FLOAT32)
+    {
+        cortex_sgemm_fused(false, true, m, n, k, 1.0f, a, lda, (const float*)b, k, 0.0f, c, ldc, epilogue);
+        return;
+    }
+    if (dtype == TENSOR_INT8 && b_scales == NULL)
+    {
+        return;
+    }
+
+    reduced_args_t args = {quantized_select_kernels(), dtype, m, n, k, 0, a, lda, NULL, NULL, b, b_scales, c, ldc, epilogue};
+
+    // A block of weight rows is sized to stay resident in L2 while every input row streams past it,
+    // widened blocks are larger so the GEMM packs the inputs once per block rather than once per handful of rows
+    size_t block = QUANTIZED_BLOCK_BYTES / (k * tensor_dtype_size(dtype));
+    block = (block / QUANTIZED_BLOCK_ALIGN) * QUANTIZED_BLOCK_ALIGN;
+    args.block = (block < QUANTIZED_BLOCK_ALIGN) ? QUANTIZED_BLOCK_ALIGN : block;
+    if (dtype != TENSOR_INT8 && m > QUANTIZED_GEMV_MAX_ROWS)
+    {
+        args.block = QUANTIZED_GEMM_BLOCK;
+    }
+
+    // Activations are quantized per row once, outside the parallel region
+    void* scratch = NULL;
+    if (dtype == TENSOR_INT8)
+    {
+        scratch = pool_alloc(m * sizeof(float) + m * k * sizeof(int8_t));
+        if (scratch == NULL)
+        {
+            return;
+        }
+        args.a_scales = (const float*)scratch;
+        args.a_quantized = (const int8_t*)scratch + m * sizeof(float);
+        cortex_squantize_rows(m, k, a, lda, (int8_t*)args.a_quantized, (float*)args.a_scales);
+    }
+
+    size_t num_blocks = (n + args.block - 1) / args.block;
+    cortex_parallel_for(num_blocks, 1, reduced_body, &args);
+
+    if (scratch)
+    {
+        pool_free(scratch);
+    }
+}
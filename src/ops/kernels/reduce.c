@@ -0,0 +1,106 @@
+#include <string.h>
+#include "utils/memory/pool.h"
+#include "utils/thread/parallel.h"
+#include "ops/kernels/reduce.h"
+
+#define COLSUM_MIN_BLOCK_ROWS 64
+#define COLSUM_PARALLEL_MIN_SIZE (1 << 16)
+#define COLSUM_REDUCE_GRAIN 1024
+
+typedef struct colsum_args
+{
+    size_t m;
+    size_t n;
+    const float* a;
+    size_t lda;
+    size_t block_rows;
+    size_t num_blocks;
+    float* partial;
+    float* y;
+} colsum_args_t;
+
+static void colsum_rows(size_t rows, size_t n, const float* a, size_t lda, float* y)
+{
+    size_t i = 0;
+    for (; i + 4 <= rows; i += 4)
+    {
+        const float* row0 = &a[i * lda];
+        const float* row1 = row0 + lda;
+        const float* row2 = row1 + lda;
+        const float* row3 = row2 + lda;
+        for (size_t j = 0; j < n; ++j)
+        {
+            y[j] += (row0[j] + row1[j]) + (row2[j] + row3[j]);
+        }
+    }
+    for (; i < rows; ++i)
+    {
+        const float* row = &a[i * lda];
+        for (size_t j = 0; j < n; ++j)
+        {
+            y[j] += row[j];
+        }
+    }
+}
+
+static void colsum_block_body(void* ctx, size_t begin, size_t end)
+{
+    const colsum_args_t* args = (const colsum_args_t*)ctx;
+    for (size_t block = begin; block < end; ++block)
+    {
+        size_t row = block * args->block_rows;
+        size_t rows = (args->m - row < args->block_rows) ? args->m - row : args->block_rows;
+        float* partial = &args->partial[block * args->n];
+        memset(partial, 0, args->n * sizeof(float));
+        colsum_rows(rows, args->n, &args->a[row * args->lda], args->lda, partial);
+    }
+}
+
+static void colsum_reduce_body(void* ctx, size_t begin, size_t end)
+{
+    const colsum_args_t* args = (const colsum_args_t*)ctx;
+    for (size_t block = 0; block < args->num_blocks; ++block)
+    {
+        const float* partial = &args->partial[block * args->n];
+        for (size_t j = begin; j < end; ++j)
+        {
+            args->y[j] += partial[j];
+        }
+    }
+}
+
+void cortex_scolsum(size_t m, size_t n, const float* a, size_t lda, float* y)
+{
+    if (m == 0 || n == 0)
+    {
+        return;
+    }
+
+    size_t num_threads = cortex_get_num_threads();
+    size_t block_rows = (m + 4 * num_threads - 1) / (4 * num_threads);
+    if (block_rows < COLSUM_MIN_BLOCK_ROWS)
+    {
+        block_rows = COLSUM_MIN_BLOCK_ROWS;
+    }
+    size_t num_blocks = (m + block_rows - 1) / block_rows;
+
+    if (num_threads == 1 || num_blocks == 1 || m * n < COLSUM_PARALLEL_MIN_SIZE)
+    {
+        colsum_rows(m, n, a, lda, y);
+        return;
+    }
+
+    // Every row block sums into its own partial vector, then the partials are folded column-parallel
+    float* partial = (float*)pool_alloc(num_blocks * n * sizeof(float));
+    if (partial == NULL)
+    {
+        colsum_rows(m, n, a, lda, y);
+        return;
+    }
+
+    colsum_args_t args = {m, n, a, lda, block_rows, num_blocks, partial, y};
+    cortex_parallel_for(num_blocks, 1, colsum_block_body, &args);
+    cortex_parallel_for(n, COLSUM_REDUCE_GRAIN, colsum_reduce_body, &args);
+
+    pool_free(partial);
+}
@@ -0,0 +1,108 @@
+#include <string.h>
+#include "utils/memory/pool.h"
+#include "optim/accumulator.h"
+
+#define GRAD_ACCUMULATOR_INITIAL_CAPACITY 8
+
+grad_accumulator_t* grad_accumulator_create(size_t steps)
+{
+    if (steps == 0)
+    {
+        return NULL;
+    }
+
+    grad_accumulator_t *accumulator = (grad_accumulator_t *)pool_alloc(sizeof(grad_accumulator_t));
+    if (accumulator == NULL)
+    {
+        return NULL;
+    }
+
+    accumulator->steps = steps;
+    accumulator->micro_step = 0;
+    accumulator->num_groups = 0;
+    accumulator->capacity = 0;
+    accumulator->groups = NULL;
+
+    return accumulator;
+}
+
+grad_accumulator_status_code_t grad_accumulator_add_parameters(grad_accumulator_t *accumulator, parameters_t *params)
+{
+    if (accumulator == NULL || params == NULL)
+    {
+        return GRAD_ACCUMULATOR_ADD_FAILURE;
+    }
+
+    if (accumulator->num_groups == accumulator->capacity)
+    {
+        size_t capacity = accumulator->capacity ? accumulator->capacity * 2 : GRAD_ACCUMULATOR_INITIAL_CAPACITY;
+        parameters_t **groups = (parameters_t **)pool_alloc(capacity * sizeof(parameters_t *));
+        if (groups == NULL)
+        {
+            return GRAD_ACCUMULATOR_ADD_FAILURE;
+        }
+        if (accumulator->groups)
+        {
+            memcpy(groups, accumulator->groups, accumulator->num_groups * sizeof(parameters_t *));
+            pool_free(accumulator->groups);
+        }
+        accumulator->groups = groups;
+        accumulator->capacity = capacity;
+    }
+
+    accumulator->groups[accumulator->num_groups++] = params;
+    return GRAD_ACCUMULATOR_ADD_SUCCESS;
+}
+
+// Called after every micro-batch backward; on the last one the summed gradients are averaged and the optimizer may step
+bool grad_accumulator_step(grad_accumulator_t *accumulator)
+{
+    if (accumulator == NULL)
+    {
+        return false;
+    }
+    if (++accumulator->micro_step < accumulator->steps)
+    {
+        return false;
+    }
+
+    accumulator->micro_step = 0;
+    float scale = 1.0f / (float)accumulator->steps;
+    for (size_t i = 0; i < accumulator->num_groups; ++i)
+    {
+        parameters_scale_grad(accumulator->groups[i], scale);
+    }
+    return true;
+}
+
+void grad_accumulator_zero_grad(grad_accumulator_t *accumulator)
+{
+    if (accumulator == NULL)
+    {
+        return;
+    }
+
+    accumulator->micro_step = 0;
+    for (size_t i = 0; i < accumulator->num_groups; ++i)
+    {
+        parameters_zero_grad(accumulator->groups[i]);
+    }
+}
+
+grad_accumulator_status_code_t grad_accumulator_destroy(grad_accumulator_t *accumulator)
+{
+    if (accumulator == NULL)
+    {
+        return GRAD_ACCUMULATOR_DESTROY_FAILURE;
+    }
+    if (accumulator->groups && pool_free(accumulator->groups) == POOL_FREE_FAILURE)
+    {
+        return GRAD_ACCUMULATOR_DESTROY_FAILURE;
+    }
+    if (pool_free(accumulator) == POOL_FREE_FAILURE)
+    {
+        return GRAD_ACCUMULATOR_DESTROY_FAILURE;
+    }
+
+    return GRAD_ACCUMULATOR_DESTROY_SUCCESS;
+}
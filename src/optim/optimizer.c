@@ -0,0 +1,349 @@
+#include <math.h>
+#include <string.h>
+#include "utils/memory/pool.h"
+#include "utils/thread/parallel.h"
+#include "utils/profiler/profiler.h"
+#include "ops/kernels/optimizer.h"
+#include "optim/optimizer.h"
+
+#define OPTIMIZER_GRAIN 16384
+#define OPTIMIZER_INITIAL_CAPACITY 8
+
+typedef struct optimizer_args
+{
+    const optimizer_t *optimizer;
+    sgd_update_t sgd;
+    adam_update_t adam;
+    size_t index;
+} optimizer_args_t;
+
+static void *optimizer_alloc_zeroed(size_t size)
+{
+    void *ptr = pool_alloc(size);
+    if (ptr)
+    {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+static optimizer_t* optimizer_create(optimizer_type_t type, float learning_rate, float weight_decay)
+{
+    optimizer_t *optimizer = (optimizer_t *)optimizer_alloc_zeroed(sizeof(optimizer_t));
+    if (optimizer == NULL)
+    {
+        return NULL;
+    }
+
+    optimizer->type = type;
+    optimizer->learning_rate = learning_rate;
+    optimizer->weight_decay = weight_decay;
+    optimizer->multi_tensor = true;
+
+    return optimizer;
+}
+
+optimizer_t* optimizer_sgd_create(float learning_rate, float momentum, bool nesterov, float weight_decay)
+{
+    optimizer_t *optimizer = optimizer_create(OPTIMIZER_SGD, learning_rate, weight_decay);
+    if (optimizer)
+    {
+        optimizer->momentum = momentum;
+        optimizer->nesterov = nesterov;
+    }
+    return optimizer;
+}
+
+optimizer_t* optimizer_adam_create(float learning_rate, float beta1, float beta2, float epsilon, float weight_decay)
+{
+    optimizer_t *optimizer = optimizer_create(OPTIMIZER_ADAM, learning_rate, weight_decay);
+    if (optimizer)
+    {
+        optimizer->beta1 = beta1;
+        optimizer->beta2 = beta2;
+        optimizer->epsilon = epsilon;
+    }
+    return optimizer;
+}
+
+optimizer_t* optimizer_adamw_create(float learning_rate, float beta1, float beta2, float epsilon, float weight_decay)
+{
+    optimizer_t *optimizer = optimizer_adam_create(learning_rate, beta1, beta2, epsilon, weight_decay);
+    if (optimizer)
+    {
+        optimizer->type = OPTIMIZER_ADAMW;
+    }
+    return optimizer;
+}
+
+static bool optimizer_reserve(optimizer_t *optimizer, size_t count)
+{
+    if (count <= optimizer->capacity)
+    {
+        return true;
+    }
+
+    size_t capacity = optimizer->capacity ? optimizer->capacity : OPTIMIZER_INITIAL_CAPACITY;
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+
+    tensor_t **params = (tensor_t **)optimizer_alloc_zeroed(capacity * sizeof(tensor_t *));
+    float **moment1 = (float **)optimizer_alloc_zeroed(capacity * sizeof(float *));
+    float **moment2 = (float **)optimizer_alloc_zeroed(capacity * sizeof(float *));
+    size_t *chunks = (size_t *)optimizer_alloc_zeroed((capacity + 1) * sizeof(size_t));
+    if (params == NULL || moment1 == NULL || moment2 == NULL || chunks == NULL)
+    {
+        void *arrays[] = {params, moment1, moment2, chunks};
+        for (size_t i = 0; i < 4; ++i)
+        {
+            if (arrays[i])
+            {
+                pool_free(arrays[i]);
+            }
+        }
+        return false;
+    }
+
+    if (optimizer->num_params > 0)
+    {
+        memcpy(params, optimizer->params, optimizer->num_params * sizeof(tensor_t *));
+        memcpy(moment1, optimizer->moment1, optimizer->num_params * sizeof(float *));
+        memcpy(moment2, optimizer->moment2, optimizer->num_params * sizeof(float *));
+    }
+    if (optimizer->capacity > 0)
+    {
+        pool_free(optimizer->params);
+        pool_free(optimizer->moment1);
+        pool_free(optimizer->moment2);
+        pool_free(optimizer->chunks);
+    }
+
+    optimizer->params = params;
+    optimizer->moment1 = moment1;
+    optimizer->moment2 = moment2;
+    optimizer->chunks = chunks;
+    optimizer->capacity = capacity;
+    return true;
+}
+
+optimizer_status_code_t optimizer_add_parameters(optimizer_t *optimizer, parameters_t *params)
+{
+    if (optimizer == NULL || params == NULL)
+    {
+        return OPTIMIZER_ADD_FAILURE;
+    }
+    if (!optimizer_reserve(optimizer, optimizer->num_params + params->num_params))
+    {
+        return OPTIMIZER_ADD_FAILURE;
+    }
+
+    for (size_t i = 0; i < params->num_params; ++i)
+    {
+        optimizer->params[optimizer->num_params++] = params->params_array[i];
+    }
+    return OPTIMIZER_ADD_SUCCESS;
+}
+
+// Frozen tensors and tensors that never received a gradient are left alone, and get no optimizer state
+static bool optimizer_is_active(tensor_t *param)
+{
+    return param && !param->frozen && tensor_has_grad(param) && tensor_is_contiguous(param);
+}
+
+static bool optimizer_init_state(optimizer_t *optimizer, size_t index)
+{
+    size_t size = optimizer->params[index]->size * sizeof(float);
+    bool needs_moment1 = optimizer->type != OPTIMIZER_SGD || optimizer->momentum != 0.0f;
+    bool needs_moment2 = optimizer->type != OPTIMIZER_SGD;
+
+    if (needs_moment1 && optimizer->moment1[index] == NULL)
+    {
+        optimizer->moment1[index] = (float *)optimizer_alloc_zeroed(size);
+        if (optimizer->moment1[index] == NULL)
+        {
+            return false;
+        }
+    }
+    if (needs_moment2 && optimizer->moment2[index] == NULL)
+    {
+        optimizer->moment2[index] = (float *)optimizer_alloc_zeroed(size);
+        if (optimizer->moment2[index] == NULL)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void optimizer_update(const optimizer_args_t *args, size_t index, size_t begin, size_t end)
+{
+    const optimizer_t *optimizer = args->optimizer;
+    tensor_t *param = optimizer->params[index];
+    float *moment1 = optimizer->moment1[index] ? optimizer->moment1[index] + begin : NULL;
+
+    if (optimizer->type == OPTIMIZER_SGD)
+    {
+        cortex_ssgd(&args->sgd, end - begin, param->data + begin, param->grad + begin, moment1);
+    }
+    else
+    {
+        cortex_sadam(&args->adam, end - begin, param->data + begin, param->grad + begin, moment1, optimizer->moment2[index] + begin);
+    }
+}
+
+static void optimizer_tensor_body(void *ctx, size_t begin, size_t end)
+{
+    const optimizer_args_t *args = (const optimizer_args_t *)ctx;
+    optimizer_update(args, args->index, begin, end);
+}
+
+// Chunks of all tensors are numbered back to back, so a single launch covers every parameter of the model
+static void optimizer_multi_tensor_body(void *ctx, size_t begin, size_t end)
+{
+    const optimizer_args_t *args = (const optimizer_args_t *)ctx;
+    const optimizer_t *optimizer = args->optimizer;
+    const size_t *chunks = optimizer->chunks;
+
+    size_t low = 0;
+    size_t high = optimizer->num_params;
+    while (low + 1 < high)
+    {
+        size_t mid = (low + high) / 2;
+        if (chunks[mid] <= begin)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    size_t index = low;
+    for (size_t chunk = begin; chunk < end; ++chunk)
+    {
+        while (chunks[index + 1] <= chunk)
+        {
+            ++index;
+        }
+        size_t size = optimizer->params[index]->size;
+        size_t first = (chunk - chunks[index]) * OPTIMIZER_GRAIN;
+        size_t last = (first + OPTIMIZER_GRAIN < size) ? first + OPTIMIZER_GRAIN : size;
+        optimizer_update(args, index, first, last);
+    }
+}
+
+static optimizer_status_code_t optimizer_apply(optimizer_t *optimizer, size_t *active)
+{
+    if (optimizer->num_params == 0)
+    {
+        return OPTIMIZER_STEP_SUCCESS;
+    }
+
+    optimizer->chunks[0] = 0;
+    for (size_t i = 0; i < optimizer->num_params; ++i)
+    {
+        tensor_t *param = optimizer->params[i];
+        size_t chunks = 0;
+        if (optimizer_is_active(param))
+        {
+            if (!optimizer_init_state(optimizer, i))
+            {
+                return OPTIMIZER_STEP_FAILURE;
+            }
+            chunks = (param->size + OPTIMIZER_GRAIN - 1) / OPTIMIZER_GRAIN;
+            *active += param->size;
+        }
+        optimizer->chunks[i + 1] = optimizer->chunks[i] + chunks;
+    }
+
+    optimizer->step++;
+
+    // Adam's bias corrections are folded into the step size and epsilon, so the kernel stays a single expression
+    float correction1 = 1.0f - powf(optimizer->beta1, (float)optimizer->step);
+    float correction2 = sqrtf(1.0f - powf(optimizer->beta2, (float)optimizer->step));
+    bool decoupled = optimizer->type == OPTIMIZER_ADAMW;
+
+    optimizer_args_t args;
+    args.optimizer = optimizer;
+    args.index = 0;
+    args.sgd = (sgd_update_t){optimizer->learning_rate, optimizer->momentum, optimizer->weight_decay, optimizer->nesterov, optimizer->zero_grad};
+    args.adam = (adam_update_t){
+        optimizer->beta1,
+        optimizer->beta2,
+        optimizer->learning_rate * correction2 / correction1,
+        optimizer->epsilon * correction2,
+        decoupled ? 0.0f : optimizer->weight_decay,
+        decoupled ? 1.0f - optimizer->learning_rate * optimizer->weight_decay : 1.0f,
+        optimizer->zero_grad
+    };
+
+    if (optimizer->multi_tensor)
+    {
+        cortex_parallel_for(optimizer->chunks[optimizer->num_params], 1, optimizer_multi_tensor_body, &args);
+        return OPTIMIZER_STEP_SUCCESS;
+    }
+
+    for (size_t i = 0; i < optimizer->num_params; ++i)
+    {
+        if (optimizer->chunks[i + 1] > optimizer->chunks[i])
+        {
+            args.index = i;
+            cortex_parallel_for(optimizer->params[i]->size, OPTIMIZER_GRAIN, optimizer_tensor_body, &args);
+        }
+    }
+    return OPTIMIZER_STEP_SUCCESS;
+}
+
+optimizer_status_code_t optimizer_step(optimizer_t *optimizer)
+{
+    if (optimizer == NULL)
+    {
+        return OPTIMIZER_STEP_FAILURE;
+    }
+
+    profiler_scope_t scope = profiler_begin();
+    size_t active = 0;
+    optimizer_status_code_t status = optimizer_apply(optimizer, &active);
+
+    // Adam reads the gradient and rewrites the parameter and both moments, SGD keeps a single momentum buffer
+    bool adam = optimizer->type != OPTIMIZER_SGD;
+    profiler_end(&scope, "optimizer_step", NULL, (adam ? 12 : 4) * active, (adam ? 7 : 5) * active * sizeof(float));
+
+    return status;
+}
+
+optimizer_status_code_t optimizer_destroy(optimizer_t *optimizer)
+{
+    if (optimizer == NULL)
+    {
+        return OPTIMIZER_DESTROY_FAILURE;
+    }
+
+    for (size_t i = 0; i < optimizer->num_params; ++i)
+    {
+        if (optimizer->moment1[i] && pool_free(optimizer->moment1[i]) == POOL_FREE_FAILURE)
+        {
+            return OPTIMIZER_DESTROY_FAILURE;
+        }
+        if (optimizer->moment2[i] && pool_free(optimizer->moment2[i]) == POOL_FREE_FAILURE)
+        {
+            return OPTIMIZER_DESTROY_FAILURE;
+        }
+    }
+    if (optimizer->capacity > 0)
+    {
+        pool_free(optimizer->params);
+        pool_free(optimizer->moment1);
+        pool_free(optimizer->moment2);
+        pool_free(optimizer->chunks);
+    }
+    if (pool_free(optimizer) == POOL_FREE_FAILURE)
+    {
+        return OPTIMIZER_DESTROY_FAILURE;
+    }
+
+    return OPTIMIZER_DESTROY_SUCCESS;
+}
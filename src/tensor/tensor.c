@@ -1,20 +1,187 @@
 #include <string.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include "tensor/tensor.h"
+#include "autograd/mode.h"
 #include "utils/memory/pool.h"
+#include "utils/memory/arena.h"
+#include "utils/thread/parallel.h"
+#include "ops/kernels/elementwise.h"
 
-static tensor_t* tensor_create(size_t ndim, const size_t shape[]) 
+#define FILL_GRAIN 16384
+#define RAND_BLOCK 4096
+#define TENSOR_ALIGNMENT 64
+
+typedef struct fill_args
 {
-    if (ndim == 0 || ndim > MAX_DIMS)
+    float* data;
+    float value;
+    float limit;
+    uint64_t seed;
+} fill_args_t;
+
+static void tensor_fill_body(void* ctx, size_t begin, size_t end)
+{
+    const fill_args_t* args = (const fill_args_t*)ctx;
+    float* data = args->data;
+    float value = args->value;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        data[i] = value;
+    }
+}
+
+static inline uint64_t splitmix64(uint64_t* state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Every RAND_BLOCK elements get their own generator so the values do not depend on how the range is split
+static void tensor_rand_body(void* ctx, size_t begin, size_t end)
+{
+    const fill_args_t* args = (const fill_args_t*)ctx;
+    float* data = args->data;
+    float limit = args->limit;
+
+    for (size_t block = begin / RAND_BLOCK; block * RAND_BLOCK < end; ++block)
+    {
+        uint64_t state = args->seed ^ (block * 0xD1B54A32D192ED03ULL);
+        size_t first = (block * RAND_BLOCK > begin) ? block * RAND_BLOCK : begin;
+        size_t last = ((block + 1) * RAND_BLOCK < end) ? (block + 1) * RAND_BLOCK : end;
+        for (size_t i = first; i < last; ++i)
+        {
+            float unit = (float)(splitmix64(&state) >> 40) * (1.0f / 16777216.0f);
+            data[i] = 2.0f * limit * unit - limit;
+        }
+    }
+}
+
+// Inside an arena scope tensors live until arena_reset, everything else comes from the pool
+static void* tensor_alloc(size_t size)
+{
+    return arena_is_active() ? arena_alloc(size) : pool_alloc(size);
+}
+
+static void tensor_release(void* ptr)
+{
+    if (ptr && !arena_owns(ptr))
+    {
+        pool_free(ptr);
+    }
+}
+
+// The pool only guarantees 16 bytes, so aligned buffers are over-allocated and keep their block just below the data
+static float* buffer_align(uint8_t* block)
+{
+    if (block == NULL)
     {
         return NULL;
     }
-    if (shape == NULL)
+    uintptr_t data = ((uintptr_t)block + sizeof(void*) + TENSOR_ALIGNMENT - 1) & ~(uintptr_t)(TENSOR_ALIGNMENT - 1);
+    ((void**)data)[-1] = block;
+    return (float*)data;
+}
+
+static void* buffer_block(const tensor_storage_t* storage, float* buffer)
+{
+    return storage->aligned ? ((void**)buffer)[-1] : (void*)buffer;
+}
+
+static size_t buffer_bytes(size_t size, bool aligned)
+{
+    return size * sizeof(float) + (aligned ? TENSOR_ALIGNMENT + sizeof(void*) : 0);
+}
+
+static float* buffer_alloc(size_t size, bool aligned)
+{
+    void* block = tensor_alloc(buffer_bytes(size, aligned));
+    return aligned ? buffer_align((uint8_t*)block) : (float*)block;
+}
+
+// Reduced-precision storage is still allocated in whole floats, size counts elements of the storage's dtype
+static tensor_storage_t* storage_create(size_t size, tensor_dtype_t dtype, bool zero, bool aligned)
+{
+    tensor_storage_t* storage = (tensor_storage_t*)tensor_alloc(sizeof(tensor_storage_t));
+    if (storage == NULL)
+    {
+        return NULL;
+    }
+
+    size_t bytes = size * tensor_dtype_size(dtype);
+    storage->data = buffer_alloc((bytes + sizeof(float) - 1) / sizeof(float), aligned);
+    if (storage->data == NULL)
+    {
+        tensor_release(storage);
+        return NULL;
+    }
+    if (zero)
+    {
+        memset(storage->data, 0, bytes);
+    }
+
+    storage->grad = NULL;
+    storage->size = size;
+    storage->dtype = dtype;
+    storage->borrowed = false;
+    storage->aligned = aligned;
+    atomic_init(&storage->refcount, 1);
+
+    return storage;
+}
+
+// The gradient covers the whole storage so every view of it shares one buffer, in the arena if the storage is there
+static float* storage_grad_create(tensor_storage_t* storage)
+{
+    size_t bytes = buffer_bytes(storage->size, storage->aligned);
+    void* block = arena_owns(storage) ? arena_alloc(bytes) : pool_alloc(bytes);
+    float* grad = storage->aligned ? buffer_align((uint8_t*)block) : (float*)block;
+    if (grad == NULL)
     {
         return NULL;
     }
+    memset(grad, 0, storage->size * sizeof(float));
 
-    tensor_t* tensor = (tensor_t*)pool_alloc(sizeof(tensor_t));
+    storage->grad = grad;
+    return grad;
+}
+
+// Arena storage is reclaimed by arena_reset, pool storage by whichever tensor drops the last reference
+static tensor_status_code_t storage_release(tensor_storage_t* storage)
+{
+    if (arena_owns(storage))
+    {
+        return TENSOR_DESTROY_SUCCESS;
+    }
+    if (atomic_fetch_sub(&storage->refcount, 1) != 1)
+    {
+        return TENSOR_DESTROY_SUCCESS;
+    }
+    if (storage->borrowed)
+    {
+        return (pool_free(storage) == POOL_FREE_FAILURE) ? TENSOR_DESTROY_FAILURE : TENSOR_DESTROY_SUCCESS;
+    }
+    if (pool_free(buffer_block(storage, storage->data)) == POOL_FREE_FAILURE)
+    {
+        return TENSOR_DESTROY_FAILURE;
+    }
+    if (storage->grad && pool_free(buffer_block(storage, storage->grad)) == POOL_FREE_FAILURE)
+    {
+        return TENSOR_DESTROY_FAILURE;
+    }
+    if (pool_free(storage) == POOL_FREE_FAILURE)
+    {
+        return TENSOR_DESTROY_FAILURE;
+    }
+    return TENSOR_DESTROY_SUCCESS;
+}
+
+static tensor_t* tensor_header(size_t ndim, const size_t shape[], const size_t stride[])
+{
+    tensor_t* tensor = (tensor_t*)tensor_alloc(sizeof(tensor_t));
 
     if (tensor == NULL)
     {
@@ -22,19 +189,24 @@ static tensor_t* tensor_create(size_t ndim, const size_t shape[])
     }
 
     size_t size = 1;
-    size_t stride[MAX_DIMS];
-    for (size_t i = ndim; i > 0; --i) 
+    for (size_t i = 0; i < ndim; ++i)
     {
-        stride[i - 1] = size;
-        size *= shape[i - 1];
+        size *= shape[i];
     }
     tensor->ndim = ndim;
     tensor->size = size;
     tensor->frozen = false;
+    tensor->dtype = TENSOR_FLOAT32;
+    tensor->visit = 0;
+    tensor->data = NULL;
+    tensor->grad = NULL;
+    tensor->offset = 0;
+    tensor->storage = NULL;
     tensor->context = NULL;
     tensor->grad_a = NULL;
     tensor->grad_b = NULL;
     tensor->backward = NULL;
+    tensor->release = NULL;
     memcpy(tensor->shape, shape, ndim * sizeof(size_t));
     memcpy(tensor->stride, stride, ndim * sizeof(size_t));
     
@@ -44,45 +216,299 @@ static tensor_t* tensor_create(size_t ndim, const size_t shape[])
         tensor->stride[i] = 1;
     }
 
-    tensor->data = (float*)pool_alloc(size * sizeof(float));
-    if (tensor->data == NULL)
+    return tensor;
+}
+
+static tensor_t* tensor_create(size_t ndim, const size_t shape[], tensor_dtype_t dtype, bool zero, bool aligned)
+{
+    if (ndim == 0 || ndim > MAX_DIMS)
+    {
+        return NULL;
+    }
+    if (shape == NULL)
+    {
+        return NULL;
+    }
+
+    size_t size = 1;
+    size_t stride[MAX_DIMS];
+    for (size_t i = ndim; i > 0; --i) 
+    {
+        stride[i - 1] = size;
+        size *= shape[i - 1];
+    }
+
+    tensor_t* tensor = tensor_header(ndim, shape, stride);
+    if (tensor == NULL)
     {
-        pool_free(tensor);
         return NULL;
     }
-    memset(tensor->data, 0, size * sizeof(float));
 
-    tensor->grad = (float*)pool_alloc(size * sizeof(float));
-    if (tensor->grad == NULL)
+    tensor->storage = storage_create(size, dtype, zero, aligned);
+    if (tensor->storage == NULL)
     {
-        pool_free(tensor->data);
-        pool_free(tensor);
+        tensor_release(tensor);
         return NULL;
     }
-    memset(tensor->grad, 0, size * sizeof(float));
+    tensor->data = tensor->storage->data;
+    tensor->dtype = dtype;
 
     return tensor;
 }
 
-tensor_status_code_t tensor_destroy(tensor_t* tensor) 
+tensor_t* tensor_view(const tensor_t* base, const size_t* shape, const size_t* stride, size_t ndim, size_t offset)
+{
+    if (base == NULL || shape == NULL || stride == NULL || base->dtype != TENSOR_FLOAT32)
+    {
+        return NULL;
+    }
+    if (ndim == 0 || ndim > MAX_DIMS)
+    {
+        return NULL;
+    }
+
+    // Every element the view can address has to lie inside the base storage
+    size_t last = base->offset + offset;
+    bool empty = false;
+    for (size_t i = 0; i < ndim; ++i)
+    {
+        empty = empty || shape[i] == 0;
+        last += (shape[i] > 0) ? (shape[i] - 1) * stride[i] : 0;
+    }
+    if (!empty && last >= base->storage->size)
+    {
+        return NULL;
+    }
+
+    tensor_t* view = tensor_header(ndim, shape, stride);
+    if (view == NULL)
+    {
+        return NULL;
+    }
+
+    // Views made inside an arena scope die with the step, so they do not pin their storage
+    if (!arena_owns(view))
+    {
+        atomic_fetch_add(&base->storage->refcount, 1);
+    }
+    view->storage = base->storage;
+    view->offset = base->offset + offset;
+    view->data = view->storage->data + view->offset;
+    view->frozen = base->frozen;
+    tensor_has_grad(view);
+
+    return view;
+}
+
+// Copies a tensor's data and gradient into base at offset and turns it into a view there, keeping every pointer to it valid
+bool tensor_move_into(tensor_t* tensor, const tensor_t* base, size_t offset)
+{
+    if (tensor == NULL || base == NULL || !tensor_is_contiguous(tensor) || arena_owns(tensor) || arena_owns(base))
+    {
+        return false;
+    }
+    if (tensor->dtype != TENSOR_FLOAT32 || base->dtype != TENSOR_FLOAT32)
+    {
+        return false;
+    }
+    tensor_storage_t* storage = base->storage;
+    offset += base->offset;
+    if (offset + tensor->size > storage->size || storage->borrowed)
+    {
+        return false;
+    }
+
+    if (tensor_has_grad(tensor) && storage->grad == NULL && storage_grad_create(storage) == NULL)
+    {
+        return false;
+    }
+    memmove(storage->data + offset, tensor->data, tensor->size * sizeof(float));
+    if (tensor->grad)
+    {
+        memmove(storage->grad + offset, tensor->grad, tensor->size * sizeof(float));
+    }
+
+    atomic_fetch_add(&storage->refcount, 1);
+    if (storage_release(tensor->storage) == TENSOR_DESTROY_FAILURE)
+    {
+        atomic_fetch_sub(&storage->refcount, 1);
+        return false;
+    }
+
+    size_t stride = 1;
+    for (size_t i = tensor->ndim; i > 0; --i)
+    {
+        tensor->stride[i - 1] = stride;
+        stride *= tensor->shape[i - 1];
+    }
+    tensor->storage = storage;
+    tensor->offset = offset;
+    tensor->data = storage->data + offset;
+    tensor->grad = NULL;
+    tensor_has_grad(tensor);
+
+    return true;
+}
+
+// Points a contiguous tensor at an external buffer of its size, the buffer has to outlive the tensor
+bool tensor_borrow(tensor_t* tensor, float* buffer)
+{
+    if (tensor == NULL || buffer == NULL || !tensor_is_contiguous(tensor) || arena_owns(tensor))
+    {
+        return false;
+    }
+
+    tensor_storage_t* storage = (tensor_storage_t*)pool_alloc(sizeof(tensor_storage_t));
+    if (storage == NULL)
+    {
+        return false;
+    }
+    storage->data = buffer;
+    storage->grad = NULL;
+    storage->size = tensor->size;
+    storage->dtype = tensor->dtype;
+    storage->borrowed = true;
+    storage->aligned = false;
+    atomic_init(&storage->refcount, 1);
+
+    if (tensor->storage && storage_release(tensor->storage) == TENSOR_DESTROY_FAILURE)
+    {
+        pool_free(storage);
+        return false;
+    }
+
+    size_t stride = 1;
+    for (size_t i = tensor->ndim; i > 0; --i)
+    {
+        tensor->stride[i - 1] = stride;
+        stride *= tensor->shape[i - 1];
+    }
+    tensor->storage = storage;
+    tensor->offset = 0;
+    tensor->data = buffer;
+    tensor->grad = NULL;
+
+    return true;
+}
+
+bool tensor_is_contiguous(const tensor_t* tensor)
 {
     if (tensor == NULL)
     {
-        return TENSOR_DESTROY_FAILURE;
+        return false;
     }
-    if (tensor->data)
+
+    size_t expected = 1;
+    for (size_t i = tensor->ndim; i > 0; --i)
     {
-        if (pool_free(tensor->data) == POOL_FREE_FAILURE)
+        if (tensor->shape[i - 1] != 1 && tensor->stride[i - 1] != expected)
         {
-            return TENSOR_DESTROY_FAILURE;
+            return false;
         }
+        expected *= tensor->shape[i - 1];
     }
-    if (tensor->grad)
+    return true;
+}
+
+// Shapes are matched from the right, each pair of dimensions has to agree or contain a one
+bool tensor_broadcast_shape(const tensor_t* a, const tensor_t* b, size_t* shape, size_t* ndim)
+{
+    if (a == NULL || b == NULL || shape == NULL || ndim == NULL)
+    {
+        return false;
+    }
+
+    size_t out_ndim = (a->ndim > b->ndim) ? a->ndim : b->ndim;
+    for (size_t i = 0; i < out_ndim; ++i)
     {
-        if (pool_free(tensor->grad) == POOL_FREE_FAILURE)
+        size_t a_dim = (i < out_ndim - a->ndim) ? 1 : a->shape[i - (out_ndim - a->ndim)];
+        size_t b_dim = (i < out_ndim - b->ndim) ? 1 : b->shape[i - (out_ndim - b->ndim)];
+        if (a_dim != b_dim && a_dim != 1 && b_dim != 1)
         {
-            return TENSOR_DESTROY_FAILURE;
+            return false;
         }
+        shape[i] = (a_dim == 1) ? b_dim : a_dim;
+    }
+    *ndim = out_ndim;
+    return true;
+}
+
+// Strides that read the tensor as if it had been expanded to shape, repeated dimensions get a zero stride
+bool tensor_broadcast_strides(const tensor_t* tensor, const size_t* shape, size_t ndim, size_t* stride)
+{
+    if (tensor == NULL || shape == NULL || stride == NULL)
+    {
+        return false;
+    }
+    if (ndim < tensor->ndim || ndim > MAX_DIMS)
+    {
+        return false;
+    }
+
+    size_t leading = ndim - tensor->ndim;
+    for (size_t i = 0; i < ndim; ++i)
+    {
+        if (i < leading)
+        {
+            stride[i] = 0;
+        }
+        else if (tensor->shape[i - leading] == shape[i])
+        {
+            stride[i] = tensor->stride[i - leading];
+        }
+        else if (tensor->shape[i - leading] == 1)
+        {
+            stride[i] = 0;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+float* tensor_grad(tensor_t* tensor)
+{
+    if (tensor == NULL || tensor->frozen || tensor->dtype != TENSOR_FLOAT32)
+    {
+        return NULL;
+    }
+    if (tensor_has_grad(tensor))
+    {
+        return tensor->grad;
+    }
+    if (!cortex_is_grad_enabled() || tensor->storage->borrowed)
+    {
+        return NULL;
+    }
+
+    if (storage_grad_create(tensor->storage) == NULL)
+    {
+        return NULL;
+    }
+
+    tensor->grad = tensor->storage->grad + tensor->offset;
+    return tensor->grad;
+}
+
+tensor_status_code_t tensor_destroy(tensor_t* tensor) 
+{
+    if (tensor == NULL)
+    {
+        return TENSOR_DESTROY_FAILURE;
+    }
+    if (arena_owns(tensor))
+    {
+        return TENSOR_DESTROY_SUCCESS;
+    }
+    if (tensor->release)
+    {
+        tensor->release(tensor);
+    }
+    if (tensor->storage && storage_release(tensor->storage) == TENSOR_DESTROY_FAILURE)
+    {
+        return TENSOR_DESTROY_FAILURE;
     }
     if (pool_free(tensor) == POOL_FREE_FAILURE)
     {
@@ -93,7 +519,7 @@ tensor_status_code_t tensor_destroy(tensor_t* tensor)
 
 tensor_t* tensor_from_array(const float* array, const size_t* shape, size_t ndim) 
 {
-    tensor_t *tensor = tensor_create(ndim, shape);
+    tensor_t *tensor = tensor_create(ndim, shape, TENSOR_FLOAT32, false, false);
     if (tensor == NULL)
     {
         return NULL;
@@ -104,35 +530,130 @@ tensor_t* tensor_from_array(const float* array, const size_t* shape, size_t ndim
 
 tensor_t* tensor_rand(const size_t* shape, size_t ndim, float limit) 
 {
-    tensor_t *tensor = tensor_create(ndim, shape);
+    tensor_t *tensor = tensor_create(ndim, shape, TENSOR_FLOAT32, false, false);
     if (tensor == NULL)
     {
         return NULL;
     }
-    for (size_t i = 0; i < tensor->size; i++) 
+    fill_args_t args = {tensor->data, 0.0f, limit, ((uint64_t)rand() << 32) ^ (uint64_t)rand()};
+    cortex_parallel_for(tensor->size, RAND_BLOCK, tensor_rand_body, &args);
+    return tensor;
+}
+
+tensor_t* tensor_full(const size_t* shape, size_t ndim, float value) 
+{
+    tensor_t *tensor = tensor_create(ndim, shape, TENSOR_FLOAT32, false, false);
+    if (tensor == NULL)
     {
-        tensor->data[i] = 2.0f * limit * ((float)rand() / RAND_MAX) - limit;
+        return NULL;
     }
+    fill_args_t args = {tensor->data, value, 0.0f, 0};
+    cortex_parallel_for(tensor->size, FILL_GRAIN, tensor_fill_body, &args);
     return tensor;
 }
 
-tensor_t* tensor_full(const size_t* shape, size_t ndim, float value) 
+// For outputs that are overwritten in full, skips zeroing the buffer
+tensor_t* tensor_empty(const size_t* shape, size_t ndim)
 {
-    tensor_t *tensor = tensor_create(ndim, shape);
+    return tensor_create(ndim, shape, TENSOR_FLOAT32, false, false);
+}
+
+// A header without storage, data stays NULL until tensor_allocate or tensor_borrow gives the tensor its elements
+tensor_t* tensor_placeholder(const size_t* shape, size_t ndim)
+{
+    if (shape == NULL || ndim == 0 || ndim > MAX_DIMS)
+    {
+        return NULL;
+    }
+
+    size_t size = 1;
+    size_t stride[MAX_DIMS];
+    for (size_t i = ndim; i > 0; --i)
+    {
+        stride[i - 1] = size;
+        size *= shape[i - 1];
+    }
+    return tensor_header(ndim, shape, stride);
+}
+
+// Gives a placeholder uninitialized storage of its size
+bool tensor_allocate(tensor_t* tensor)
+{
+    if (tensor == NULL || tensor->storage != NULL)
+    {
+        return false;
+    }
+
+    tensor->storage = storage_create(tensor->size, tensor->dtype, false, false);
+    if (tensor->storage == NULL)
+    {
+        return false;
+    }
+    tensor->data = tensor->storage->data;
+    return true;
+}
+
+// Data and gradient start on a cache line, for flat buffers that many tensors are moved into
+tensor_t* tensor_zeros_aligned(const size_t* shape, size_t ndim)
+{
+    return tensor_create(ndim, shape, TENSOR_FLOAT32, true, true);
+}
+
+// Reduced-precision tensors hold raw elements of their dtype behind data and only serve as inputs to the kernels that know it
+tensor_t* tensor_empty_dtype(const size_t* shape, size_t ndim, tensor_dtype_t dtype)
+{
+    if (dtype >= TENSOR_NUM_DTYPES)
+    {
+        return NULL;
+    }
+    return tensor_create(ndim, shape, dtype, false, true);
+}
+
+// The buffer stays owned by the caller, gradients for borrowed storage have to be attached by the caller as well
+tensor_t* tensor_from_buffer(float* buffer, const size_t* shape, size_t ndim)
+{
+    if (buffer == NULL || shape == NULL || ndim == 0 || ndim > MAX_DIMS)
+    {
+        return NULL;
+    }
+
+    size_t size = 1;
+    size_t stride[MAX_DIMS];
+    for (size_t i = ndim; i > 0; --i)
+    {
+        stride[i - 1] = size;
+        size *= shape[i - 1];
+    }
+
+    tensor_t* tensor = tensor_header(ndim, shape, stride);
     if (tensor == NULL)
     {
         return NULL;
     }
-    for (size_t i = 0; i < tensor->size; i++)
+
+    tensor_storage_t* storage = (tensor_storage_t*)tensor_alloc(sizeof(tensor_storage_t));
+    if (storage == NULL)
     {
-        tensor->data[i] = value;
+        tensor_release(tensor);
+        return NULL;
     }
+    storage->data = buffer;
+    storage->grad = NULL;
+    storage->size = size;
+    storage->dtype = TENSOR_FLOAT32;
+    storage->borrowed = true;
+    storage->aligned = false;
+    atomic_init(&storage->refcount, 1);
+
+    tensor->storage = storage;
+    tensor->data = buffer;
+
     return tensor;
 }
 
 tensor_t* tensor_zeros(const size_t* shape, size_t ndim) 
 {
-    tensor_t *tensor = tensor_create(ndim, shape);
+    tensor_t *tensor = tensor_create(ndim, shape, TENSOR_FLOAT32, true, false);
     if (tensor == NULL)
     {
         return NULL;
@@ -151,7 +672,7 @@ tensor_t* tensor_like(const tensor_t *tensor)
     {
         return NULL;
     }
-    return tensor_create(tensor->ndim, tensor->shape);
+    return tensor_create(tensor->ndim, tensor->shape, TENSOR_FLOAT32, true, false);
 }
 
 tensor_t* tensor_clone(const tensor_t* tensor)
@@ -160,14 +681,22 @@ tensor_t* tensor_clone(const tensor_t* tensor)
     {
         return NULL;
     }
-    tensor_t *clone = tensor_create(tensor->ndim, tensor->shape);
+    tensor_t *clone = tensor_create(tensor->ndim, tensor->shape, tensor->dtype, false, tensor->dtype != TENSOR_FLOAT32);
     if (clone == NULL)
     {
         return NULL;
     }
-    size_t data_size = tensor->size * sizeof(float);
-    memcpy(clone->data, tensor->data, data_size);
-    memcpy(clone->grad, tensor->grad, data_size);
+    if (tensor->dtype != TENSOR_FLOAT32)
+    {
+        memcpy(clone->data, tensor->data, tensor->size * tensor_dtype_size(tensor->dtype));
+        return clone;
+    }
+
+    cortex_scopy(tensor->ndim, tensor->shape, tensor->data, tensor->stride, clone->data);
+    if (tensor_has_grad((tensor_t*)tensor) && tensor_grad(clone))
+    {
+        cortex_scopy(tensor->ndim, tensor->shape, tensor->grad, tensor->stride, clone->grad);
+    }
 
     return clone;
 }
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include <unistd.h>
+#include <sys/mman.h>
+#include "utils/memory/pool.h"
+#include "utils/memory/arena.h"
+#include "utils/profiler/profiler.h"
+
+#define ARENA_ALIGNMENT 64
+#define ARENA_ALIGN_UP(x) (((x) + (ARENA_ALIGNMENT - 1)) & ~((size_t)ARENA_ALIGNMENT - 1))
+#define ARENA_RESERVE_SIZE ((size_t)64 << 30)
+
+static _Thread_local memory_arena_t* thread_arena = NULL;
+
+static size_t arena_page_align(size_t size)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (size + page - 1) & ~(page - 1);
+}
+
+// Chunks are committed back to back inside one reserved range, so the arena is always a single contiguous region
+static bool arena_commit(memory_arena_t* arena, size_t size)
+{
+    size = arena_page_align(size);
+    if (size > arena->reserved - arena->committed)
+    {
+        return false;
+    }
+    if (mprotect(arena->base + arena->committed, size, PROT_READ | PROT_WRITE) != 0)
+    {
+        return false;
+    }
+    arena->committed += size;
+    return true;
+}
+
+memory_arena_status_code_t arena_init(size_t chunk_size)
+{
+    if (thread_arena)
+    {
+        return ARENA_CREATION_FAILURE;
+    }
+
+    memory_arena_t* arena = (memory_arena_t*)pool_alloc(sizeof(memory_arena_t));
+    if (arena == NULL)
+    {
+        return ARENA_CREATION_FAILURE;
+    }
+
+    // Address space is reserved up front and only committed chunk by chunk as the arena grows
+    void* base = mmap(NULL, ARENA_RESERVE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        pool_free(arena);
+        return ARENA_CREATION_FAILURE;
+    }
+    arena->base = (uint8_t*)base;
+    arena->reserved = ARENA_RESERVE_SIZE;
+    arena->committed = 0;
+    arena->chunk_size = arena_page_align(ARENA_ALIGN_UP(chunk_size ? chunk_size : 1));
+    arena->used = 0;
+    arena->peak = 0;
+    arena->depth = 0;
+
+    if (!arena_commit(arena, arena->chunk_size))
+    {
+        munmap(arena->base, arena->reserved);
+        pool_free(arena);
+        return ARENA_CREATION_FAILURE;
+    }
+
+    thread_arena = arena;
+    return ARENA_CREATION_SUCCESS;
+}
+
+memory_arena_status_code_t arena_destroy()
+{
+    memory_arena_t* arena = thread_arena;
+    if (arena == NULL)
+    {
+        return ARENA_DESTROY_FAILURE;
+    }
+
+    munmap(arena->base, arena->reserved);
+    thread_arena = NULL;
+    if (pool_free(arena) == POOL_FREE_FAILURE)
+    {
+        return ARENA_DESTROY_FAILURE;
+    }
+    return ARENA_DESTROY_SUCCESS;
+}
+
+void* arena_alloc(size_t size)
+{
+    memory_arena_t* arena = thread_arena;
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    size = ARENA_ALIGN_UP(size ? size : 1);
+    profiler_count_allocation(size);
+
+    if (size > arena->committed - arena->used)
+    {
+        size_t needed = size - (arena->committed - arena->used);
+        if (!arena_commit(arena, (needed > arena->chunk_size) ? needed : arena->chunk_size))
+        {
+            return NULL;
+        }
+    }
+
+    void* ptr = arena->base + arena->used;
+    arena->used += size;
+    if (arena->used > arena->peak)
+    {
+        arena->peak = arena->used;
+    }
+
+    return ptr;
+}
+
+void arena_reset()
+{
+    memory_arena_t* arena = thread_arena;
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    // Committed chunks stay mapped, so a step that grew the arena is served without new commits from now on
+    arena->used = 0;
+}
+
+void arena_begin()
+{
+    if (thread_arena)
+    {
+        thread_arena->depth++;
+    }
+}
+
+void arena_end()
+{
+    if (thread_arena && thread_arena->depth > 0)
+    {
+        thread_arena->depth--;
+    }
+}
+
+bool arena_is_active()
+{
+    return thread_arena && thread_arena->depth > 0;
+}
+
+// One range check against the committed region, the pointer itself is never dereferenced
+bool arena_owns(const void* ptr)
+{
+    memory_arena_t* arena = thread_arena;
+    if (arena == NULL)
+    {
+        return false;
+    }
+
+    return (size_t)((const uint8_t*)ptr - arena->base) < arena->committed;
+}
+
+size_t arena_get_used_memory()
+{
+    return thread_arena ? thread_arena->used : 0;
+}
+
+size_t arena_get_peak_memory()
+{
+    return thread_arena ? thread_arena->peak : 0;
+}
@@ -1,14 +1,245 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include "utils/memory/pool.h"
+#include "utils/profiler/profiler.h"
 
 #define ALIGNMENT 16
 #define ALIGN_UP(x) (((x) + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1))
 
-memory_pool_t* global_memory_pool = NULL;
+#define HEADER_SIZE ALIGN_UP(sizeof(memory_block_t))
+#define SMALL_MAX (POOL_NUM_SMALL_CLASSES * ALIGNMENT)
+#define LARGE_MIN_LOG2 9
+#define MIN_SPLIT_SIZE (HEADER_SIZE + SMALL_MAX + ALIGNMENT)
+#define HISTOGRAM_MIN_LOG2 4
+#define PRINT_MAX_TAGS 32
 
-static memory_pool_t* pool_create(size_t size) 
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define NUMA_MPOL_BIND 2
+#define NUMA_MASK_BITS 1024
+#define NUMA_MASK_WORD_BITS (8 * sizeof(unsigned long))
+
+#define BLOCK_FREE ((size_t)1)
+#define BLOCK_SMALL ((size_t)2)
+#define BLOCK_FLAGS (BLOCK_FREE | BLOCK_SMALL)
+#define BLOCK_MAGIC ((uintptr_t)0x636f72746578706cULL)
+
+#define BLOCK_PAYLOAD(block) ((block)->size & ~BLOCK_FLAGS)
+#define BLOCK_TOTAL(block) (HEADER_SIZE + BLOCK_PAYLOAD(block))
+#define BLOCK_DATA(block) ((void*)((uint8_t*)(block) + HEADER_SIZE))
+#define BLOCK_FROM_DATA(ptr) ((memory_block_t*)((uint8_t*)(ptr) - HEADER_SIZE))
+#define BLOCK_CHECK(block) ((uintptr_t)(block) ^ (uintptr_t)(block)->pool ^ BLOCK_MAGIC)
+
+// Free blocks keep their list links in the payload, so live blocks only pay for the header
+typedef struct free_links
+{
+    memory_block_t* next;
+    memory_block_t* prev;
+} free_links_t;
+
+#define BLOCK_LINKS(block) ((free_links_t*)BLOCK_DATA(block))
+
+// Every thread allocates from its own heap of arenas; frees from other threads are queued on the owner
+typedef struct memory_heap
+{
+    memory_pool_t* head;
+    memory_pool_t* tail;
+    memory_pool_t* recent;
+    pool_backing_t backing;
+    int numa_node;
+    bool numa_required;
+    size_t used;
+    size_t peak;
+    size_t allocations;
+    size_t frees;
+    _Atomic(memory_block_t*) remote_free;
+    atomic_bool abandoned;
+    struct memory_heap* next;
+} memory_heap_t;
+
+_Thread_local memory_pool_t* global_memory_pool = NULL;
+
+static _Thread_local memory_heap_t* thread_heap = NULL;
+static _Thread_local size_t thread_heap_generation = 0;
+static _Thread_local const char* thread_tag = NULL;
+
+static pthread_mutex_t heap_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static memory_heap_t* heap_registry = NULL;
+static size_t heap_default_size = 0;
+static pool_options_t heap_default_options = {POOL_BACKING_MALLOC, POOL_NUMA_NONE};
+static atomic_size_t heap_generation = 1;
+static pthread_key_t heap_exit_key;
+static pthread_once_t heap_exit_once = PTHREAD_ONCE_INIT;
+
+static inline size_t small_class(size_t size)
+{
+    return size / ALIGNMENT - 1;
+}
+
+static inline size_t large_bin(size_t size)
+{
+    size_t log2 = (size_t)(63 - __builtin_clzll((unsigned long long)size));
+    return log2 - LARGE_MIN_LOG2;
+}
+
+static inline memory_block_t* block_next_physical(memory_pool_t* pool, memory_block_t* block)
+{
+    uint8_t* next = (uint8_t*)block + BLOCK_TOTAL(block);
+    return (next < pool->pool + pool->top) ? (memory_block_t*)next : NULL;
+}
+
+static inline memory_block_t* block_prev_physical(memory_pool_t* pool, memory_block_t* block)
+{
+    if ((uint8_t*)block == pool->pool)
+    {
+        return NULL;
+    }
+    return (memory_block_t*)((uint8_t*)block - block->prev_size);
+}
+
+static inline void block_set_next_prev_size(memory_pool_t* pool, memory_block_t* block)
+{
+    memory_block_t* next = block_next_physical(pool, block);
+    if (next)
+    {
+        next->prev_size = BLOCK_TOTAL(block);
+    }
+    else
+    {
+        pool->top_prev_size = BLOCK_TOTAL(block);
+    }
+}
+
+static void large_bin_insert(memory_pool_t* pool, memory_block_t* block)
+{
+    size_t bin = large_bin(BLOCK_PAYLOAD(block));
+    free_links_t* links = BLOCK_LINKS(block);
+    links->prev = NULL;
+    links->next = pool->large_bins[bin];
+    if (links->next)
+    {
+        BLOCK_LINKS(links->next)->prev = block;
+    }
+    pool->large_bins[bin] = block;
+    pool->large_map |= (uint64_t)1 << bin;
+    block->size |= BLOCK_FREE;
+}
+
+static void large_bin_remove(memory_pool_t* pool, memory_block_t* block)
+{
+    size_t bin = large_bin(BLOCK_PAYLOAD(block));
+    free_links_t* links = BLOCK_LINKS(block);
+    if (links->prev)
+    {
+        BLOCK_LINKS(links->prev)->next = links->next;
+    }
+    else
+    {
+        pool->large_bins[bin] = links->next;
+    }
+    if (links->next)
+    {
+        BLOCK_LINKS(links->next)->prev = links->prev;
+    }
+    if (pool->large_bins[bin] == NULL)
+    {
+        pool->large_map &= ~((uint64_t)1 << bin);
+    }
+    block->size &= ~BLOCK_FREE;
+}
+
+// Over-maps by one huge page and trims both ends, so transparent huge pages can back the arena from its first byte
+static void* arena_map_aligned(size_t length)
+{
+    uint8_t* region = (uint8_t*)mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+    {
+        return NULL;
+    }
+    uint8_t* aligned = (uint8_t*)(((uintptr_t)region + HUGE_PAGE_SIZE - 1) & ~((uintptr_t)HUGE_PAGE_SIZE - 1));
+    if (aligned > region)
+    {
+        munmap(region, (size_t)(aligned - region));
+    }
+    if (aligned + length < region + length + HUGE_PAGE_SIZE)
+    {
+        munmap(aligned + length, (size_t)(region + length + HUGE_PAGE_SIZE - (aligned + length)));
+    }
+    return aligned;
+}
+
+// Raw mbind keeps libnuma out of the link line; pages are placed on first touch, which has not happened yet
+static bool arena_bind(void* region, size_t length, int node)
+{
+    unsigned long mask[NUMA_MASK_BITS / NUMA_MASK_WORD_BITS] = {0};
+    if (node < 0 || node >= NUMA_MASK_BITS)
+    {
+        return false;
+    }
+    mask[node / NUMA_MASK_WORD_BITS] |= 1ul << (node % NUMA_MASK_WORD_BITS);
+    return syscall(SYS_mbind, region, length, NUMA_MPOL_BIND, mask, (unsigned long)NUMA_MASK_BITS + 1, 0) == 0;
+}
+
+// Plain malloc unless huge pages or a node were asked for; hugetlbfs falls back to transparent huge pages when no pages are reserved
+static uint8_t* arena_map(memory_heap_t* heap, size_t* size, bool* mapped)
+{
+    if (heap->backing == POOL_BACKING_MALLOC && heap->numa_node == POOL_NUMA_NONE)
+    {
+        *mapped = false;
+        return (uint8_t*)malloc(*size);
+    }
+
+    size_t length = (*size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void* region = MAP_FAILED;
+    if (heap->backing == POOL_BACKING_HUGETLB)
+    {
+        region = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    if (region == MAP_FAILED)
+    {
+        region = arena_map_aligned(length);
+        if (region == NULL)
+        {
+            return NULL;
+        }
+        if (heap->backing != POOL_BACKING_MALLOC)
+        {
+            madvise(region, length, MADV_HUGEPAGE);
+        }
+    }
+
+    // A node that was named explicitly must be honoured, the calling thread's own node is only a preference
+    bool bound = heap->numa_node < 0 || arena_bind(region, length, heap->numa_node);
+    if (!bound && heap->numa_required)
+    {
+        munmap(region, length);
+        return NULL;
+    }
+
+    *size = length;
+    *mapped = true;
+    return (uint8_t*)region;
+}
+
+static void arena_unmap(memory_pool_t* pool)
+{
+    if (pool->mapped)
+    {
+        munmap(pool->pool, pool->size);
+    }
+    else
+    {
+        free(pool->pool);
+    }
+}
+
+static memory_pool_t* pool_create(memory_heap_t* heap, size_t size)
 {
     memory_pool_t* pool = (memory_pool_t*)malloc(sizeof(memory_pool_t));
     if (!pool)
@@ -16,8 +247,8 @@ static memory_pool_t* pool_create(size_t size)
         return NULL;
     }
 
-    pool->pool = (uint8_t*)malloc(size);
-    if (!pool->pool) 
+    pool->pool = arena_map(heap, &size, &pool->mapped);
+    if (!pool->pool)
     {
         free(pool);
         return NULL;
@@ -25,197 +256,743 @@ static memory_pool_t* pool_create(size_t size)
 
     pool->size = size;
     pool->used = 0;
-    pool->free_list = NULL;
+    pool->top = 0;
+    pool->top_prev_size = 0;
+    pool->large_map = 0;
+    memset(pool->small_bins, 0, sizeof(pool->small_bins));
+    memset(pool->large_bins, 0, sizeof(pool->large_bins));
+    pool->heap = heap;
     pool->next = NULL;
 
     return pool;
 }
 
-static memory_pool_status_code_t pool_expand(size_t required_size) 
+static memory_pool_status_code_t pool_expand(memory_heap_t* heap, size_t required_size)
 {
-    size_t new_pool_size = (global_memory_pool->size > required_size) ? global_memory_pool->size : required_size;
+    size_t new_pool_size = (heap->head->size > required_size) ? heap->head->size : required_size;
 
-    memory_pool_t* new_pool = pool_create(new_pool_size);
-    if (new_pool == NULL) 
+    memory_pool_t* new_pool = pool_create(heap, new_pool_size);
+    if (new_pool == NULL)
     {
         return POOL_EXPAND_FAILURE;
     }
 
-    memory_pool_t* pool = global_memory_pool;
-    while (pool->next) 
+    heap->tail->next = new_pool;
+    heap->tail = new_pool;
+
+    return POOL_EXPAND_SUCCESS;
+}
+
+static void heap_release_arenas(memory_heap_t* heap)
+{
+    memory_pool_t* pool = heap->head;
+    while (pool)
     {
-        pool = pool->next;
+        memory_pool_t* next_pool = pool->next;
+        arena_unmap(pool);
+        free(pool);
+        pool = next_pool;
     }
-    pool->next = new_pool;
+    free(heap);
+}
 
-    return POOL_EXPAND_SUCCESS;
+// A heap created for the local node stays on the node its thread was running on at creation
+static memory_heap_t* heap_create(size_t size, const pool_options_t* options)
+{
+    memory_heap_t* heap = (memory_heap_t*)malloc(sizeof(memory_heap_t));
+    if (heap == NULL)
+    {
+        return NULL;
+    }
+
+    heap->backing = options->backing;
+    heap->numa_node = options->numa_node;
+    heap->numa_required = options->numa_node >= 0;
+    if (options->numa_node == POOL_NUMA_LOCAL)
+    {
+        unsigned int cpu = 0;
+        unsigned int node = 0;
+        heap->numa_node = (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) ? (int)node : POOL_NUMA_NONE;
+    }
+
+    heap->head = pool_create(heap, size);
+    if (heap->head == NULL)
+    {
+        free(heap);
+        return NULL;
+    }
+    heap->tail = heap->head;
+    heap->recent = heap->head;
+    heap->used = 0;
+    heap->peak = 0;
+    heap->allocations = 0;
+    heap->frees = 0;
+    atomic_init(&heap->remote_free, NULL);
+    atomic_init(&heap->abandoned, false);
+    heap->next = NULL;
+
+    return heap;
+}
+
+static void pool_free_local(memory_block_t* block);
+
+static void heap_drain_remote(memory_heap_t* heap)
+{
+    memory_block_t* block = atomic_exchange(&heap->remote_free, NULL);
+    while (block)
+    {
+        memory_block_t* next = BLOCK_LINKS(block)->next;
+        pool_free_local(block);
+        block = next;
+    }
 }
 
-memory_pool_status_code_t pool_init(size_t initial_size) 
+// Runs at thread exit: the heap stays registered until its blocks are freed or another thread adopts it
+static void heap_abandon(void* ptr)
 {
-    global_memory_pool = pool_create(initial_size);
-    if (global_memory_pool == NULL)
+    memory_heap_t* heap = (memory_heap_t*)ptr;
+    if (heap == NULL || thread_heap != heap || thread_heap_generation != atomic_load(&heap_generation))
+    {
+        return;
+    }
+
+    // Publishing the flag only after the drain, under the lock, keeps an adopting thread from using the heap while it is still being drained
+    pthread_mutex_lock(&heap_registry_lock);
+    heap_drain_remote(heap);
+    atomic_store(&heap->abandoned, true);
+    pthread_mutex_unlock(&heap_registry_lock);
+
+    thread_heap = NULL;
+    global_memory_pool = NULL;
+}
+
+static void heap_exit_key_create(void)
+{
+    pthread_key_create(&heap_exit_key, heap_abandon);
+}
+
+static void heap_attach(memory_heap_t* heap)
+{
+    pthread_once(&heap_exit_once, heap_exit_key_create);
+    pthread_setspecific(heap_exit_key, heap);
+
+    thread_heap = heap;
+    thread_heap_generation = atomic_load(&heap_generation);
+    global_memory_pool = heap->head;
+}
+
+static memory_heap_t* heap_current(void)
+{
+    if (thread_heap && thread_heap_generation == atomic_load(&heap_generation))
+    {
+        return thread_heap;
+    }
+    thread_heap = NULL;
+    global_memory_pool = NULL;
+    return NULL;
+}
+
+// Threads other than the one that called pool_init get a heap on their first allocation
+static memory_heap_t* heap_acquire(void)
+{
+    memory_heap_t* heap = heap_current();
+    if (heap)
+    {
+        return heap;
+    }
+
+    pthread_mutex_lock(&heap_registry_lock);
+    if (heap_default_size == 0)
+    {
+        pthread_mutex_unlock(&heap_registry_lock);
+        return NULL;
+    }
+
+    for (heap = heap_registry; heap; heap = heap->next)
+    {
+        if (atomic_load(&heap->abandoned))
+        {
+            heap_drain_remote(heap);
+            atomic_store(&heap->abandoned, false);
+            break;
+        }
+    }
+    if (heap == NULL)
+    {
+        heap = heap_create(heap_default_size, &heap_default_options);
+        if (heap)
+        {
+            heap->next = heap_registry;
+            heap_registry = heap;
+        }
+    }
+    pthread_mutex_unlock(&heap_registry_lock);
+
+    if (heap)
+    {
+        heap_attach(heap);
+    }
+    return heap;
+}
+
+memory_pool_status_code_t pool_init(size_t initial_size)
+{
+    return pool_init_with_options(initial_size, NULL);
+}
+
+// The first initialization also sets the options for heaps that other threads create on their first allocation
+memory_pool_status_code_t pool_init_with_options(size_t initial_size, const pool_options_t* options)
+{
+    pool_options_t defaults = {POOL_BACKING_MALLOC, POOL_NUMA_NONE};
+    options = options ? options : &defaults;
+    if (heap_current() || options->backing > POOL_BACKING_HUGETLB || options->numa_node < POOL_NUMA_LOCAL)
+    {
+        return POOL_CREATION_FAILURE;
+    }
+
+    memory_heap_t* heap = heap_create(initial_size, options);
+    if (heap == NULL)
     {
         return POOL_CREATION_FAILURE;
     }
+
+    pthread_mutex_lock(&heap_registry_lock);
+    if (heap_default_size == 0)
+    {
+        heap_default_size = initial_size;
+        heap_default_options = *options;
+    }
+    heap->next = heap_registry;
+    heap_registry = heap;
+    pthread_mutex_unlock(&heap_registry_lock);
+
+    heap_attach(heap);
     return POOL_CREATION_SUCCESS;
 }
 
 memory_pool_status_code_t pool_destroy()
 {
-    memory_pool_t* pool = global_memory_pool;
-    if (pool == NULL)
+    if (heap_current() == NULL)
     {
         return POOL_DESTROY_FAILURE;
     }
 
-    while (pool) 
+    // Tears down every thread's heap; the generation bump invalidates their cached pointers
+    pthread_mutex_lock(&heap_registry_lock);
+    memory_heap_t* heap = heap_registry;
+    while (heap)
     {
-        memory_pool_t* next_pool = pool->next;
-        free(pool->pool);
-        free(pool);
-        pool = next_pool;
+        memory_heap_t* next_heap = heap->next;
+        heap_release_arenas(heap);
+        heap = next_heap;
     }
+    heap_registry = NULL;
+    heap_default_size = 0;
+    heap_default_options.backing = POOL_BACKING_MALLOC;
+    heap_default_options.numa_node = POOL_NUMA_NONE;
+    atomic_fetch_add(&heap_generation, 1);
+    pthread_mutex_unlock(&heap_registry_lock);
+
+    thread_heap = NULL;
     global_memory_pool = NULL;
 
     return POOL_DESTROY_SUCCESS;
 }
 
-void* pool_alloc(size_t size) 
+static void* pool_alloc_small(memory_pool_t* pool, size_t size)
 {
-    if (size == 0)
+    size_t cls = small_class(size);
+    memory_block_t* block = pool->small_bins[cls];
+    if (block == NULL)
     {
-        size = ALIGNMENT;
+        return NULL;
     }
 
-    size = ALIGN_UP(size);
-    size_t total_size = ALIGN_UP(size + sizeof(memory_block_t));
+    pool->small_bins[cls] = BLOCK_LINKS(block)->next;
+    block->size &= ~BLOCK_FREE;
+    pool->used += BLOCK_TOTAL(block);
+    return BLOCK_DATA(block);
+}
 
-    // Check the free list across all pools for a suitable block
-    memory_pool_t* pool = global_memory_pool;
-    while (pool) 
+static void* pool_alloc_large(memory_pool_t* pool, size_t size)
+{
+    size_t bin = large_bin(size);
+    memory_block_t* block = NULL;
+
+    // Blocks in the request's own bin may still be too small, every higher bin is guaranteed to fit
+    for (memory_block_t* current = pool->large_bins[bin]; current; current = BLOCK_LINKS(current)->next)
+    {
+        if (BLOCK_PAYLOAD(current) >= size)
+        {
+            block = current;
+            break;
+        }
+    }
+    if (block == NULL)
     {
-        memory_block_t** prev = &pool->free_list;
-        memory_block_t* current = pool->free_list;
-        while (current) 
+        uint64_t higher = pool->large_map & ~(((uint64_t)2 << bin) - 1);
+        if (higher == 0)
         {
-            if (current->size >= size) 
+            return NULL;
+        }
+        block = pool->large_bins[__builtin_ctzll(higher)];
+    }
+
+    large_bin_remove(pool, block);
+
+    size_t total = BLOCK_TOTAL(block);
+    if (total - (HEADER_SIZE + size) >= MIN_SPLIT_SIZE)
+    {
+        memory_block_t* remainder = (memory_block_t*)((uint8_t*)block + HEADER_SIZE + size);
+        remainder->size = total - (HEADER_SIZE + size) - HEADER_SIZE;
+        remainder->prev_size = HEADER_SIZE + size;
+        remainder->pool = pool;
+        block->size = size;
+        block_set_next_prev_size(pool, remainder);
+        large_bin_insert(pool, remainder);
+    }
+
+    pool->used += BLOCK_TOTAL(block);
+    return BLOCK_DATA(block);
+}
+
+static void* pool_alloc_top(memory_pool_t* pool, size_t size, size_t flags)
+{
+    if (pool->top + HEADER_SIZE + size > pool->size)
+    {
+        return NULL;
+    }
+
+    memory_block_t* block = (memory_block_t*)(pool->pool + pool->top);
+    block->size = size | flags;
+    block->prev_size = pool->top_prev_size;
+    block->pool = pool;
+    pool->top += HEADER_SIZE + size;
+    pool->top_prev_size = HEADER_SIZE + size;
+    pool->used += HEADER_SIZE + size;
+    return BLOCK_DATA(block);
+}
+
+static void* heap_alloc(memory_heap_t* heap, size_t size)
+{
+    bool is_small = (size <= SMALL_MAX);
+
+    // The arena that last received a free is the most likely to hold a matching block
+    memory_pool_t* recent = heap->recent;
+    void* ptr = is_small ? pool_alloc_small(recent, size) : pool_alloc_large(recent, size);
+    if (ptr == NULL)
+    {
+        ptr = pool_alloc_top(recent, size, is_small ? BLOCK_SMALL : 0);
+    }
+    if (ptr)
+    {
+        return ptr;
+    }
+
+    // Reuse a binned block of the right class from any other arena
+    memory_pool_t* pool = heap->head;
+    while (pool)
+    {
+        if (pool != recent)
+        {
+            ptr = is_small ? pool_alloc_small(pool, size) : pool_alloc_large(pool, size);
+            if (ptr)
             {
-                *prev = current->next;
-                pool->used += total_size;
-                current->size = size; 
-                current->next = NULL;
-                return (void*)(current + 1);
+                heap->recent = pool;
+                return ptr;
             }
-            prev = &current->next;
-            current = current->next;
         }
         pool = pool->next;
     }
 
-    // Allocate memory from the current pool
-    pool = global_memory_pool;
-    while (pool) 
+    // Carve a new block from the untouched end of an arena
+    pool = heap->head;
+    while (pool)
     {
-        if (pool->used + total_size <= pool->size) 
+        ptr = (pool == recent) ? NULL : pool_alloc_top(pool, size, is_small ? BLOCK_SMALL : 0);
+        if (ptr)
         {
-            memory_block_t* block = (memory_block_t*)(pool->pool + pool->used);
-            block->size = size;
-            block->next = NULL;
-            pool->used += total_size;
-            return (void*)(block + 1);
+            heap->recent = pool;
+            return ptr;
         }
         pool = pool->next;
     }
 
     // Expand the pool if no suitable space is found
-    if (pool_expand(total_size) == POOL_EXPAND_FAILURE) 
+    if (pool_expand(heap, HEADER_SIZE + size) == POOL_EXPAND_FAILURE)
     {
         return NULL;
     }
 
-    // Allocate from the new pool
-    pool = global_memory_pool;
-    while (pool->next) 
+    heap->recent = heap->tail;
+    return pool_alloc_top(heap->tail, size, is_small ? BLOCK_SMALL : 0);
+}
+
+void* pool_alloc(size_t size)
+{
+    memory_heap_t* heap = heap_acquire();
+    if (heap == NULL)
     {
-        pool = pool->next;
+        return NULL;
     }
-    if (pool->used + total_size <= pool->size) 
+    if (atomic_load_explicit(&heap->remote_free, memory_order_relaxed))
     {
-        memory_block_t* block = (memory_block_t*)(pool->pool + pool->used);
-        block->size = size; 
-        block->next = NULL;
-        pool->used += total_size;
-        return (void*)(block + 1);
+        heap_drain_remote(heap);
     }
-    else
+
+    if (size < sizeof(free_links_t))
+    {
+        size = sizeof(free_links_t);
+    }
+    size = ALIGN_UP(size);
+    profiler_count_allocation(size);
+
+    void* ptr = heap_alloc(heap, size);
+    if (ptr == NULL)
     {
         return NULL;
     }
+
+    // The heap keeps its own running total so the high-water mark costs one compare per allocation
+    memory_block_t* block = BLOCK_FROM_DATA(ptr);
+    block->tag = thread_tag;
+    block->magic = BLOCK_CHECK(block);
+    heap->allocations++;
+    heap->used += BLOCK_TOTAL(block);
+    if (heap->used > heap->peak)
+    {
+        heap->peak = heap->used;
+    }
+    return ptr;
+}
+
+static void pool_release_large(memory_pool_t* pool, memory_block_t* block)
+{
+    memory_block_t* next = block_next_physical(pool, block);
+    if (next && (next->size & BLOCK_FLAGS) == BLOCK_FREE)
+    {
+        large_bin_remove(pool, next);
+        block->size = BLOCK_PAYLOAD(block) + BLOCK_TOTAL(next);
+    }
+
+    memory_block_t* prev = block_prev_physical(pool, block);
+    if (prev && (prev->size & BLOCK_FLAGS) == BLOCK_FREE)
+    {
+        large_bin_remove(pool, prev);
+        prev->size = BLOCK_PAYLOAD(prev) + BLOCK_TOTAL(block);
+        block = prev;
+    }
+
+    // A free block that reaches the end of the arena is handed back to the untouched region
+    if ((uint8_t*)block + BLOCK_TOTAL(block) == pool->pool + pool->top)
+    {
+        pool->top = (size_t)((uint8_t*)block - pool->pool);
+        pool->top_prev_size = block->prev_size;
+        return;
+    }
+
+    block_set_next_prev_size(pool, block);
+    large_bin_insert(pool, block);
+}
+
+static void pool_free_local(memory_block_t* block)
+{
+    memory_pool_t* pool = block->pool;
+
+    // Blocks are released with the exact size they were charged, so the counters cannot underflow
+    size_t total_size = BLOCK_TOTAL(block);
+    pool->used -= total_size;
+    pool->heap->used -= total_size;
+    pool->heap->frees++;
+
+    if (block->size & BLOCK_SMALL)
+    {
+        size_t cls = small_class(BLOCK_PAYLOAD(block));
+        BLOCK_LINKS(block)->next = pool->small_bins[cls];
+        pool->small_bins[cls] = block;
+        block->size |= BLOCK_FREE;
+    }
+    else
+    {
+        pool_release_large(pool, block);
+    }
+    pool->heap->recent = pool;
 }
 
-memory_pool_status_code_t pool_free(void* ptr) 
+memory_pool_status_code_t pool_free(void* ptr)
 {
     if (ptr == NULL)
     {
         return POOL_FREE_FAILURE;
     }
 
-    memory_block_t* block = ((memory_block_t*)ptr) - 1;
+    // Foreign pointers and double frees fail the check word before the arena named in the header is dereferenced,
+    // pointers into the middle of a live block are not supported, the check word is then read from payload and only rejects them by chance
+    memory_block_t* block = BLOCK_FROM_DATA(ptr);
     uintptr_t block_addr = (uintptr_t)block;
-    memory_pool_t* pool = global_memory_pool;
+    memory_pool_t* pool = block->pool;
+    if (pool == NULL || block->magic != BLOCK_CHECK(block))
+    {
+        return POOL_FREE_FAILURE;
+    }
+    if (block_addr < (uintptr_t)pool->pool || block_addr >= (uintptr_t)pool->pool + pool->size || (block->size & BLOCK_FREE))
+    {
+        return POOL_FREE_FAILURE;
+    }
+    block->magic = 0;
+
+    memory_heap_t* heap = pool->heap;
+    if (heap == heap_current())
+    {
+        pool_free_local(block);
+        return POOL_FREE_SUCCESS;
+    }
 
-    // Find the pool containing the block
-    while (pool) 
+    // Blocks owned by another thread are pushed onto its lock-free queue and released on its next allocation
+    memory_block_t* head = atomic_load(&heap->remote_free);
+    do
     {
-        uintptr_t pool_start = (uintptr_t)pool->pool;
-        uintptr_t pool_end = pool_start + pool->size;
+        BLOCK_LINKS(block)->next = head;
+    } while (!atomic_compare_exchange_weak(&heap->remote_free, &head, block));
 
-        if (block_addr >= pool_start && block_addr < pool_end) 
+    // Nobody will drain the queue of a heap whose thread has exited, so do it here
+    if (atomic_load(&heap->abandoned))
+    {
+        pthread_mutex_lock(&heap_registry_lock);
+        if (atomic_load(&heap->abandoned))
         {
-            block->next = pool->free_list;
-            pool->free_list = block;
-            size_t total_size = block->size + sizeof(memory_block_t);
-            total_size = ALIGN_UP(total_size);
+            heap_drain_remote(heap);
+        }
+        pthread_mutex_unlock(&heap_registry_lock);
+    }
+
+    return POOL_FREE_SUCCESS;
+}
 
-            if (pool->used >= total_size)
+size_t pool_get_used_memory(void)
+{
+    memory_heap_t* heap = heap_current();
+    if (heap == NULL)
+    {
+        return 0;
+    }
+    heap_drain_remote(heap);
+
+    return heap->used;
+}
+
+size_t pool_get_free_memory(void)
+{
+    memory_heap_t* heap = heap_current();
+    if (heap == NULL)
+    {
+        return 0;
+    }
+    heap_drain_remote(heap);
+
+    size_t total_free = 0;
+    memory_pool_t* pool = heap->head;
+    while (pool)
+    {
+        total_free += pool->size - pool->used;
+        pool = pool->next;
+    }
+    return total_free;
+}
+
+size_t pool_get_largest_free_block(void)
+{
+    memory_heap_t* heap = heap_current();
+    if (heap == NULL)
+    {
+        return 0;
+    }
+    heap_drain_remote(heap);
+
+    size_t largest = 0;
+    memory_pool_t* pool = heap->head;
+    while (pool)
+    {
+        size_t tail = pool->size - pool->top;
+        if (tail > HEADER_SIZE && tail - HEADER_SIZE > largest)
+        {
+            largest = tail - HEADER_SIZE;
+        }
+        if (pool->large_map)
+        {
+            size_t bin = (size_t)(63 - __builtin_clzll(pool->large_map));
+            for (memory_block_t* block = pool->large_bins[bin]; block; block = BLOCK_LINKS(block)->next)
             {
-                pool->used -= total_size;
+                if (BLOCK_PAYLOAD(block) > largest)
+                {
+                    largest = BLOCK_PAYLOAD(block);
+                }
             }
-            else
+        }
+        for (size_t cls = POOL_NUM_SMALL_CLASSES; cls > 0; --cls)
+        {
+            if (pool->small_bins[cls - 1])
             {
-                pool->used = 0;
+                if ((cls * ALIGNMENT) > largest)
+                {
+                    largest = cls * ALIGNMENT;
+                }
+                break;
             }
+        }
+        pool = pool->next;
+    }
+    return largest;
+}
+
+float pool_get_fragmentation(void)
+{
+    size_t total_free = pool_get_free_memory();
+    if (total_free == 0)
+    {
+        return 0.0f;
+    }
+    return 1.0f - (float)pool_get_largest_free_block() / (float)total_free;
+}
+
+static size_t histogram_bin(size_t payload)
+{
+    size_t log2 = (size_t)(63 - __builtin_clzll((unsigned long long)payload));
+    size_t bin = (log2 > HISTOGRAM_MIN_LOG2) ? log2 - HISTOGRAM_MIN_LOG2 : 0;
+    return (bin < POOL_HISTOGRAM_BINS) ? bin : POOL_HISTOGRAM_BINS - 1;
+}
+
+// Covers the calling thread's heap, like the other getters; live blocks are found by walking each arena up to its top
+memory_pool_status_code_t pool_get_stats(pool_stats_t* stats)
+{
+    memory_heap_t* heap = heap_current();
+    if (heap == NULL || stats == NULL)
+    {
+        return POOL_STATS_FAILURE;
+    }
+
+    memset(stats, 0, sizeof(pool_stats_t));
+    stats->largest_free_block = pool_get_largest_free_block();
+    stats->fragmentation = pool_get_fragmentation();
+    stats->used = heap->used;
+    stats->peak = heap->peak;
+    stats->allocations = heap->allocations;
+    stats->frees = heap->frees;
 
-            return POOL_FREE_SUCCESS;
+    for (memory_pool_t* pool = heap->head; pool; pool = pool->next)
+    {
+        stats->num_arenas++;
+        stats->capacity += pool->size;
+        for (size_t cls = 0; cls < POOL_NUM_SMALL_CLASSES; ++cls)
+        {
+            for (memory_block_t* block = pool->small_bins[cls]; block; block = BLOCK_LINKS(block)->next)
+            {
+                stats->free_blocks++;
+            }
+        }
+        for (size_t bin = 0; bin < POOL_NUM_LARGE_BINS; ++bin)
+        {
+            for (memory_block_t* block = pool->large_bins[bin]; block; block = BLOCK_LINKS(block)->next)
+            {
+                stats->free_blocks++;
+            }
+        }
+        for (size_t offset = 0; offset < pool->top;)
+        {
+            memory_block_t* block = (memory_block_t*)(pool->pool + offset);
+            if (!(block->size & BLOCK_FREE))
+            {
+                stats->live_allocations++;
+                stats->histogram[histogram_bin(BLOCK_PAYLOAD(block))]++;
+            }
+            offset += BLOCK_TOTAL(block);
         }
+    }
+    return POOL_STATS_SUCCESS;
+}
 
-        pool = pool->next;
+void pool_reset_peak(void)
+{
+    memory_heap_t* heap = heap_current();
+    if (heap)
+    {
+        heap_drain_remote(heap);
+        heap->peak = heap->used;
     }
+}
 
-    return POOL_FREE_FAILURE;
+// Tags are stored by pointer, so they should be string literals or otherwise outlive the blocks they label
+const char* pool_set_tag(const char* tag)
+{
+    const char* previous = thread_tag;
+    thread_tag = tag;
+    return previous;
 }
 
-size_t pool_get_used_memory(void) 
+// Fills at most capacity entries and returns how many it filled; untagged blocks and tags past capacity are left out
+size_t pool_get_tag_stats(pool_tag_stats_t* stats, size_t capacity)
 {
-    size_t total_used = 0;
-    memory_pool_t* pool = global_memory_pool;
-    while (pool) 
+    memory_heap_t* heap = heap_current();
+    if (heap == NULL)
     {
-        total_used += pool->used;
-        pool = pool->next;
+        return 0;
+    }
+    heap_drain_remote(heap);
+
+    size_t count = 0;
+    for (memory_pool_t* pool = heap->head; pool; pool = pool->next)
+    {
+        for (size_t offset = 0; offset < pool->top; offset += BLOCK_TOTAL((memory_block_t*)(pool->pool + offset)))
+        {
+            memory_block_t* block = (memory_block_t*)(pool->pool + offset);
+            if ((block->size & BLOCK_FREE) || block->tag == NULL)
+            {
+                continue;
+            }
+            size_t index = 0;
+            while (index < count && stats[index].tag != block->tag && strcmp(stats[index].tag, block->tag) != 0)
+            {
+                index++;
+            }
+            if (index == count)
+            {
+                if (count == capacity)
+                {
+                    continue;
+                }
+                stats[count++] = (pool_tag_stats_t){block->tag, 0, 0};
+            }
+            stats[index].live_allocations++;
+            stats[index].live_bytes += BLOCK_PAYLOAD(block);
+        }
     }
-    return total_used;
+    return count;
 }
 
-size_t pool_get_free_memory(void) 
+void pool_print_stats(void)
 {
-    size_t total_free = 0;
-    memory_pool_t* pool = global_memory_pool;
-    while (pool) 
+    pool_stats_t stats;
+    if (pool_get_stats(&stats) == POOL_STATS_FAILURE)
     {
-        total_free += pool->size - pool->used;
-        pool = pool->next;
+        printf("Pool not initialized\n");
+        return;
     }
-    return total_free;
-}
\ No newline at end of file
+
+    printf("Used %zu of %zu bytes in %zu arenas, peak %zu\n", stats.used, stats.capacity, stats.num_arenas, stats.peak);
+    printf("Allocations %zu, frees %zu, live %zu\n", stats.allocations, stats.frees, stats.live_allocations);
+    printf("Free blocks %zu, largest %zu bytes, fragmentation %.3f\n", stats.free_blocks, stats.largest_free_block, stats.fragmentation);
+    for (size_t bin = 0; bin < POOL_HISTOGRAM_BINS; ++bin)
+    {
+        if (stats.histogram[bin])
+        {
+            printf("  >= %10zu bytes: %zu\n", (size_t)1 << (bin + HISTOGRAM_MIN_LOG2), stats.histogram[bin]);
+        }
+    }
+
+    pool_tag_stats_t tags[PRINT_MAX_TAGS];
+    size_t num_tags = pool_get_tag_stats(tags, PRINT_MAX_TAGS);
+    for (size_t i = 0; i < num_tags && i < PRINT_MAX_TAGS; ++i)
+    {
+        printf("  tag %-24s %zu live, %zu bytes\n", tags[i].tag, tags[i].live_allocations, tags[i].live_bytes);
+    }
+}
@@ -0,0 +1,301 @@
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "utils/profiler/profiler.h"
+
+#define PROFILER_INITIAL_CAPACITY 64
+
+typedef struct profiler_event
+{
+    uint32_t entry;
+    uint32_t thread;
+    uint64_t start;
+    uint64_t duration;
+    uint64_t flops;
+    uint64_t bytes;
+} profiler_event_t;
+
+// Records are kept outside the pool, so profiling never shows up in the memory it is measuring
+typedef struct profiler_state
+{
+    pthread_mutex_t mutex;
+    profiler_entry_t* entries;
+    size_t num_entries;
+    size_t entries_capacity;
+    profiler_event_t* events;
+    size_t num_events;
+    size_t events_capacity;
+    size_t dropped_events;
+    uint64_t origin;
+    uint64_t profiled_ns;
+} profiler_state_t;
+
+atomic_bool profiler_active = false;
+_Thread_local profiler_counters_t profiler_counters = {0, 0, 0};
+
+static profiler_state_t state = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+static atomic_uint next_thread = 0;
+static _Thread_local uint32_t thread_id = 0;
+
+static uint64_t profiler_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void profiler_enable(void)
+{
+    pthread_mutex_lock(&state.mutex);
+    if (state.origin == 0)
+    {
+        state.origin = profiler_now();
+    }
+    pthread_mutex_unlock(&state.mutex);
+    atomic_store(&profiler_active, true);
+}
+
+void profiler_disable(void)
+{
+    atomic_store(&profiler_active, false);
+}
+
+void profiler_reset(void)
+{
+    pthread_mutex_lock(&state.mutex);
+    for (size_t i = 0; i < state.num_entries; ++i)
+    {
+        free(state.entries[i].name);
+    }
+    free(state.entries);
+    free(state.events);
+    state.entries = NULL;
+    state.num_entries = 0;
+    state.entries_capacity = 0;
+    state.events = NULL;
+    state.num_events = 0;
+    state.events_capacity = 0;
+    state.dropped_events = 0;
+    state.profiled_ns = 0;
+    state.origin = atomic_load(&profiler_active) ? profiler_now() : 0;
+    pthread_mutex_unlock(&state.mutex);
+}
+
+void profiler_scope_open(profiler_scope_t *scope)
+{
+    scope->start = profiler_now();
+    scope->allocations = profiler_counters.allocations;
+    scope->allocated_bytes = profiler_counters.allocated_bytes;
+    profiler_counters.depth++;
+}
+
+static bool profiler_reserve(void **items, size_t *capacity, size_t count, size_t item_size, size_t limit)
+{
+    if (count < *capacity)
+    {
+        return true;
+    }
+    size_t grown = *capacity ? *capacity * 2 : PROFILER_INITIAL_CAPACITY;
+    grown = (grown > limit) ? limit : grown;
+    if (grown <= count)
+    {
+        return false;
+    }
+    void *resized = realloc(*items, grown * item_size);
+    if (resized == NULL)
+    {
+        return false;
+    }
+    *items = resized;
+    *capacity = grown;
+    return true;
+}
+
+// Call sites are keyed by operation and layer name; the handful of distinct sites makes a linear scan cheap enough
+static profiler_entry_t* profiler_find_entry(const char *op, const char *name)
+{
+    for (size_t i = 0; i < state.num_entries; ++i)
+    {
+        profiler_entry_t *entry = &state.entries[i];
+        bool same_op = entry->op == op || strcmp(entry->op, op) == 0;
+        bool same_name = (entry->name == NULL || name == NULL) ? entry->name == name : strcmp(entry->name, name) == 0;
+        if (same_op && same_name)
+        {
+            return entry;
+        }
+    }
+
+    if (!profiler_reserve((void **)&state.entries, &state.entries_capacity, state.num_entries, sizeof(profiler_entry_t), SIZE_MAX / sizeof(profiler_entry_t)))
+    {
+        return NULL;
+    }
+    char *copy = NULL;
+    if (name)
+    {
+        // Layers may be destroyed before the report is written, so their names are copied
+        copy = strdup(name);
+        if (copy == NULL)
+        {
+            return NULL;
+        }
+    }
+    profiler_entry_t *entry = &state.entries[state.num_entries++];
+    memset(entry, 0, sizeof(profiler_entry_t));
+    entry->op = op;
+    entry->name = copy;
+    entry->min_ns = UINT64_MAX;
+    return entry;
+}
+
+void profiler_scope_close(const profiler_scope_t *scope, const char *op, const char *name, uint64_t flops, uint64_t bytes)
+{
+    uint64_t end = profiler_now();
+    uint64_t duration = end - scope->start;
+    size_t depth = --profiler_counters.depth;
+    uint64_t allocations = profiler_counters.allocations - scope->allocations;
+    uint64_t allocated_bytes = profiler_counters.allocated_bytes - scope->allocated_bytes;
+    if (thread_id == 0)
+    {
+        thread_id = atomic_fetch_add(&next_thread, 1) + 1;
+    }
+
+    pthread_mutex_lock(&state.mutex);
+    profiler_entry_t *entry = profiler_find_entry(op, name);
+    if (entry)
+    {
+        entry->calls++;
+        entry->total_ns += duration;
+        entry->min_ns = (duration < entry->min_ns) ? duration : entry->min_ns;
+        entry->max_ns = (duration > entry->max_ns) ? duration : entry->max_ns;
+        entry->flops += flops;
+        entry->bytes += bytes;
+        entry->allocations += allocations;
+        entry->allocated_bytes += allocated_bytes;
+        state.profiled_ns += (depth == 0) ? duration : 0;
+
+        // Scopes opened before a reset start before the origin and are kept out of the timeline
+        bool logged = scope->start >= state.origin && profiler_reserve((void **)&state.events, &state.events_capacity, state.num_events, sizeof(profiler_event_t), PROFILER_MAX_EVENTS);
+        if (logged)
+        {
+            state.events[state.num_events++] = (profiler_event_t){(uint32_t)(entry - state.entries), thread_id, scope->start - state.origin, duration, flops, bytes};
+        }
+        else
+        {
+            state.dropped_events++;
+        }
+    }
+    pthread_mutex_unlock(&state.mutex);
+}
+
+// The pointer is only valid until the next scope closes or the profiler is reset
+const profiler_entry_t* profiler_get_entries(size_t *count)
+{
+    if (count)
+    {
+        *count = state.num_entries;
+    }
+    return state.entries;
+}
+
+static int profiler_compare_total(const void *a, const void *b)
+{
+    const profiler_entry_t *x = *(const profiler_entry_t *const *)a;
+    const profiler_entry_t *y = *(const profiler_entry_t *const *)b;
+    return (x->total_ns < y->total_ns) - (x->total_ns > y->total_ns);
+}
+
+// Times are inclusive, so nested scopes also count towards the scope around them; the share is of top-level time
+void profiler_print(void)
+{
+    pthread_mutex_lock(&state.mutex);
+    const profiler_entry_t **sorted = (const profiler_entry_t **)malloc((state.num_entries ? state.num_entries : 1) * sizeof(profiler_entry_t *));
+    if (sorted == NULL)
+    {
+        pthread_mutex_unlock(&state.mutex);
+        return;
+    }
+    for (size_t i = 0; i < state.num_entries; ++i)
+    {
+        sorted[i] = &state.entries[i];
+    }
+    qsort(sorted, state.num_entries, sizeof(profiler_entry_t *), profiler_compare_total);
+
+    printf("%-18s %-16s %8s %11s %10s %10s %10s %6s %9s %9s %8s %11s\n", "op", "layer", "calls", "total ms", "avg us", "min us", "max us", "%", "GFLOP/s", "GB/s", "allocs", "alloc KB");
+    for (size_t i = 0; i < state.num_entries; ++i)
+    {
+        const profiler_entry_t *entry = sorted[i];
+        double seconds = (double)entry->total_ns * 1e-9;
+        double share = state.profiled_ns ? 100.0 * (double)entry->total_ns / (double)state.profiled_ns : 0.0;
+        double gflops = seconds > 0.0 ? (double)entry->flops / seconds * 1e-9 : 0.0;
+        double gbytes = seconds > 0.0 ? (double)entry->bytes / seconds * 1e-9 : 0.0;
+        printf("%-18s %-16s %8zu %11.3f %10.2f %10.2f %10.2f %6.1f %9.2f %9.2f %8llu %11.1f\n",
+            entry->op, entry->name ? entry->name : "-", entry->calls, seconds * 1e3,
+            (double)entry->total_ns * 1e-3 / (double)entry->calls, (double)entry->min_ns * 1e-3, (double)entry->max_ns * 1e-3,
+            share, gflops, gbytes, (unsigned long long)entry->allocations, (double)entry->allocated_bytes / 1024.0);
+    }
+    printf("Profiled %.3f ms at top level", (double)state.profiled_ns * 1e-6);
+    if (state.dropped_events > 0)
+    {
+        printf(", %zu events left out of the trace", state.dropped_events);
+    }
+    printf("\n");
+
+    free(sorted);
+    pthread_mutex_unlock(&state.mutex);
+}
+
+static void profiler_write_string(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (const unsigned char *c = (const unsigned char *)text; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            fprintf(file, "\\%c", *c);
+        }
+        else if (*c < 0x20)
+        {
+            fprintf(file, "\\u%04x", *c);
+        }
+        else
+        {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+// Chrome trace-event format: complete events in microseconds, loadable in chrome://tracing and Perfetto
+profiler_status_code_t profiler_export_trace(const char *path)
+{
+    if (path == NULL)
+    {
+        return PROFILER_EXPORT_FAILURE;
+    }
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+    {
+        return PROFILER_EXPORT_FAILURE;
+    }
+
+    pthread_mutex_lock(&state.mutex);
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (size_t i = 0; i < state.num_events; ++i)
+    {
+        const profiler_event_t *event = &state.events[i];
+        const profiler_entry_t *entry = &state.entries[event->entry];
+        fprintf(file, "%s\n{\"name\":", i ? "," : "");
+        profiler_write_string(file, entry->name ? entry->name : entry->op);
+        fprintf(file, ",\"cat\":");
+        profiler_write_string(file, entry->op);
+        fprintf(file, ",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"op\":", event->thread, (double)event->start * 1e-3, (double)event->duration * 1e-3);
+        profiler_write_string(file, entry->op);
+        fprintf(file, ",\"flops\":%llu,\"bytes\":%llu}}", (unsigned long long)event->flops, (unsigned long long)event->bytes);
+    }
+    fprintf(file, "\n]}\n");
+    pthread_mutex_unlock(&state.mutex);
+
+    return (fclose(file) == 0) ? PROFILER_EXPORT_SUCCESS : PROFILER_EXPORT_FAILURE;
+}
@@ -69,7 +69,11 @@ void print_tensor(const tensor_t *tensor, const char *name)
     size_t indices[MAX_DIMS];
     
     printf("data:\n");
-    if (tensor->data != NULL)
+    if (tensor->data != NULL && tensor->dtype != TENSOR_FLOAT32)
+    {
+        printf("Reduced precision");
+    }
+    else if (tensor->data != NULL)
     {
         memset(indices, 0, sizeof(indices));
         print_array_recursive(tensor->data, tensor->ndim, tensor->shape, tensor->stride, 0, indices);
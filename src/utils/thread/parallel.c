@@ -0,0 +1,420 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "utils/thread/parallel.h"
+
+#define PARALLEL_MAX_THREADS 256
+#define PARALLEL_TASKS_PER_THREAD 4
+#define PARALLEL_DEQUE_CAPACITY 256
+
+typedef struct parallel_job
+{
+    parallel_fn_t fn;
+    void* ctx;
+    size_t remaining;
+    pthread_mutex_t mutex;
+    pthread_cond_t done;
+} parallel_job_t;
+
+typedef struct parallel_task
+{
+    parallel_job_t* job;
+    size_t begin;
+    size_t end;
+} parallel_task_t;
+
+typedef struct parallel_deque
+{
+    pthread_mutex_t mutex;
+    size_t top;
+    size_t bottom;
+    parallel_task_t tasks[PARALLEL_DEQUE_CAPACITY];
+} parallel_deque_t;
+
+typedef struct parallel_runtime
+{
+    size_t num_threads;
+    size_t num_workers;
+    size_t num_spawned;
+    pthread_t* workers;
+    parallel_deque_t* deques;
+    atomic_size_t queued;
+    atomic_size_t next_deque;
+    atomic_bool started;
+    bool shutdown;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+} parallel_runtime_t;
+
+static parallel_runtime_t runtime = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER
+};
+static pthread_mutex_t runtime_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t runtime_idle = PTHREAD_COND_INITIALIZER;
+static size_t requested_threads = 0;
+static size_t active_jobs = 0;
+static size_t pending_resizes = 0;
+
+static _Thread_local bool in_parallel_region = false;
+static _Thread_local size_t worker_index = (size_t)-1;
+
+static bool deque_push(parallel_deque_t* deque, parallel_task_t task)
+{
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->bottom - deque->top == PARALLEL_DEQUE_CAPACITY)
+    {
+        pthread_mutex_unlock(&deque->mutex);
+        return false;
+    }
+    deque->tasks[deque->bottom % PARALLEL_DEQUE_CAPACITY] = task;
+    deque->bottom++;
+    pthread_mutex_unlock(&deque->mutex);
+    return true;
+}
+
+static bool deque_pop(parallel_deque_t* deque, parallel_task_t* task)
+{
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->bottom == deque->top)
+    {
+        pthread_mutex_unlock(&deque->mutex);
+        return false;
+    }
+    deque->bottom--;
+    *task = deque->tasks[deque->bottom % PARALLEL_DEQUE_CAPACITY];
+    pthread_mutex_unlock(&deque->mutex);
+    return true;
+}
+
+static bool deque_steal(parallel_deque_t* deque, parallel_task_t* task)
+{
+    pthread_mutex_lock(&deque->mutex);
+    if (deque->bottom == deque->top)
+    {
+        pthread_mutex_unlock(&deque->mutex);
+        return false;
+    }
+    *task = deque->tasks[deque->top % PARALLEL_DEQUE_CAPACITY];
+    deque->top++;
+    pthread_mutex_unlock(&deque->mutex);
+    return true;
+}
+
+// Owners take the newest task from their own deque, thieves take the oldest one from everybody else
+static bool runtime_find_task(size_t self, size_t hint, parallel_task_t* task)
+{
+    if (self < runtime.num_workers && deque_pop(&runtime.deques[self], task))
+    {
+        atomic_fetch_sub(&runtime.queued, 1);
+        return true;
+    }
+    for (size_t i = 0; i < runtime.num_workers; ++i)
+    {
+        size_t victim = (hint + i) % runtime.num_workers;
+        if (victim != self && deque_steal(&runtime.deques[victim], task))
+        {
+            atomic_fetch_sub(&runtime.queued, 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void runtime_run_task(parallel_task_t task)
+{
+    bool was_in_parallel_region = in_parallel_region;
+    in_parallel_region = true;
+    task.job->fn(task.job->ctx, task.begin, task.end);
+    in_parallel_region = was_in_parallel_region;
+
+    pthread_mutex_lock(&task.job->mutex);
+    if (--task.job->remaining == 0)
+    {
+        pthread_cond_signal(&task.job->done);
+    }
+    pthread_mutex_unlock(&task.job->mutex);
+}
+
+static void* runtime_worker(void* arg)
+{
+    size_t self = (size_t)(uintptr_t)arg;
+    worker_index = self;
+
+    parallel_task_t task;
+    while (true)
+    {
+        if (runtime_find_task(self, self + 1, &task))
+        {
+            runtime_run_task(task);
+            continue;
+        }
+
+        pthread_mutex_lock(&runtime.mutex);
+        while (atomic_load(&runtime.queued) == 0 && !runtime.shutdown)
+        {
+            pthread_cond_wait(&runtime.wake, &runtime.mutex);
+        }
+        bool shutdown = runtime.shutdown;
+        pthread_mutex_unlock(&runtime.mutex);
+
+        if (shutdown)
+        {
+            break;
+        }
+    }
+    return NULL;
+}
+
+static size_t runtime_default_threads(void)
+{
+    const char* env = getenv("CORTEX_NUM_THREADS");
+    if (env)
+    {
+        long value = strtol(env, NULL, 10);
+        if (value > 0)
+        {
+            return (value > PARALLEL_MAX_THREADS) ? PARALLEL_MAX_THREADS : (size_t)value;
+        }
+    }
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cpus < 1) ? 1 : (cpus > PARALLEL_MAX_THREADS) ? PARALLEL_MAX_THREADS : (size_t)cpus;
+}
+
+static void runtime_stop(void)
+{
+    if (!atomic_load(&runtime.started))
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&runtime.mutex);
+    runtime.shutdown = true;
+    pthread_cond_broadcast(&runtime.wake);
+    pthread_mutex_unlock(&runtime.mutex);
+
+    for (size_t i = 0; i < runtime.num_spawned; ++i)
+    {
+        pthread_join(runtime.workers[i], NULL);
+    }
+    for (size_t i = 0; i < runtime.num_workers; ++i)
+    {
+        pthread_mutex_destroy(&runtime.deques[i].mutex);
+    }
+    free(runtime.workers);
+    free(runtime.deques);
+
+    runtime.workers = NULL;
+    runtime.deques = NULL;
+    runtime.num_workers = 0;
+    runtime.num_spawned = 0;
+    runtime.shutdown = false;
+    atomic_store(&runtime.started, false);
+}
+
+static void runtime_start_locked(void)
+{
+    if (atomic_load(&runtime.started))
+    {
+        return;
+    }
+
+    size_t num_threads = requested_threads ? requested_threads : runtime_default_threads();
+    size_t num_workers = num_threads - 1;
+
+    runtime.workers = NULL;
+    runtime.deques = NULL;
+    if (num_workers > 0)
+    {
+        runtime.workers = (pthread_t*)malloc(num_workers * sizeof(pthread_t));
+        runtime.deques = (parallel_deque_t*)calloc(num_workers, sizeof(parallel_deque_t));
+        if (runtime.workers == NULL || runtime.deques == NULL)
+        {
+            free(runtime.workers);
+            free(runtime.deques);
+            runtime.workers = NULL;
+            runtime.deques = NULL;
+            num_workers = 0;
+        }
+    }
+    for (size_t i = 0; i < num_workers; ++i)
+    {
+        pthread_mutex_init(&runtime.deques[i].mutex, NULL);
+    }
+
+    // Deques of workers that failed to spawn are still drained by thieves and callers
+    atomic_store(&runtime.queued, 0);
+    runtime.num_workers = num_workers;
+    runtime.num_spawned = 0;
+    for (size_t i = 0; i < num_workers; ++i)
+    {
+        if (pthread_create(&runtime.workers[i], NULL, runtime_worker, (void*)(uintptr_t)i) != 0)
+        {
+            break;
+        }
+        runtime.num_spawned++;
+    }
+    runtime.num_threads = runtime.num_spawned + 1;
+
+    atomic_store(&runtime.started, true);
+}
+
+static void runtime_start(void)
+{
+    pthread_mutex_lock(&runtime_lock);
+    runtime_start_locked();
+    pthread_mutex_unlock(&runtime_lock);
+}
+
+// Waits for regions running on other threads before tearing the workers down; from inside a region it would wait on itself, so it is ignored there
+void cortex_set_num_threads(size_t num_threads)
+{
+    if (in_parallel_region)
+    {
+        return;
+    }
+    if (num_threads > PARALLEL_MAX_THREADS)
+    {
+        num_threads = PARALLEL_MAX_THREADS;
+    }
+
+    pthread_mutex_lock(&runtime_lock);
+    pending_resizes++;
+    while (active_jobs > 0)
+    {
+        pthread_cond_wait(&runtime_idle, &runtime_lock);
+    }
+    requested_threads = num_threads;
+    runtime_stop();
+    pending_resizes--;
+    pthread_cond_broadcast(&runtime_idle);
+    pthread_mutex_unlock(&runtime_lock);
+}
+
+size_t cortex_get_num_threads(void)
+{
+    if (!atomic_load(&runtime.started))
+    {
+        runtime_start();
+    }
+    return runtime.num_threads;
+}
+
+static void parallel_job_leave(void)
+{
+    pthread_mutex_lock(&runtime_lock);
+    if (--active_jobs == 0)
+    {
+        pthread_cond_broadcast(&runtime_idle);
+    }
+    pthread_mutex_unlock(&runtime_lock);
+}
+
+void cortex_parallel_for(size_t range, size_t grain, parallel_fn_t fn, void* ctx)
+{
+    if (range == 0 || fn == NULL)
+    {
+        return;
+    }
+    if (grain == 0)
+    {
+        grain = 1;
+    }
+
+    // Nested regions run inline instead of oversubscribing the machine
+    size_t num_chunks = (range + grain - 1) / grain;
+    if (num_chunks <= 1 || in_parallel_region)
+    {
+        fn(ctx, 0, range);
+        return;
+    }
+
+    // Registering keeps a concurrent resize from freeing the deques under this job, new jobs hold back while one is pending
+    pthread_mutex_lock(&runtime_lock);
+    while (pending_resizes > 0)
+    {
+        pthread_cond_wait(&runtime_idle, &runtime_lock);
+    }
+    runtime_start_locked();
+    size_t num_threads = runtime.num_threads;
+    active_jobs++;
+    pthread_mutex_unlock(&runtime_lock);
+
+    if (num_threads <= 1)
+    {
+        fn(ctx, 0, range);
+        parallel_job_leave();
+        return;
+    }
+
+    size_t num_tasks = num_threads * PARALLEL_TASKS_PER_THREAD;
+    if (num_tasks > num_chunks)
+    {
+        num_tasks = num_chunks;
+    }
+
+    parallel_job_t job;
+    job.fn = fn;
+    job.ctx = ctx;
+    job.remaining = num_tasks;
+    pthread_mutex_init(&job.mutex, NULL);
+    pthread_cond_init(&job.done, NULL);
+
+    // Tasks are counted as queued before they become visible so thieves never drive the counter below zero
+    size_t first_deque = atomic_fetch_add(&runtime.next_deque, 1);
+    size_t pushed = num_tasks - 1;
+    atomic_fetch_add(&runtime.queued, pushed);
+    for (size_t t = 1; t < num_tasks; ++t)
+    {
+        size_t chunk_begin = num_chunks * t / num_tasks;
+        size_t chunk_end = num_chunks * (t + 1) / num_tasks;
+        parallel_task_t task = {&job, chunk_begin * grain, (chunk_end * grain < range) ? chunk_end * grain : range};
+
+        if (deque_push(&runtime.deques[(first_deque + t) % runtime.num_workers], task))
+        {
+            continue;
+        }
+        atomic_fetch_sub(&runtime.queued, 1);
+        pushed--;
+        runtime_run_task(task);
+    }
+
+    if (pushed > 0)
+    {
+        pthread_mutex_lock(&runtime.mutex);
+        pthread_cond_broadcast(&runtime.wake);
+        pthread_mutex_unlock(&runtime.mutex);
+    }
+
+    size_t own_end = (num_chunks / num_tasks) * grain;
+    parallel_task_t own_task = {&job, 0, (own_end < range) ? own_end : range};
+    runtime_run_task(own_task);
+
+    // Help drain the queues until this job's tasks have all been picked up
+    parallel_task_t task;
+    while (true)
+    {
+        pthread_mutex_lock(&job.mutex);
+        bool finished = (job.remaining == 0);
+        pthread_mutex_unlock(&job.mutex);
+        if (finished || !runtime_find_task(worker_index, first_deque, &task))
+        {
+            break;
+        }
+        runtime_run_task(task);
+    }
+
+    pthread_mutex_lock(&job.mutex);
+    while (job.remaining > 0)
+    {
+        pthread_cond_wait(&job.done, &job.mutex);
+    }
+    pthread_mutex_unlock(&job.mutex);
+
+    pthread_mutex_destroy(&job.mutex);
+    pthread_cond_destroy(&job.done);
+    parallel_job_leave();
+}